@@ -0,0 +1,298 @@
+/*
+ *
+ * TCS3200 Library Benchmark Example
+ *
+ * By: Nathanne Isip
+ * 16 October 2026
+ *
+ */
+#include <TCS3200.h>
+#include <TCS3200Batch.h>
+#include <TCS3200Palette.h>
+#include <TCS3200Simulator.h>
+
+// Define pin connections
+#define S0_PIN 15
+#define S1_PIN 2
+#define S2_PIN 0
+#define S3_PIN 4
+#define OUT_PIN 16
+
+// Set to 1 to benchmark against a simulated sensor. The sensor
+// then runs in virtual time, so only the CPU time is measured.
+#define USE_SIMULATOR 0
+
+// Number of timed calls per benchmark
+#define SAMPLES 32
+
+// Number of colors converted per call of the batch benchmarks
+#ifdef __AVR__
+#define BATCH_SIZE 16
+#else
+#define BATCH_SIZE 256
+#endif
+
+// Create an instance of the TCS3200 class
+TCS3200 tcs3200(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN);
+
+#if USE_SIMULATOR
+TCS3200SimulatedHAL simulator(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN);
+#endif
+
+// Define color labels and values for the nearest color benchmarks
+String color_indices[] = {"Red", "Green", "Blue", "White", "Black"};
+RGBColor color_values[] = {
+  {255, 0, 0},
+  {0, 255, 0},
+  {0, 0, 255},
+  {255, 255, 255},
+  {0, 0, 0}
+};
+
+#define COLOR_COUNT (sizeof(color_values) / sizeof(color_values[0]))
+
+// Logged colors and their conversions for the batch benchmarks
+RGBColor batch_colors[BATCH_SIZE];
+HSVColor batch_hsv[BATCH_SIZE];
+CIELabColor batch_lab[BATCH_SIZE];
+
+TCS3200PaletteNode palette_nodes[COLOR_COUNT];
+TCS3200Palette palette(palette_nodes, COLOR_COUNT, TCS3200_METRIC_LAB);
+
+// Results are written here so the compiler cannot drop the calls
+volatile float sink;
+
+// Benchmarked calls
+void bench_read_raw_rgbc() { sink = tcs3200.read_raw_rgbc().red; }
+void bench_read_rgb_color() { sink = tcs3200.read_rgb_color().red; }
+void bench_read_hsv() { sink = tcs3200.read_hsv().hue; }
+void bench_read_cmyk() { sink = tcs3200.read_cmyk().cyan; }
+void bench_read_cie1931() { sink = tcs3200.read_cie1931().x; }
+void bench_read_cielab() { sink = tcs3200.read_cielab().l; }
+void bench_get_chroma() { sink = tcs3200.get_chroma(); }
+void bench_nearest_color() {
+  sink = tcs3200.nearest_color<String>(color_indices, color_values, COLOR_COUNT).length();
+}
+
+void bench_rgb_to_hsv() { sink = TCS3200::rgb_to_hsv(color_values[0]).hue; }
+void bench_rgb_to_cie1931() { sink = TCS3200::rgb_to_cie1931(color_values[0]).x; }
+void bench_rgb_to_hsv_q16() { sink = TCS3200::rgb_to_hsv_q16(color_values[0]).hue; }
+void bench_delta_e2000() {
+  CIELabColor red = TCS3200::cie1931_to_cielab(TCS3200::rgb_to_cie1931(color_values[0]));
+  CIELabColor blue = TCS3200::cie1931_to_cielab(TCS3200::rgb_to_cie1931(color_values[2]));
+  sink = TCS3200::delta_e2000(red, blue);
+}
+void bench_palette_classify() { sink = palette.classify(color_values[1]).index; }
+
+void bench_rgb_to_hsv_each() {
+  for(unsigned int i = 0; i < BATCH_SIZE; i++)
+    batch_hsv[i] = TCS3200::rgb_to_hsv(batch_colors[i]);
+  sink = batch_hsv[0].hue;
+}
+void bench_convert_rgb_to_hsv() {
+  convert_rgb_to_hsv(batch_colors, batch_hsv, BATCH_SIZE);
+  sink = batch_hsv[0].hue;
+}
+void bench_rgb_to_cielab_each() {
+  for(unsigned int i = 0; i < BATCH_SIZE; i++)
+    batch_lab[i] = TCS3200::cie1931_to_cielab(TCS3200::rgb_to_cie1931(batch_colors[i]));
+  sink = batch_lab[0].l;
+}
+void bench_convert_rgb_to_cielab() {
+  convert_rgb_to_cielab(batch_colors, batch_lab, BATCH_SIZE);
+  sink = batch_lab[0].l;
+}
+
+#ifdef __AVR__
+extern uint8_t __heap_start, *__brkval;
+
+// Fill the free stack with a pattern, so the deepest point reached
+// by a call can be found afterwards
+void paint_stack() {
+  uint8_t top;
+  uint8_t *bottom = __brkval != 0 ? __brkval : &__heap_start;
+
+  for(uint8_t *p = bottom + 16; p < &top - 16; p++)
+    *p = 0xa5;
+}
+
+unsigned int stack_used() {
+  uint8_t top;
+  uint8_t *bottom = __brkval != 0 ? __brkval : &__heap_start;
+  uint8_t *p = bottom + 16;
+
+  while(p < &top - 16 && *p == 0xa5)
+    p++;
+
+  return &top - p;
+}
+
+int free_ram() {
+  uint8_t top;
+  return &top - (__brkval != 0 ? __brkval : &__heap_start);
+}
+#endif
+
+// Sort the latencies to read their percentiles
+void sort(uint32_t *values, uint8_t count) {
+  for(uint8_t i = 1; i < count; i++) {
+    uint32_t value = values[i];
+    uint8_t j = i;
+
+    for(; j > 0 && values[j - 1] > value; j--)
+      values[j] = values[j - 1];
+    values[j] = value;
+  }
+}
+
+// Time a call that processes the given number of samples
+void benchmark_samples(const char *name, void (*call)(), unsigned int samples) {
+  uint32_t latencies[SAMPLES];
+  uint32_t total = 0;
+
+  // Warm up caches and lazily initialized state
+  call();
+
+#ifdef __AVR__
+  paint_stack();
+#endif
+
+  for(uint8_t i = 0; i < SAMPLES; i++) {
+    uint32_t start = micros();
+    call();
+    latencies[i] = micros() - start;
+    total += latencies[i];
+  }
+
+  sort(latencies, SAMPLES);
+
+  float mean = (float) total / SAMPLES;
+  float rate = mean > 0 ? 1000000.0 * samples / mean : 0;
+  Serial.print(name);
+  Serial.print(": min " + String(latencies[0]) +
+    " us, p50 " + String(latencies[SAMPLES / 2]) +
+    " us, p99 " + String(latencies[(SAMPLES * 99) / 100]) +
+    " us, max " + String(latencies[SAMPLES - 1]) +
+    " us, " + String(rate) + (samples > 1 ? " samples/s" : " calls/s"));
+
+#ifdef __AVR__
+  Serial.print(", stack " + String(stack_used()) + " B");
+#endif
+
+  Serial.println();
+}
+
+void benchmark(const char *name, void (*call)()) {
+  benchmark_samples(name, call, 1);
+}
+
+void benchmark_sensor(const char *scaling_name, int scaling) {
+  tcs3200.frequency_scaling(scaling);
+
+  Serial.println("-----------------------------------");
+  Serial.println(String("Sensor reads at ") + scaling_name + " scaling");
+
+  benchmark("read_raw_rgbc()", bench_read_raw_rgbc);
+  benchmark("read_rgb_color()", bench_read_rgb_color);
+  benchmark("read_hsv()", bench_read_hsv);
+  benchmark("read_cmyk()", bench_read_cmyk);
+  benchmark("read_cie1931()", bench_read_cie1931);
+  benchmark("read_cielab()", bench_read_cielab);
+  benchmark("get_chroma()", bench_get_chroma);
+  benchmark("nearest_color()", bench_nearest_color);
+}
+
+uint32_t sensor_time() {
+#if USE_SIMULATOR
+  return simulator.now();
+#else
+  return micros();
+#endif
+}
+
+void benchmark_frames() {
+  tcs3200.frequency_scaling(TCS3200_OFREQ_20P);
+  tcs3200.sampling(true);
+
+  // Let the first frame start from a settled filter
+  while(!tcs3200.available())
+    tcs3200.loop();
+  tcs3200.read_frame();
+
+  uint8_t valid = 0;
+  uint32_t start = sensor_time();
+
+  for(uint8_t i = 0; i < SAMPLES; i++) {
+    while(!tcs3200.available())
+      tcs3200.loop();
+
+    if(tcs3200.read_frame().valid == 0x0f)
+      valid++;
+  }
+
+  uint32_t frame_time = (sensor_time() - start) / SAMPLES;
+  tcs3200.sampling(false);
+
+  Serial.println("-----------------------------------");
+  Serial.println("Sampled frames at 20% scaling");
+  Serial.println("loop(): " + String(frame_time) + " us per frame, budget " +
+    String(tcs3200.frame_budget()) + " us, " + String(valid) + "/" +
+    String(SAMPLES) + " valid, " +
+    String(frame_time > 0 ? 1000000.0 / frame_time : 0) + " frames/s");
+}
+
+void setup() {
+  Serial.begin(115200);
+  Serial.println("TCS3200 Benchmark");
+
+#if USE_SIMULATOR
+  // Simulate a reddish surface with 2% period jitter
+  simulator.spectrum(60000, 25000, 20000, 110000);
+  simulator.noise(2);
+  tcs3200.hal(&simulator);
+#endif
+
+  tcs3200.begin();
+  palette.build(color_values);
+
+  for(unsigned int i = 0; i < BATCH_SIZE; i++) {
+    batch_colors[i].red = random(256);
+    batch_colors[i].green = random(256);
+    batch_colors[i].blue = random(256);
+  }
+
+#ifdef __AVR__
+  Serial.println("Free RAM: " + String(free_ram()) + " B");
+#endif
+
+  // Sensor reads depend on the light and the frequency scaling
+  benchmark_sensor("2%", TCS3200_OFREQ_2P);
+  benchmark_sensor("20%", TCS3200_OFREQ_20P);
+  benchmark_sensor("100%", TCS3200_OFREQ_100P);
+
+  // Frame rate of the non-blocking scheduler against its timing budget
+  benchmark_frames();
+
+  // Conversions only depend on the CPU
+  Serial.println("-----------------------------------");
+  Serial.println("Conversions");
+
+  benchmark("rgb_to_hsv()", bench_rgb_to_hsv);
+  benchmark("rgb_to_cie1931()", bench_rgb_to_cie1931);
+  benchmark("rgb_to_hsv_q16()", bench_rgb_to_hsv_q16);
+  benchmark("delta_e2000()", bench_delta_e2000);
+  benchmark("TCS3200Palette::classify()", bench_palette_classify);
+
+  // Converting logged colors one at a time or as a batch
+  Serial.println("-----------------------------------");
+  Serial.println("Conversions of " + String(BATCH_SIZE) + " colors");
+
+  benchmark_samples("rgb_to_hsv() per color", bench_rgb_to_hsv_each, BATCH_SIZE);
+  benchmark_samples("convert_rgb_to_hsv()", bench_convert_rgb_to_hsv, BATCH_SIZE);
+  benchmark_samples("rgb_to_cie1931() + cie1931_to_cielab() per color",
+    bench_rgb_to_cielab_each, BATCH_SIZE);
+  benchmark_samples("convert_rgb_to_cielab()", bench_convert_rgb_to_cielab, BATCH_SIZE);
+}
+
+void loop() {
+}
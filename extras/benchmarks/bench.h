@@ -0,0 +1,79 @@
+/*
+ * This file is part of the TCS3200 Color Sensor Arduino library.
+ * Copyright (c) 2023 Nathanne Isip
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * 
+ * @file bench.h
+ * @brief Timing helpers for the host benchmarks.
+ *
+ * Every benchmark runs a body several times over the same inputs and
+ * reports the fastest run, which is the least disturbed by the host.
+ * Results are folded into `bench_sink` so the work is not optimized
+ * away.
+ *
+ */
+#ifndef TCS3200_BENCH_H
+#define TCS3200_BENCH_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#define BENCH_RUNS 7
+
+static volatile uint32_t bench_sink;
+
+static inline uint64_t bench_clock() {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return (uint64_t) time.tv_sec * 1000000000ULL + time.tv_nsec;
+}
+
+template<class Body>
+static double bench_ns(Body body, uint32_t operations) {
+    double best = 0;
+
+    for(uint8_t run = 0; run < BENCH_RUNS; run++) {
+        uint64_t start = bench_clock();
+        body();
+        double time = (double) (bench_clock() - start) / operations;
+
+        if(run == 0 || time < best)
+            best = time;
+    }
+
+    return best;
+}
+
+static inline uint32_t bench_random() {
+    static uint32_t state = 0x2545f491;
+
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+
+    return state;
+}
+
+#endif
@@ -0,0 +1,195 @@
+/*
+ * This file is part of the TCS3200 Color Sensor Arduino library.
+ * Copyright (c) 2023 Nathanne Isip
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "TCS3200Palette.h"
+#include "TCS3200Simulator.h"
+#include "bench.h"
+
+#include <stdlib.h>
+
+#define S0_PIN  4
+#define S1_PIN  5
+#define S2_PIN  6
+#define S3_PIN  7
+#define OUT_PIN 8
+
+// Timed samples per API, and calls per sample of the conversions
+#define SAMPLES 1001
+#define REPEAT  64
+
+#define COLOR_COUNT 5
+
+static TCS3200SimulatedHAL simulator(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN);
+static TCS3200 tcs3200(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN);
+
+static const char *color_labels[COLOR_COUNT] = {"Red", "Green", "Blue", "White", "Black"};
+static RGBColor color_values[COLOR_COUNT] = {
+    {255, 0, 0}, {0, 255, 0}, {0, 0, 255}, {255, 255, 255}, {0, 0, 0}
+};
+
+static TCS3200PaletteNode palette_nodes[COLOR_COUNT];
+static TCS3200Palette palette(palette_nodes, COLOR_COUNT, TCS3200_METRIC_LAB);
+
+static uint64_t latencies[SAMPLES];
+
+static int compare(const void *first, const void *second) {
+    uint64_t a = *(const uint64_t *) first, b = *(const uint64_t *) second;
+    return a < b ? -1 : a > b;
+}
+
+// Reports the CPU time per call and, for sensor reads, the sensor time
+template<class Call>
+static void benchmark(const char *name, Call call, uint32_t repeat, bool sensor) {
+    uint32_t sensor_start = simulator.now();
+    call();
+
+    for(uint32_t i = 0; i < SAMPLES; i++) {
+        uint64_t start = bench_clock();
+        for(uint32_t j = 0; j < repeat; j++)
+            call();
+        latencies[i] = bench_clock() - start;
+    }
+
+    qsort(latencies, SAMPLES, sizeof(latencies[0]), compare);
+
+    printf("  %-28s %9.1f %9.1f %9.1f %9.1f",
+        name,
+        (double) latencies[0] / repeat,
+        (double) latencies[SAMPLES / 2] / repeat,
+        (double) latencies[SAMPLES * 99 / 100] / repeat,
+        (double) latencies[SAMPLES - 1] / repeat);
+
+    if(sensor) {
+        double sensor_time = (double) (simulator.now() - sensor_start) / (SAMPLES * repeat + 1);
+        printf(" %9.0f %9.0f", sensor_time, 1e6 / sensor_time);
+    }
+
+    printf("\n");
+}
+
+static void benchmark_sensor(const char *scaling_name, int scaling) {
+    tcs3200.frequency_scaling(scaling);
+
+    printf("Sensor reads at %s scaling, CPU ns per call, sensor us per call\n", scaling_name);
+    printf("  %-28s %9s %9s %9s %9s %9s %9s\n",
+        "API", "min", "p50", "p99", "max", "sensor", "calls/s");
+
+    benchmark("read_raw_rgbc()", [] { bench_sink = tcs3200.read_raw_rgbc().red; }, 1, true);
+    benchmark("read_rgb_color()", [] { bench_sink = tcs3200.read_rgb_color().red; }, 1, true);
+    benchmark("read_hsv()", [] { bench_sink = (uint32_t) tcs3200.read_hsv().hue; }, 1, true);
+    benchmark("read_cmyk()", [] { bench_sink = (uint32_t) (tcs3200.read_cmyk().cyan * 100); }, 1, true);
+    benchmark("read_cie1931()", [] { bench_sink = (uint32_t) (tcs3200.read_cie1931().x * 100); }, 1, true);
+    benchmark("read_cielab()", [] { bench_sink = (uint32_t) tcs3200.read_cielab().l; }, 1, true);
+    benchmark("get_chroma()", [] { bench_sink = tcs3200.get_chroma(); }, 1, true);
+    benchmark("nearest_color()", [] {
+        bench_sink = *tcs3200.nearest_color<const char *>(color_labels, color_values, COLOR_COUNT);
+    }, 1, true);
+
+    printf("\n");
+}
+
+static void benchmark_frames() {
+    tcs3200.frequency_scaling(TCS3200_OFREQ_20P);
+    tcs3200.sampling(true);
+
+    // Let the first frame start from a settled filter
+    while(!tcs3200.available())
+        tcs3200.loop();
+    tcs3200.read_frame();
+
+    const uint32_t frames = 200;
+    uint32_t calls = 0, start = simulator.now();
+
+    for(uint32_t i = 0; i < frames; i++) {
+        while(!tcs3200.available()) {
+            tcs3200.loop();
+            calls++;
+        }
+
+        bench_sink = tcs3200.read_frame().valid;
+    }
+
+    uint32_t frame_time = (simulator.now() - start) / frames;
+    tcs3200.sampling(false);
+
+    printf("Sampled frames at 20%% scaling\n");
+    printf("  loop(): %u us per frame, budget %u us, %u calls per frame, %.0f frames/s\n\n",
+        frame_time, tcs3200.frame_budget(), calls / frames, 1e6 / frame_time);
+}
+
+static void benchmark_conversions() {
+    printf("Conversions, CPU ns per call\n");
+    printf("  %-28s %9s %9s %9s %9s\n", "API", "min", "p50", "p99", "max");
+
+    static uint8_t next = 0;
+    benchmark("rgb_to_hsv()", [] {
+        bench_sink = (uint32_t) TCS3200::rgb_to_hsv(color_values[next++ % COLOR_COUNT]).hue;
+    }, REPEAT, false);
+    benchmark("rgb_to_hsv_q16()", [] {
+        bench_sink = TCS3200::rgb_to_hsv_q16(color_values[next++ % COLOR_COUNT]).hue;
+    }, REPEAT, false);
+    benchmark("rgb_to_cmyk()", [] {
+        bench_sink = (uint32_t) (TCS3200::rgb_to_cmyk(color_values[next++ % COLOR_COUNT]).cyan * 100);
+    }, REPEAT, false);
+    benchmark("rgb_to_cie1931()", [] {
+        bench_sink = (uint32_t) (TCS3200::rgb_to_cie1931(color_values[next++ % COLOR_COUNT]).x * 100);
+    }, REPEAT, false);
+    benchmark("cie1931_to_cielab()", [] {
+        CIE1931Color xyz = TCS3200::rgb_to_cie1931(color_values[next++ % COLOR_COUNT]);
+        bench_sink = (uint32_t) TCS3200::cie1931_to_cielab(xyz).l;
+    }, REPEAT, false);
+
+    CIELabColor red = TCS3200::cie1931_to_cielab(TCS3200::rgb_to_cie1931(color_values[0]));
+    CIELabColor blue = TCS3200::cie1931_to_cielab(TCS3200::rgb_to_cie1931(color_values[2]));
+    benchmark("delta_e76()", [&] { bench_sink = (uint32_t) TCS3200::delta_e76(red, blue); }, REPEAT, false);
+    benchmark("delta_e94()", [&] { bench_sink = (uint32_t) TCS3200::delta_e94(red, blue); }, REPEAT, false);
+    benchmark("delta_e2000()", [&] { bench_sink = (uint32_t) TCS3200::delta_e2000(red, blue); }, REPEAT, false);
+    benchmark("TCS3200Palette::classify()", [] {
+        bench_sink = palette.classify(color_values[next++ % COLOR_COUNT]).index;
+    }, REPEAT, false);
+}
+
+int main() {
+    // Simulate a reddish surface with 2% period jitter
+    simulator.spectrum(60000, 25000, 20000, 110000);
+    simulator.noise(2);
+
+    tcs3200.hal(&simulator);
+    tcs3200.begin();
+    palette.build(color_values);
+
+    printf("TCS3200 object: %u bytes\n\n", (unsigned int) sizeof(TCS3200));
+
+    // Sensor reads depend on the light and the frequency scaling
+    benchmark_sensor("2%", TCS3200_OFREQ_2P);
+    benchmark_sensor("20%", TCS3200_OFREQ_20P);
+    benchmark_sensor("100%", TCS3200_OFREQ_100P);
+
+    // Frame rate of the non-blocking scheduler against its timing budget
+    benchmark_frames();
+
+    // Conversions only depend on the CPU
+    benchmark_conversions();
+
+    return 0;
+}
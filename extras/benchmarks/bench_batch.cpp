@@ -0,0 +1,100 @@
+/*
+ * This file is part of the TCS3200 Color Sensor Arduino library.
+ * Copyright (c) 2023 Nathanne Isip
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "TCS3200Batch.h"
+#include "bench.h"
+
+#define COLORS 4096
+
+static RGBColor colors[COLORS];
+static uint8_t red[COLORS], green[COLORS], blue[COLORS];
+static HSVColor hsv[COLORS];
+static CIE1931Color xyz[COLORS];
+static CIELabColor lab[COLORS];
+static float channels[3][COLORS];
+
+static void report(const char *name, double sample_ns, double batch_ns, double channel_ns) {
+    printf("  %-8s %9.1f %9.1f %9.1f %8.2fx %8.2fx\n", name,
+        1e3 / sample_ns, 1e3 / batch_ns, 1e3 / channel_ns,
+        sample_ns / batch_ns, sample_ns / channel_ns);
+}
+
+int main() {
+    for(uint32_t i = 0; i < COLORS; i++) {
+        uint32_t value = bench_random();
+        colors[i].red = value;
+        colors[i].green = value >> 8;
+        colors[i].blue = value >> 16;
+    }
+    tcs3200_deinterleave_rgb(colors, red, green, blue, COLORS);
+
+    printf("Per-sample and batch conversions, %u random colors, Msamples/s\n", COLORS);
+    printf("  %-8s %9s %9s %9s %9s %9s\n", "kernel", "sample", "batch", "channels", "batch x", "chan x");
+
+    report("HSV",
+        bench_ns([] {
+            for(uint32_t i = 0; i < COLORS; i++)
+                hsv[i] = TCS3200::rgb_to_hsv(colors[i]);
+            bench_sink = (uint32_t) hsv[COLORS - 1].hue;
+        }, COLORS),
+        bench_ns([] {
+            convert_rgb_to_hsv(colors, hsv, COLORS);
+            bench_sink = (uint32_t) hsv[COLORS - 1].hue;
+        }, COLORS),
+        bench_ns([] {
+            convert_rgb_to_hsv(red, green, blue, channels[0], channels[1], channels[2], COLORS);
+            bench_sink = (uint32_t) channels[0][COLORS - 1];
+        }, COLORS));
+
+    report("XYZ",
+        bench_ns([] {
+            for(uint32_t i = 0; i < COLORS; i++)
+                xyz[i] = TCS3200::rgb_to_cie1931(colors[i]);
+            bench_sink = (uint32_t) (xyz[COLORS - 1].x * 100);
+        }, COLORS),
+        bench_ns([] {
+            convert_rgb_to_cie1931(colors, xyz, COLORS);
+            bench_sink = (uint32_t) (xyz[COLORS - 1].x * 100);
+        }, COLORS),
+        bench_ns([] {
+            convert_rgb_to_cie1931(red, green, blue, channels[0], channels[1], channels[2], COLORS);
+            bench_sink = (uint32_t) (channels[0][COLORS - 1] * 100);
+        }, COLORS));
+
+    report("L*a*b*",
+        bench_ns([] {
+            for(uint32_t i = 0; i < COLORS; i++)
+                lab[i] = TCS3200::cie1931_to_cielab(TCS3200::rgb_to_cie1931(colors[i]));
+            bench_sink = (uint32_t) lab[COLORS - 1].l;
+        }, COLORS),
+        bench_ns([] {
+            convert_rgb_to_cielab(colors, lab, COLORS);
+            bench_sink = (uint32_t) lab[COLORS - 1].l;
+        }, COLORS),
+        bench_ns([] {
+            convert_rgb_to_cielab(red, green, blue, channels[0], channels[1], channels[2], COLORS);
+            bench_sink = (uint32_t) channels[0][COLORS - 1];
+        }, COLORS));
+
+    return 0;
+}
@@ -0,0 +1,63 @@
+/*
+ * This file is part of the TCS3200 Color Sensor Arduino library.
+ * Copyright (c) 2023 Nathanne Isip
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "TCS3200Filters.h"
+#include "bench.h"
+
+#define READINGS 4096
+
+static uint32_t readings[READINGS];
+
+template<class Filter>
+static void report(const char *name, Filter &filter) {
+    double time = bench_ns([&] {
+        uint32_t sum = 0;
+        filter.reset();
+
+        for(uint32_t i = 0; i < READINGS; i++)
+            sum += filter.update(i & 0x03, readings[i]);
+        bench_sink = sum;
+    }, READINGS);
+
+    printf("  %-24s %8.2f ns\n", name, time);
+}
+
+int main() {
+    // Pulse widths around 1000 us with jitter and occasional spikes
+    for(uint32_t i = 0; i < READINGS; i++) {
+        uint32_t value = bench_random();
+        readings[i] = (value & 0xff) == 0 ? value >> 12 : 1000 + (value & 0x3f);
+    }
+
+    TCS3200MovingAverage<8> moving_average;
+    TCS3200MedianFilter<5> median;
+    TCS3200EMAFilter ema(64);
+    TCS3200KalmanFilter kalman(0.01f, 4.0f);
+
+    printf("Channel filters, %u readings over 4 channels, per update\n", READINGS);
+    report("TCS3200MovingAverage<8>", moving_average);
+    report("TCS3200MedianFilter<5>", median);
+    report("TCS3200EMAFilter", ema);
+    report("TCS3200KalmanFilter", kalman);
+
+    return 0;
+}
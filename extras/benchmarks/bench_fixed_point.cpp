@@ -0,0 +1,89 @@
+/*
+ * This file is part of the TCS3200 Color Sensor Arduino library.
+ * Copyright (c) 2023 Nathanne Isip
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "TCS3200.h"
+#include "bench.h"
+
+#define COLORS 4096
+
+static RGBColor colors[COLORS];
+
+static void report(const char *name, double float_ns, double fixed_ns) {
+    printf("  %-10s %8.2f ns %8.2f ns %6.2fx\n", name, float_ns, fixed_ns, float_ns / fixed_ns);
+}
+
+int main() {
+    for(uint32_t i = 0; i < COLORS; i++) {
+        uint32_t value = bench_random();
+        colors[i].red = value;
+        colors[i].green = value >> 8;
+        colors[i].blue = value >> 16;
+    }
+
+    printf("Float and Q16.16 conversions, %u random colors, per color\n", COLORS);
+    printf("  kernel        float      Q16.16  speedup\n");
+
+    report("HSV",
+        bench_ns([] {
+            float sum = 0;
+            for(uint32_t i = 0; i < COLORS; i++)
+                sum += TCS3200::rgb_to_hsv(colors[i]).hue;
+            bench_sink = (uint32_t) sum;
+        }, COLORS),
+        bench_ns([] {
+            int32_t sum = 0;
+            for(uint32_t i = 0; i < COLORS; i++)
+                sum += TCS3200::rgb_to_hsv_q16(colors[i]).hue;
+            bench_sink = sum;
+        }, COLORS));
+
+    report("CMYK",
+        bench_ns([] {
+            float sum = 0;
+            for(uint32_t i = 0; i < COLORS; i++)
+                sum += TCS3200::rgb_to_cmyk(colors[i]).cyan;
+            bench_sink = (uint32_t) sum;
+        }, COLORS),
+        bench_ns([] {
+            int32_t sum = 0;
+            for(uint32_t i = 0; i < COLORS; i++)
+                sum += TCS3200::rgb_to_cmyk_q16(colors[i]).cyan;
+            bench_sink = sum;
+        }, COLORS));
+
+    report("XYZ",
+        bench_ns([] {
+            float sum = 0;
+            for(uint32_t i = 0; i < COLORS; i++)
+                sum += TCS3200::rgb_to_cie1931(colors[i]).x;
+            bench_sink = (uint32_t) sum;
+        }, COLORS),
+        bench_ns([] {
+            int32_t sum = 0;
+            for(uint32_t i = 0; i < COLORS; i++)
+                sum += TCS3200::rgb_to_cie1931_q16(colors[i]).x;
+            bench_sink = sum;
+        }, COLORS));
+
+    return 0;
+}
@@ -0,0 +1,111 @@
+/*
+ * This file is part of the TCS3200 Color Sensor Arduino library.
+ * Copyright (c) 2023 Nathanne Isip
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "TCS3200Palette.h"
+#include "bench.h"
+
+#define MAX_PALETTE 1024
+#define QUERIES     4096
+
+static RGBColor colors[MAX_PALETTE];
+static TCS3200PaletteNode nodes[MAX_PALETTE];
+static RGBColor queries[QUERIES];
+
+static RGBColor random_color() {
+    uint32_t value = bench_random();
+
+    RGBColor color;
+    color.red = value;
+    color.green = value >> 8;
+    color.blue = value >> 16;
+
+    return color;
+}
+
+// Linear scan over the RGB cube, the search the palette replaces
+static uint16_t linear_search(RGBColor color, uint16_t size) {
+    uint32_t best = 0xffffffff;
+    uint16_t index = 0;
+
+    for(uint16_t i = 0; i < size; i++) {
+        int32_t red = color.red - colors[i].red,
+            green = color.green - colors[i].green,
+            blue = color.blue - colors[i].blue;
+        uint32_t distance = red * red + green * green + blue * blue;
+
+        if(distance < best) {
+            best = distance;
+            index = i;
+        }
+    }
+
+    return index;
+}
+
+int main() {
+    const uint16_t sizes[] = {8, 32, 128, 512, MAX_PALETTE};
+
+    for(uint16_t i = 0; i < MAX_PALETTE; i++)
+        colors[i] = random_color();
+    for(uint16_t i = 0; i < QUERIES; i++)
+        queries[i] = random_color();
+
+    printf("Palette lookup, %u random queries, per query\n", QUERIES);
+    printf("  size     linear     k-d RGB    k-d LAB  RGB speedup\n");
+
+    for(uint8_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        uint16_t size = sizes[i];
+
+        double linear_ns = bench_ns([size] {
+            uint32_t sum = 0;
+            for(uint16_t query = 0; query < QUERIES; query++)
+                sum += linear_search(queries[query], size);
+            bench_sink = sum;
+        }, QUERIES);
+
+        TCS3200Palette rgb(nodes, size, TCS3200_METRIC_RGB);
+        rgb.build(colors);
+
+        double rgb_ns = bench_ns([&rgb] {
+            uint32_t sum = 0;
+            for(uint16_t query = 0; query < QUERIES; query++)
+                sum += rgb.classify(queries[query]).index;
+            bench_sink = sum;
+        }, QUERIES);
+
+        TCS3200Palette lab(nodes, size, TCS3200_METRIC_LAB);
+        lab.build(colors);
+
+        double lab_ns = bench_ns([&lab] {
+            uint32_t sum = 0;
+            for(uint16_t query = 0; query < QUERIES; query++)
+                sum += lab.classify(queries[query]).index;
+            bench_sink = sum;
+        }, QUERIES);
+
+        printf("  %4u %8.1f ns %8.1f ns %8.1f ns %8.2fx\n",
+            size, linear_ns, rgb_ns, lab_ns, linear_ns / rgb_ns);
+    }
+
+    return 0;
+}
@@ -0,0 +1,127 @@
+/*
+ * This file is part of the TCS3200 Color Sensor Arduino library.
+ * Copyright (c) 2023 Nathanne Isip
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "Arduino.h"
+
+#include <time.h>
+
+static uint8_t host_levels[HOST_PINS];
+static void (*host_isrs[HOST_PINS])();
+
+static uint64_t host_clock() {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return (uint64_t) time.tv_sec * 1000000ULL + time.tv_nsec / 1000;
+}
+
+static const uint64_t host_start = host_clock();
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    (void) pin;
+    (void) mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    if(pin < HOST_PINS)
+        host_levels[pin] = value != LOW;
+}
+
+int digitalRead(uint8_t pin) {
+    return pin < HOST_PINS ? host_levels[pin] : LOW;
+}
+
+unsigned long pulseIn(uint8_t pin, uint8_t state, unsigned long timeout) {
+    (void) pin;
+    (void) state;
+    (void) timeout;
+
+    // No signal is connected, so every measurement times out
+    return 0;
+}
+
+unsigned long micros() {
+    return (unsigned long) (host_clock() - host_start);
+}
+
+unsigned long millis() {
+    return (unsigned long) ((host_clock() - host_start) / 1000);
+}
+
+void delay(unsigned long ms) {
+    uint64_t end = host_clock() + (uint64_t) ms * 1000;
+    while(host_clock() < end);
+}
+
+void delayMicroseconds(unsigned int us) {
+    uint64_t end = host_clock() + us;
+    while(host_clock() < end);
+}
+
+long random(long max) {
+    return max > 0 ? rand() % max : 0;
+}
+
+long random(long min, long max) {
+    return min < max ? min + random(max - min) : min;
+}
+
+void randomSeed(unsigned long seed) {
+    srand((unsigned int) seed);
+}
+
+long map(long value, long from_low, long from_high, long to_low, long to_high) {
+    return (value - from_low) * (to_high - to_low) / (from_high - from_low) + to_low;
+}
+
+int digitalPinToInterrupt(uint8_t pin) {
+    return pin == 2 ? 0 : pin == 3 ? 1 : NOT_AN_INTERRUPT;
+}
+
+void attachInterrupt(uint8_t interrupt, void (*isr)(), int mode) {
+    (void) mode;
+
+    if(interrupt < HOST_PINS)
+        host_isrs[interrupt] = isr;
+}
+
+void detachInterrupt(uint8_t interrupt) {
+    if(interrupt < HOST_PINS)
+        host_isrs[interrupt] = nullptr;
+}
+
+void noInterrupts() { }
+
+void interrupts() { }
+
+bool host_interrupt(uint8_t interrupt) {
+    if(interrupt >= HOST_PINS || host_isrs[interrupt] == nullptr)
+        return false;
+
+    host_isrs[interrupt]();
+    return true;
+}
+
+void host_pin_level(uint8_t pin, uint8_t value) {
+    digitalWrite(pin, value);
+}
@@ -0,0 +1,126 @@
+/*
+ * This file is part of the TCS3200 Color Sensor Arduino library.
+ * Copyright (c) 2023 Nathanne Isip
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * 
+ * @file Arduino.h
+ * @brief Minimal Arduino core for building the library on a host.
+ *
+ * Provides the subset of the Arduino API the library uses, so it
+ * can be compiled and tested on Linux. Pins have no hardware behind
+ * them: sensors are driven through `TCS3200SimulatedHAL`. The clock
+ * follows the host's monotonic clock, and interrupts are attached
+ * to a table that `host_interrupt()` fires by hand.
+ *
+ * Pins 2 and 3 are the only ones with an external interrupt, like
+ * on an ATmega328P, so interrupt-less pins can be tested as well.
+ *
+ */
+#ifndef ARDUINO_HOST_H
+#define ARDUINO_HOST_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ARDUINO 10819
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT        0x0
+#define OUTPUT       0x1
+#define INPUT_PULLUP 0x2
+
+#define CHANGE  1
+#define FALLING 2
+#define RISING  3
+
+#define NOT_AN_INTERRUPT -1
+
+#define PI 3.1415926535897932384626433832795
+
+#define HOST_PINS 64
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+template<class T, class L>
+auto min(const T &a, const L &b) -> decltype((b < a) ? b : a) {
+    return (b < a) ? b : a;
+}
+
+template<class T, class L>
+auto max(const T &a, const L &b) -> decltype((b < a) ? b : a) {
+    return (a < b) ? b : a;
+}
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+unsigned long pulseIn(uint8_t pin, uint8_t state, unsigned long timeout = 1000000L);
+
+unsigned long micros();
+unsigned long millis();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+long map(long value, long from_low, long from_high, long to_low, long to_high);
+
+int digitalPinToInterrupt(uint8_t pin);
+void attachInterrupt(uint8_t interrupt, void (*isr)(), int mode);
+void detachInterrupt(uint8_t interrupt);
+void noInterrupts();
+void interrupts();
+
+// Host-only hooks for tests
+
+/**
+ * 
+ * @brief Run the function attached to an interrupt, if any.
+ * 
+ * @param interrupt Interrupt number from `digitalPinToInterrupt()`.
+ * 
+ * @return `true` if a function was attached and executed.
+ * 
+ */
+bool host_interrupt(uint8_t interrupt);
+
+/**
+ * 
+ * @brief Set the level `digitalRead()` returns for a pin.
+ * 
+ * @param pin Pin to be set.
+ * @param value `LOW` or `HIGH`.
+ * 
+ */
+void host_pin_level(uint8_t pin, uint8_t value);
+
+#endif
@@ -0,0 +1,72 @@
+/*
+ * This file is part of the TCS3200 Color Sensor Arduino library.
+ * Copyright (c) 2023 Nathanne Isip
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * 
+ * @file EEPROM.h
+ * @brief In-memory EEPROM for building the library on a host.
+ *
+ * Mirrors the AVR EEPROM library with a 1 KiB array that starts
+ * erased to 0xff, like a new ATmega328P.
+ *
+ */
+#ifndef EEPROM_HOST_H
+#define EEPROM_HOST_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define HOST_EEPROM_SIZE 1024
+
+class EEPROMClass {
+public:
+    uint8_t cells[HOST_EEPROM_SIZE];
+    uint32_t writes;
+
+    EEPROMClass():
+        writes(0) {
+        memset(this->cells, 0xff, sizeof(this->cells));
+    }
+
+    uint8_t read(int address) {
+        return this->cells[address];
+    }
+
+    void write(int address, uint8_t value) {
+        this->cells[address] = value;
+        this->writes++;
+    }
+
+    void update(int address, uint8_t value) {
+        if(this->cells[address] != value)
+            this->write(address, value);
+    }
+
+    uint16_t length() {
+        return HOST_EEPROM_SIZE;
+    }
+};
+
+static EEPROMClass EEPROM;
+
+#endif
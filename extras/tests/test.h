@@ -0,0 +1,76 @@
+/*
+ * This file is part of the TCS3200 Color Sensor Arduino library.
+ * Copyright (c) 2023 Nathanne Isip
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * 
+ * @file test.h
+ * @brief Minimal assertion helpers for the host unit tests.
+ *
+ * Every test is a separate executable registered with CTest. Checks
+ * print the failing expression and keep going, and `test_result()`
+ * turns the failure count into the exit status.
+ *
+ */
+#ifndef TCS3200_TEST_H
+#define TCS3200_TEST_H
+
+#include <math.h>
+#include <stdio.h>
+
+static int test_failures = 0;
+
+#define TEST_CHECK(condition) do { \
+        if(!(condition)) { \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            test_failures++; \
+        } \
+    } while(0)
+
+#define TEST_CHECK_EQUAL(actual, expected) do { \
+        long long test_actual = (long long) (actual); \
+        long long test_expected = (long long) (expected); \
+        if(test_actual != test_expected) { \
+            printf("%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__, \
+                #actual, test_actual, test_expected); \
+            test_failures++; \
+        } \
+    } while(0)
+
+#define TEST_CHECK_NEAR(actual, expected, tolerance) do { \
+        double test_actual = (double) (actual); \
+        double test_expected = (double) (expected); \
+        if(!(fabs(test_actual - test_expected) <= (tolerance))) { \
+            printf("%s:%d: %s is %g, expected %g +/- %g\n", __FILE__, __LINE__, \
+                #actual, test_actual, test_expected, (double) (tolerance)); \
+            test_failures++; \
+        } \
+    } while(0)
+
+static inline int test_result() {
+    if(test_failures > 0)
+        printf("%d check(s) failed\n", test_failures);
+
+    return test_failures > 0 ? 1 : 0;
+}
+
+#endif
@@ -0,0 +1,135 @@
+/*
+ * This file is part of the TCS3200 Color Sensor Arduino library.
+ * Copyright (c) 2023 Nathanne Isip
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "TCS3200Array.h"
+#include "TCS3200Simulator.h"
+#include "test.h"
+
+#define S0_PIN  4
+#define S1_PIN  5
+#define S2_PIN  6
+#define S3_PIN  7
+#define OUT_PIN 8
+
+// Enough pins for the largest number of slots
+static const uint8_t out_pins[8] = {
+    OUT_PIN, OUT_PIN + 1, OUT_PIN + 2, OUT_PIN + 3,
+    OUT_PIN + 4, OUT_PIN + 5, OUT_PIN + 6, OUT_PIN + 7
+};
+
+// Red, green, blue and clear frequencies of sensor i at 100% scaling
+static uint32_t frequency(uint8_t sensor, uint8_t channel) {
+    static const uint32_t base[4] = {20000, 15000, 10000, 40000};
+    return base[channel] + 1000 * sensor;
+}
+
+// Runs a frame of the first `count` sensors and returns its duration
+static uint32_t measure_frame(uint8_t count, bool expected_valid) {
+    TCS3200SimulatedHAL simulator(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN);
+    TCS3200ArraySensor states[TCS3200_EDGE_COUNTER_SLOTS];
+    TCS3200Array sensors(S0_PIN, S1_PIN, S2_PIN, S3_PIN, out_pins, states, count);
+
+    for(uint8_t i = 0; i < count; i++) {
+        if(i > 0)
+            simulator.add_output(out_pins[i]);
+        simulator.spectrum(out_pins[i],
+            frequency(i, 0), frequency(i, 1), frequency(i, 2), frequency(i, 3));
+    }
+
+    sensors.hal(&simulator);
+    sensors.begin();
+    sensors.frequency_scaling(TCS3200_OFREQ_20P);
+
+    uint32_t start = simulator.now();
+    sensors.read_frame();
+    uint32_t duration = simulator.now() - start;
+
+    TEST_CHECK_EQUAL(sensors.count(), count);
+    TEST_CHECK_EQUAL(sensors.failed(), 0);
+
+    // Every sensor gets its own readings out of the shared windows
+    for(uint8_t i = 0; i < count; i++) {
+        RawRGBC frame = sensors.frame(i);
+        uint32_t widths[4] = {frame.red, frame.green, frame.blue, frame.clear};
+
+        for(uint8_t channel = 0; channel < 4; channel++) {
+            double expected = 1e6 / (2 * frequency(i, channel) * 0.2);
+            TEST_CHECK_NEAR(widths[channel], expected, expected * 0.02 + 1);
+        }
+
+        TEST_CHECK_EQUAL(frame.valid, expected_valid ? 0x0f : 0);
+        TEST_CHECK_EQUAL(frame.scaling, TCS3200_OFREQ_20P);
+    }
+
+    return duration;
+}
+
+static void test_frame_time() {
+    uint32_t single = measure_frame(1, true);
+    uint32_t all = measure_frame(TCS3200_EDGE_COUNTER_SLOTS, true);
+
+    printf("Frame of 1 sensor: %u us, of %u sensors: %u us\n",
+        single, TCS3200_EDGE_COUNTER_SLOTS, all);
+
+    // The gate windows are shared, so more sensors cost no extra time
+    TEST_CHECK(single >= 4 * (TCS3200_SETTLING_TIME + 2000));
+    TEST_CHECK_NEAR(all, single, single * 0.02);
+}
+
+static void test_failed_sensor() {
+    TCS3200SimulatedHAL simulator(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN);
+    simulator.spectrum(10000, 5000, 2500, 20000);
+
+    // The second OUT pin is not simulated, so it has no interrupt
+    const uint8_t pins[2] = {OUT_PIN, OUT_PIN + 1};
+    TCS3200ArraySensor states[2];
+    TCS3200Array sensors(S0_PIN, S1_PIN, S2_PIN, S3_PIN, pins, states, 2);
+
+    sensors.hal(&simulator);
+    sensors.begin();
+    sensors.frequency_scaling(TCS3200_OFREQ_20P);
+    sensors.read_frame();
+
+    TEST_CHECK_EQUAL(sensors.failed(), 0x02);
+    TEST_CHECK_EQUAL(sensors.frame(0).valid, 0x0f);
+    TEST_CHECK_EQUAL(sensors.frame(0).red, 250);
+    TEST_CHECK_EQUAL(sensors.frame(1).valid, 0);
+    TEST_CHECK_EQUAL(sensors.frame(1).red, 0);
+
+    // Once the pin works again the next frame recovers
+    simulator.add_output(OUT_PIN + 1);
+    simulator.spectrum(OUT_PIN + 1, 10000, 5000, 2500, 20000);
+    sensors.read_frame();
+
+    TEST_CHECK_EQUAL(sensors.failed(), 0);
+    TEST_CHECK_EQUAL(sensors.frame(1).valid, 0x0f);
+}
+
+int main() {
+    test_frame_time();
+#if TCS3200_EDGE_COUNTER_SLOTS > 1
+    test_failed_sensor();
+#endif
+
+    return test_result();
+}
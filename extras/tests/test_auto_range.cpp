@@ -0,0 +1,149 @@
+/*
+ * This file is part of the TCS3200 Color Sensor Arduino library.
+ * Copyright (c) 2023 Nathanne Isip
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "TCS3200Simulator.h"
+#include "test.h"
+
+#define S0_PIN  4
+#define S1_PIN  5
+#define S2_PIN  6
+#define S3_PIN  7
+#define OUT_PIN 8
+
+// Reads frames until the scaling stops changing and returns it
+static int settle(TCS3200 &tcs3200) {
+    int scaling;
+
+    for(uint8_t i = 0; i < 8; i++) {
+        scaling = tcs3200.frequency_scaling();
+        TEST_CHECK_EQUAL(tcs3200.read_raw_rgbc().scaling, scaling);
+
+        if(tcs3200.frequency_scaling() == scaling)
+            break;
+    }
+
+    return tcs3200.frequency_scaling();
+}
+
+static void test_thresholds() {
+    TCS3200SimulatedHAL simulator(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN);
+    TCS3200 tcs3200(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN);
+
+    tcs3200.hal(&simulator);
+    tcs3200.begin();
+    tcs3200.frequency_scaling(TCS3200_OFREQ_20P);
+    tcs3200.auto_range(true);
+
+    // Pulses of 250 and 125 us are inside the range
+    simulator.spectrum(10000, 10000, 10000, 20000);
+    TEST_CHECK_EQUAL(settle(tcs3200), TCS3200_OFREQ_20P);
+
+    // A clear pulse of 6 us is saturated, 62 us at 2% is not
+    simulator.spectrum(200000, 200000, 200000, 400000);
+    tcs3200.read_raw_rgbc();
+    TEST_CHECK_EQUAL(tcs3200.frequency_scaling(), TCS3200_OFREQ_2P);
+    TEST_CHECK_EQUAL(settle(tcs3200), TCS3200_OFREQ_2P);
+
+    // Scaling down stops at 2%
+    simulator.spectrum(800000, 800000, 800000, 1600000);
+    TEST_CHECK_EQUAL(settle(tcs3200), TCS3200_OFREQ_2P);
+
+    // Pulses of 25000 us are too dark at 2% and still 2500 us at
+    // 20%, so a dark target climbs one step per frame up to 100%
+    simulator.spectrum(1000, 1000, 1000, 2000);
+    tcs3200.read_raw_rgbc();
+    TEST_CHECK_EQUAL(tcs3200.frequency_scaling(), TCS3200_OFREQ_20P);
+    tcs3200.read_raw_rgbc();
+    TEST_CHECK_EQUAL(tcs3200.frequency_scaling(), TCS3200_OFREQ_100P);
+    TEST_CHECK_EQUAL(settle(tcs3200), TCS3200_OFREQ_100P);
+
+    // Scaling up stops at 100%
+    simulator.spectrum(100, 100, 100, 200);
+    TEST_CHECK_EQUAL(settle(tcs3200), TCS3200_OFREQ_100P);
+}
+
+static void test_hysteresis() {
+    TCS3200SimulatedHAL simulator(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN);
+    TCS3200 tcs3200(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN);
+
+    tcs3200.hal(&simulator);
+    tcs3200.begin();
+    tcs3200.frequency_scaling(TCS3200_OFREQ_20P);
+    tcs3200.auto_range(true);
+
+    // A 19 us pulse scales down to 2%, where its 190 us stay far from
+    // the scale-up threshold, so the scaling does not oscillate
+    simulator.spectrum(10000, 10000, 10000, 131579);
+    tcs3200.read_raw_rgbc();
+    TEST_CHECK_EQUAL(tcs3200.frequency_scaling(), TCS3200_OFREQ_2P);
+
+    for(uint8_t i = 0; i < 4; i++)
+        TEST_CHECK_EQUAL(settle(tcs3200), TCS3200_OFREQ_2P);
+
+    // A red pulse of 2500 us is too dark, but the 25 us clear pulse
+    // would saturate at 100%, so the scaling is held at 20%
+    tcs3200.frequency_scaling(TCS3200_OFREQ_20P);
+    simulator.spectrum(1000, 20000, 20000, 100000);
+
+    for(uint8_t i = 0; i < 4; i++)
+        TEST_CHECK_EQUAL(settle(tcs3200), TCS3200_OFREQ_20P);
+
+    // Once the clear pulse leaves room for it, the scaling steps up
+    simulator.spectrum(1000, 20000, 20000, 20000);
+    tcs3200.read_raw_rgbc();
+    TEST_CHECK_EQUAL(tcs3200.frequency_scaling(), TCS3200_OFREQ_100P);
+
+    // Disabling auto-ranging keeps the current scaling
+    tcs3200.auto_range(false);
+    simulator.spectrum(200000, 200000, 200000, 400000);
+    tcs3200.read_raw_rgbc();
+    TEST_CHECK_EQUAL(tcs3200.frequency_scaling(), TCS3200_OFREQ_100P);
+}
+
+static void test_loop() {
+    TCS3200SimulatedHAL simulator(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN);
+    TCS3200 tcs3200(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN);
+
+    simulator.spectrum(200000, 200000, 200000, 400000);
+    tcs3200.hal(&simulator);
+    tcs3200.begin();
+    tcs3200.frequency_scaling(TCS3200_OFREQ_20P);
+    tcs3200.auto_range(true);
+    tcs3200.sampling(true);
+
+    // Frames of loop() switch the scaling the same way
+    for(uint8_t frame = 0; frame < 3; frame++) {
+        while(!tcs3200.available())
+            tcs3200.loop();
+        tcs3200.read_frame();
+    }
+
+    TEST_CHECK_EQUAL(tcs3200.frequency_scaling(), TCS3200_OFREQ_2P);
+}
+
+int main() {
+    test_thresholds();
+    test_hysteresis();
+    test_loop();
+
+    return test_result();
+}
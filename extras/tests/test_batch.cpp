@@ -0,0 +1,151 @@
+/*
+ * This file is part of the TCS3200 Color Sensor Arduino library.
+ * Copyright (c) 2023 Nathanne Isip
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "TCS3200Batch.h"
+#include "test.h"
+
+#include <string.h>
+
+#define BLOCK 4096
+
+static RGBColor colors[BLOCK];
+static uint8_t red[BLOCK], green[BLOCK], blue[BLOCK];
+static HSVColor hsv[BLOCK];
+static CIE1931Color xyz[BLOCK];
+static CIELabColor lab[BLOCK], lab_direct[BLOCK];
+static float channels[6][BLOCK];
+
+// Compares the bits, so rounding differences are not hidden
+static bool same(float first, float second) {
+    return memcmp(&first, &second, sizeof(float)) == 0;
+}
+
+static uint32_t check_block(size_t count) {
+    uint32_t mismatches = 0;
+
+    convert_rgb_to_hsv(colors, hsv, count);
+    convert_rgb_to_cie1931(colors, xyz, count);
+    convert_cie1931_to_cielab(xyz, lab, count);
+    convert_rgb_to_cielab(colors, lab_direct, count);
+
+    // With TCS3200_FIXED_POINT the per-sample conversions use Q16.16
+    // while the batches stay in floating-point
+#if !TCS3200_FIXED_POINT
+    for(size_t i = 0; i < count; i++) {
+        HSVColor expected_hsv = TCS3200::rgb_to_hsv(colors[i]);
+        CIE1931Color expected_xyz = TCS3200::rgb_to_cie1931(colors[i]);
+        CIELabColor expected_lab = TCS3200::cie1931_to_cielab(expected_xyz);
+
+        if(!same(hsv[i].hue, expected_hsv.hue) ||
+            !same(hsv[i].saturation, expected_hsv.saturation) ||
+            !same(hsv[i].value, expected_hsv.value) ||
+            !same(xyz[i].x, expected_xyz.x) ||
+            !same(xyz[i].y, expected_xyz.y) ||
+            !same(xyz[i].z, expected_xyz.z) ||
+            !same(lab[i].l, expected_lab.l) ||
+            !same(lab[i].a, expected_lab.a) ||
+            !same(lab[i].b, expected_lab.b) ||
+            !same(lab_direct[i].l, expected_lab.l) ||
+            !same(lab_direct[i].a, expected_lab.a) ||
+            !same(lab_direct[i].b, expected_lab.b))
+            mismatches++;
+    }
+#endif
+
+    // The channel array forms match the arrays of structures
+    tcs3200_deinterleave_rgb(colors, red, green, blue, count);
+
+    convert_rgb_to_hsv(red, green, blue, channels[0], channels[1], channels[2], count);
+    for(size_t i = 0; i < count; i++)
+        if(!same(channels[0][i], hsv[i].hue) ||
+            !same(channels[1][i], hsv[i].saturation) ||
+            !same(channels[2][i], hsv[i].value))
+            mismatches++;
+
+    convert_rgb_to_cie1931(red, green, blue, channels[0], channels[1], channels[2], count);
+    convert_cie1931_to_cielab(channels[0], channels[1], channels[2],
+        channels[3], channels[4], channels[5], count);
+    for(size_t i = 0; i < count; i++)
+        if(!same(channels[0][i], xyz[i].x) ||
+            !same(channels[1][i], xyz[i].y) ||
+            !same(channels[2][i], xyz[i].z) ||
+            !same(channels[3][i], lab[i].l) ||
+            !same(channels[4][i], lab[i].a) ||
+            !same(channels[5][i], lab[i].b))
+            mismatches++;
+
+    convert_rgb_to_cielab(red, green, blue, channels[0], channels[1], channels[2], count);
+    for(size_t i = 0; i < count; i++)
+        if(!same(channels[0][i], lab[i].l) ||
+            !same(channels[1][i], lab[i].a) ||
+            !same(channels[2][i], lab[i].b))
+            mismatches++;
+
+    return mismatches;
+}
+
+static void test_rgb_cube() {
+    uint32_t mismatches = 0;
+
+    for(uint32_t start = 0; start < 0x1000000; start += BLOCK) {
+        for(uint32_t i = 0; i < BLOCK; i++) {
+            colors[i].red = start + i;
+            colors[i].green = (start + i) >> 8;
+            colors[i].blue = (start + i) >> 16;
+        }
+
+        mismatches += check_block(BLOCK);
+    }
+
+    TEST_CHECK_EQUAL(mismatches, 0);
+}
+
+static void test_counts() {
+    uint32_t state = 0x2545f491;
+    for(uint32_t i = 0; i < BLOCK; i++) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+
+        colors[i].red = state;
+        colors[i].green = state >> 8;
+        colors[i].blue = state >> 16;
+    }
+
+    // Counts around the block and vector sizes exercise every tail
+    const size_t counts[] = {0, 1, 3, 4, 5, 7, 8, 9, 15, 17, 63, 64, 65, 129, 1000};
+    for(uint8_t i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+        hsv[counts[i]].hue = -1.0f;
+        TEST_CHECK_EQUAL(check_block(counts[i]), 0);
+
+        // Nothing past the end is written
+        TEST_CHECK_NEAR(hsv[counts[i]].hue, -1.0f, 0);
+    }
+}
+
+int main() {
+    test_rgb_cube();
+    test_counts();
+
+    return test_result();
+}
@@ -0,0 +1,145 @@
+/*
+ * This file is part of the TCS3200 Color Sensor Arduino library.
+ * Copyright (c) 2023 Nathanne Isip
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "TCS3200RingBuffer.h"
+#include "TCS3200Simulator.h"
+#include "test.h"
+
+#define S0_PIN  4
+#define S1_PIN  5
+#define S2_PIN  6
+#define S3_PIN  7
+#define OUT_PIN 8
+
+#define SAMPLES 25
+
+// Simulator keeping every pulse width it measures, in read order
+class RecordingHAL : public TCS3200SimulatedHAL {
+public:
+    uint32_t pulses[4 * SAMPLES];
+    uint16_t count;
+
+    RecordingHAL():
+        TCS3200SimulatedHAL(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN),
+        count(0) { }
+
+    uint32_t pulse_in(uint8_t pin, uint8_t state, uint32_t timeout) {
+        uint32_t pulse = TCS3200SimulatedHAL::pulse_in(pin, state, timeout);
+
+        if(this->count < 4 * SAMPLES)
+            this->pulses[this->count++] = pulse;
+
+        return pulse;
+    }
+};
+
+static RecordingHAL simulator;
+static TCS3200 tcs3200(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN);
+
+static uint32_t samples[4][SAMPLES];
+
+// Mean without the lowest and highest sample, and two-pass variance
+static void check_channel(const uint32_t *values, uint32_t mean, float variance) {
+    uint32_t lowest = values[0], highest = values[0];
+    uint64_t sum = 0;
+
+    for(uint8_t i = 0; i < SAMPLES; i++) {
+        lowest = values[i] < lowest ? values[i] : lowest;
+        highest = values[i] > highest ? values[i] : highest;
+        sum += values[i];
+    }
+
+    double average = (double) sum / SAMPLES, squares = 0;
+    for(uint8_t i = 0; i < SAMPLES; i++)
+        squares += (values[i] - average) * (values[i] - average);
+
+    TEST_CHECK(highest > lowest);
+    TEST_CHECK_EQUAL(mean, (uint32_t) ((sum - lowest - highest) / (SAMPLES - 2)));
+    TEST_CHECK_NEAR(variance, squares / (SAMPLES - 1), squares / (SAMPLES - 1) * 1e-4);
+}
+
+static void check_stats(CalibrationStats stats) {
+    TEST_CHECK_EQUAL(stats.samples, SAMPLES);
+
+    check_channel(samples[TCS3200_COLOR_RED], stats.red, stats.red_variance);
+    check_channel(samples[TCS3200_COLOR_GREEN], stats.green, stats.green_variance);
+    check_channel(samples[TCS3200_COLOR_BLUE], stats.blue, stats.blue_variance);
+    check_channel(samples[TCS3200_COLOR_CLEAR], stats.clear, stats.clear_variance);
+}
+
+static void test_blocking() {
+    simulator.count = 0;
+    tcs3200.calibrate_light();
+    TEST_CHECK_EQUAL(simulator.count, 4 * SAMPLES);
+
+    // Frames are read in red, green, blue, clear order
+    for(uint8_t i = 0; i < SAMPLES; i++)
+        for(uint8_t channel = 0; channel < 4; channel++)
+            samples[channel][i] = simulator.pulses[i * 4 + channel];
+
+    check_stats(tcs3200.calibration_stats());
+}
+
+static void test_non_blocking() {
+    RawRGBC storage[32];
+    TCS3200RingBuffer buffer(storage, 32);
+    TCS3200RingCursor cursor;
+
+    // The ring buffer receives the same frames as the calibration
+    buffer.attach(cursor);
+    tcs3200.attach_ring_buffer(&buffer);
+    tcs3200.start_calibration(TCS3200_CAL_DARK);
+
+    while(tcs3200.calibrating())
+        tcs3200.loop();
+    tcs3200.attach_ring_buffer(nullptr);
+
+    RawRGBC frame;
+    for(uint8_t i = 0; i < SAMPLES; i++) {
+        TEST_CHECK(buffer.read(cursor, &frame));
+
+        samples[TCS3200_COLOR_RED][i] = frame.red;
+        samples[TCS3200_COLOR_GREEN][i] = frame.green;
+        samples[TCS3200_COLOR_BLUE][i] = frame.blue;
+        samples[TCS3200_COLOR_CLEAR][i] = frame.clear;
+    }
+
+    check_stats(tcs3200.calibration_stats());
+}
+
+int main() {
+    tcs3200.hal(&simulator);
+    tcs3200.begin();
+    tcs3200.frequency_scaling(TCS3200_OFREQ_20P);
+    tcs3200.calibration_samples(SAMPLES);
+
+    // 10% period jitter around pulses of 250, 500, 1000 and 125 us
+    simulator.spectrum(10000, 5000, 2500, 20000);
+    simulator.noise(10);
+    test_blocking();
+
+    simulator.spectrum(1000, 800, 600, 2500);
+    tcs3200.integration_time(20000);
+    test_non_blocking();
+
+    return test_result();
+}
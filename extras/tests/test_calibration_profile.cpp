@@ -0,0 +1,153 @@
+/*
+ * This file is part of the TCS3200 Color Sensor Arduino library.
+ * Copyright (c) 2023 Nathanne Isip
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "TCS3200EEPROM.h"
+#include "TCS3200File.h"
+#include "TCS3200Simulator.h"
+#include "test.h"
+
+#include <time.h>
+
+#define S0_PIN  4
+#define S1_PIN  5
+#define S2_PIN  6
+#define S3_PIN  7
+#define OUT_PIN 8
+
+#define PROFILE_PATH "test_calibration_profile.cal"
+
+static void calibrate(TCS3200 &tcs3200, TCS3200SimulatedHAL &simulator) {
+    tcs3200.frequency_scaling(TCS3200_OFREQ_20P);
+
+    simulator.spectrum(30000, 28000, 25000, 80000);
+    tcs3200.calibrate_light();
+    simulator.spectrum(300, 280, 250, 800);
+    tcs3200.calibrate_dark();
+    tcs3200.calibrate();
+
+    RGBColor white = {250, 240, 230};
+    tcs3200.white_balance(white);
+}
+
+static bool same_reading(TCS3200 &first, TCS3200SimulatedHAL &first_simulator,
+    TCS3200 &second, TCS3200SimulatedHAL &second_simulator) {
+    first_simulator.spectrum(12000, 6000, 3000, 20000);
+    second_simulator.spectrum(12000, 6000, 3000, 20000);
+
+    RGBColor a = first.read_rgb_color(), b = second.read_rgb_color();
+    return a.red == b.red && a.green == b.green && a.blue == b.blue;
+}
+
+static void corrupt(const char *path, long offset) {
+    FILE *file = fopen(path, "r+b");
+    fseek(file, offset, SEEK_SET);
+    int value = fgetc(file);
+
+    fseek(file, offset, SEEK_SET);
+    fputc(value ^ 0x01, file);
+    fclose(file);
+}
+
+static void test_file() {
+    TCS3200SimulatedHAL simulator(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN);
+    TCS3200SimulatedHAL restored_simulator(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN);
+    TCS3200 tcs3200(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN);
+    TCS3200 restored(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN);
+    TCS3200FileStorage storage(PROFILE_PATH);
+
+    remove(PROFILE_PATH);
+
+    tcs3200.hal(&simulator);
+    tcs3200.begin();
+    restored.hal(&restored_simulator);
+    restored.begin();
+
+    // Nothing stored yet
+    TEST_CHECK(!restored.load_calibration(storage));
+
+    calibrate(tcs3200, simulator);
+    TEST_CHECK(tcs3200.save_calibration(storage, 16));
+    TEST_CHECK(!restored.load_calibration(storage, 0));
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    TEST_CHECK(restored.load_calibration(storage, 16));
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double load_time = (end.tv_sec - start.tv_sec) * 1e6 + (end.tv_nsec - start.tv_nsec) / 1e3;
+    printf("Profile loaded from a file in %.1f us\n", load_time);
+
+    TEST_CHECK_EQUAL(restored.frequency_scaling(), TCS3200_OFREQ_20P);
+    TEST_CHECK_EQUAL(restored.white_balance().red, 250);
+    TEST_CHECK_EQUAL(restored.white_balance().green, 240);
+    TEST_CHECK_EQUAL(restored.white_balance().blue, 230);
+    TEST_CHECK(same_reading(tcs3200, simulator, restored, restored_simulator));
+
+    // A flipped bit anywhere in the profile rejects it
+    TCS3200 untouched(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN);
+    for(long offset = 0; offset < TCS3200_CALIBRATION_SIZE; offset++) {
+        corrupt(PROFILE_PATH, 16 + offset);
+        TEST_CHECK(!untouched.load_calibration(storage, 16));
+        corrupt(PROFILE_PATH, 16 + offset);
+    }
+
+    TEST_CHECK(untouched.load_calibration(storage, 16));
+    remove(PROFILE_PATH);
+}
+
+static void test_eeprom() {
+    TCS3200SimulatedHAL simulator(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN);
+    TCS3200SimulatedHAL restored_simulator(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN);
+    TCS3200 tcs3200(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN);
+    TCS3200 restored(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN);
+    TCS3200EEPROMStorage storage;
+
+    tcs3200.hal(&simulator);
+    tcs3200.begin();
+    restored.hal(&restored_simulator);
+    restored.begin();
+
+    // Erased EEPROM holds no profile
+    TEST_CHECK(!restored.load_calibration(storage));
+
+    calibrate(tcs3200, simulator);
+    TEST_CHECK(tcs3200.save_calibration(storage));
+    TEST_CHECK(restored.load_calibration(storage));
+    TEST_CHECK(same_reading(tcs3200, simulator, restored, restored_simulator));
+
+    // Saving the same profile again does not wear the cells
+    uint32_t writes = EEPROM.writes;
+    TEST_CHECK(tcs3200.save_calibration(storage));
+    TEST_CHECK_EQUAL(EEPROM.writes, writes);
+
+    // Profiles must fit in the EEPROM
+    TEST_CHECK(!tcs3200.save_calibration(storage, EEPROM.length() - TCS3200_CALIBRATION_SIZE + 1));
+    TEST_CHECK(tcs3200.save_calibration(storage, EEPROM.length() - TCS3200_CALIBRATION_SIZE));
+}
+
+int main() {
+    test_file();
+    test_eeprom();
+
+    return test_result();
+}
@@ -0,0 +1,162 @@
+/*
+ * This file is part of the TCS3200 Color Sensor Arduino library.
+ * Copyright (c) 2023 Nathanne Isip
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "TCS3200Simulator.h"
+#include "test.h"
+
+#define S0_PIN  4
+#define S1_PIN  5
+#define S2_PIN  6
+#define S3_PIN  7
+#define OUT_PIN 8
+
+// Simulator recording the channel of every pulse measurement and the
+// number of S2/S3 pin writes
+class RecordingHAL : public TCS3200SimulatedHAL {
+public:
+    uint8_t s2, s3, channels[8], count;
+    uint32_t filter_writes;
+
+    RecordingHAL():
+        TCS3200SimulatedHAL(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN),
+        s2(LOW), s3(LOW), count(0), filter_writes(0) { }
+
+    void digital_write(uint8_t pin, uint8_t value) {
+        TCS3200SimulatedHAL::digital_write(pin, value);
+
+        if(pin == S2_PIN)
+            this->s2 = value, this->filter_writes++;
+        else if(pin == S3_PIN)
+            this->s3 = value, this->filter_writes++;
+    }
+
+    uint32_t pulse_in(uint8_t pin, uint8_t state, uint32_t timeout) {
+        static const uint8_t channels[2][2] = {
+            {TCS3200_COLOR_RED, TCS3200_COLOR_BLUE},
+            {TCS3200_COLOR_CLEAR, TCS3200_COLOR_GREEN}
+        };
+
+        if(this->count < 8)
+            this->channels[this->count++] = channels[this->s2 != LOW][this->s3 != LOW];
+
+        return TCS3200SimulatedHAL::pulse_in(pin, state, timeout);
+    }
+};
+
+static RecordingHAL simulator;
+static TCS3200 tcs3200(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN);
+
+static bool equal(RGBColor color, uint8_t red, uint8_t green, uint8_t blue) {
+    return color.red == red && color.green == green && color.blue == blue;
+}
+
+static void test_chromaticity() {
+    // At 20% scaling the pulses are 500, 250, 125 and 100 us, so the
+    // clear ratios are 0.2, 0.4 and 0.8
+    simulator.spectrum(5000, 10000, 20000, 25000);
+    TEST_CHECK(equal(tcs3200.read_chromaticity(), 51, 102, 204));
+
+    // Half the light at the same color gives the same chromaticity
+    simulator.spectrum(2500, 5000, 10000, 12500);
+    TEST_CHECK(equal(tcs3200.read_chromaticity(), 51, 102, 204));
+}
+
+static void test_ir_compensation() {
+    simulator.spectrum(10000, 5000, 2500, 12500);
+    TEST_CHECK(equal(tcs3200.read_chromaticity(), 204, 102, 51));
+
+    // The RGB frequencies exceed the clear one by 5000 Hz, so 2500 Hz
+    // of infrared leaves 7500, 2500, 0 and 10000 Hz
+    tcs3200.ir_compensation(true);
+    TEST_CHECK(tcs3200.ir_compensation());
+    TEST_CHECK(equal(tcs3200.read_chromaticity(), 191, 64, 0));
+
+    // Without an excess there is no infrared to subtract
+    simulator.spectrum(5000, 5000, 10000, 25000);
+    TEST_CHECK(equal(tcs3200.read_chromaticity(), 51, 51, 102));
+
+    // The calibrated white reads white with or without compensation
+    simulator.spectrum(25000, 25000, 25000, 50000);
+    tcs3200.calibrate_light();
+    simulator.spectrum(2500, 2500, 2500, 5000);
+    tcs3200.calibrate_dark();
+    tcs3200.calibrate();
+
+    simulator.spectrum(25000, 25000, 25000, 50000);
+    TEST_CHECK(equal(tcs3200.read_chromaticity(), 255, 255, 255));
+    tcs3200.ir_compensation(false);
+    TEST_CHECK(equal(tcs3200.read_chromaticity(), 255, 255, 255));
+}
+
+static void test_channel_order() {
+    const uint8_t gray[4] = {
+        TCS3200_COLOR_RED, TCS3200_COLOR_BLUE, TCS3200_COLOR_GREEN, TCS3200_COLOR_CLEAR
+    };
+
+    simulator.spectrum(5000, 10000, 20000, 25000);
+    TEST_CHECK_EQUAL(tcs3200.channel_order(), TCS3200_ORDER_RGBC);
+
+    tcs3200.channel_order(TCS3200_ORDER_GRAY);
+    TEST_CHECK_EQUAL(tcs3200.channel_order(), TCS3200_ORDER_GRAY);
+
+    // The measurement order changes, the channels of the frame do not
+    tcs3200.read_red();
+    simulator.count = 0;
+    simulator.filter_writes = 0;
+
+    RawRGBC raw = tcs3200.read_raw_rgbc();
+    TEST_CHECK_EQUAL(raw.red, 500);
+    TEST_CHECK_EQUAL(raw.green, 250);
+    TEST_CHECK_EQUAL(raw.blue, 125);
+    TEST_CHECK_EQUAL(raw.clear, 100);
+    TEST_CHECK_EQUAL(simulator.count, 4);
+
+    for(uint8_t i = 0; i < 4; i++)
+        TEST_CHECK_EQUAL(simulator.channels[i], gray[i]);
+
+    // Every switch, including the one back to red, changes one pin
+    TEST_CHECK_EQUAL(simulator.filter_writes, 3);
+    tcs3200.read_red();
+    TEST_CHECK_EQUAL(simulator.filter_writes, 4);
+
+    // Unknown orders fall back to red, green, blue, clear
+    tcs3200.channel_order(0x7f);
+    TEST_CHECK_EQUAL(tcs3200.channel_order(), TCS3200_ORDER_RGBC);
+
+    simulator.count = 0;
+    raw = tcs3200.read_raw_rgbc();
+    TEST_CHECK_EQUAL(raw.blue, 125);
+    TEST_CHECK_EQUAL(simulator.channels[1], TCS3200_COLOR_GREEN);
+    TEST_CHECK_EQUAL(simulator.channels[2], TCS3200_COLOR_BLUE);
+}
+
+int main() {
+    tcs3200.hal(&simulator);
+    tcs3200.begin();
+    tcs3200.frequency_scaling(TCS3200_OFREQ_20P);
+
+    test_chromaticity();
+    test_ir_compensation();
+    test_channel_order();
+
+    return test_result();
+}
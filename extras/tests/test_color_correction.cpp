@@ -0,0 +1,216 @@
+/*
+ * This file is part of the TCS3200 Color Sensor Arduino library.
+ * Copyright (c) 2023 Nathanne Isip
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "TCS3200Simulator.h"
+#include "test.h"
+
+#define S0_PIN  4
+#define S1_PIN  5
+#define S2_PIN  6
+#define S3_PIN  7
+#define OUT_PIN 8
+
+// Swaps red and blue, so corrected and uncorrected readings differ
+static const float swap_red_blue[3][4] = {
+    {0, 0, 1, 0},
+    {0, 1, 0, 0},
+    {1, 0, 0, 0}
+};
+
+static TCS3200SimulatedHAL simulator(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN);
+static TCS3200 tcs3200(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN);
+static uint32_t upper_callbacks = 0;
+
+static void on_upper_bound() {
+    upper_callbacks++;
+}
+
+static bool equal(RGBColor first, RGBColor second) {
+    return first.red == second.red &&
+        first.green == second.green &&
+        first.blue == second.blue;
+}
+
+static void calibrate() {
+    tcs3200.hal(&simulator);
+    tcs3200.begin();
+    tcs3200.frequency_scaling(TCS3200_OFREQ_20P);
+
+    simulator.spectrum(30000, 30000, 30000, 80000);
+    tcs3200.calibrate_light();
+    simulator.spectrum(1000, 1000, 1000, 2500);
+    tcs3200.calibrate_dark();
+    tcs3200.calibrate();
+}
+
+static void test_white() {
+    const RGBColor white = {255, 255, 255};
+
+    simulator.spectrum(30000, 30000, 30000, 80000);
+    TEST_CHECK(equal(tcs3200.read_uncorrected_rgb_color(), white));
+    TEST_CHECK(equal(tcs3200.read_rgb_color(), white));
+
+    RGBCColor rgbc = tcs3200.read_rgbc_color();
+    TEST_CHECK(equal({rgbc.red, rgbc.green, rgbc.blue}, white));
+
+    // A tinted light source calibrates to white as well
+    simulator.spectrum(30000, 15000, 60000, 80000);
+    tcs3200.calibrate_light();
+    tcs3200.calibrate();
+    TEST_CHECK(equal(tcs3200.read_rgb_color(), white));
+    TEST_CHECK(equal(tcs3200.white_balance(), white));
+
+    // At 2% scaling the white pulses are longer than 255 us
+    tcs3200.begin();
+    tcs3200.frequency_scaling(TCS3200_OFREQ_2P);
+    tcs3200.calibrate_light();
+    simulator.spectrum(1000, 1000, 1000, 2500);
+    tcs3200.calibrate_dark();
+    tcs3200.calibrate();
+
+    simulator.spectrum(30000, 15000, 60000, 80000);
+    TEST_CHECK(tcs3200.read_raw_red() > 255);
+    TEST_CHECK(equal(tcs3200.read_rgb_color(), white));
+
+    calibrate();
+}
+
+static void test_reads() {
+    simulator.spectrum(5000, 2000, 1300, 8000);
+    tcs3200.color_correction(swap_red_blue);
+
+    RGBColor uncorrected = tcs3200.read_uncorrected_rgb_color();
+    RGBColor corrected = tcs3200.read_rgb_color();
+
+    TEST_CHECK(uncorrected.red > uncorrected.blue + 50);
+    TEST_CHECK(equal(corrected, tcs3200.apply_white_balance(uncorrected)));
+    TEST_CHECK_EQUAL(corrected.red, uncorrected.blue);
+    TEST_CHECK_EQUAL(corrected.blue, uncorrected.red);
+
+    RGBCColor rgbc = tcs3200.read_rgbc_color();
+    TEST_CHECK_EQUAL(rgbc.red, corrected.red);
+    TEST_CHECK_EQUAL(rgbc.green, corrected.green);
+    TEST_CHECK_EQUAL(rgbc.blue, corrected.blue);
+
+    TEST_CHECK_EQUAL(tcs3200.get_rgb_dominant_color(), TCS3200_COLOR_BLUE);
+
+    const char *labels[2] = {"red", "blue"};
+    RGBColor values[2] = {{255, 0, 0}, {0, 0, 255}};
+    TEST_CHECK(strcmp(tcs3200.nearest_color<const char *>(labels, values, 2), "blue") == 0);
+
+    HSVColor hsv = tcs3200.read_hsv();
+    TEST_CHECK_NEAR(hsv.hue, TCS3200::rgb_to_hsv(corrected).hue, 1e-3);
+
+    // The samples still carry both halves
+    ColorSample sample = tcs3200.read_sample();
+    TEST_CHECK(equal(sample.rgb(), uncorrected));
+    TEST_CHECK_NEAR(sample.hsv().hue, hsv.hue, 1e-3);
+
+    tcs3200.clear_color_correction();
+}
+
+static void run_frames(uint8_t count) {
+    for(uint8_t frames = 0; frames < count; ) {
+        tcs3200.loop();
+
+        if(tcs3200.available()) {
+            tcs3200.read_frame();
+            frames++;
+        }
+    }
+}
+
+static void test_bounds() {
+    simulator.spectrum(5000, 2000, 1300, 8000);
+    RGBColor balanced = tcs3200.read_rgb_color();
+
+    tcs3200.color_correction(swap_red_blue);
+    RGBColor swapped = tcs3200.read_rgb_color();
+
+    // Only the readings without the swap reach the threshold
+    RGBColor threshold = {(uint8_t) (balanced.red - 20), 0, 0};
+    TEST_CHECK(swapped.red < threshold.red);
+    tcs3200.upper_bound_interrupt(threshold, on_upper_bound);
+
+    // Long enough gates to count edges of the dimmest channel
+    tcs3200.integration_time(10000);
+    run_frames(4);
+    TEST_CHECK_EQUAL(upper_callbacks, 0);
+
+    tcs3200.clear_color_correction();
+    run_frames(4);
+    TEST_CHECK(upper_callbacks > 0);
+
+    tcs3200.clear_upper_bound_interrupt();
+    tcs3200.integration_time(2000);
+}
+
+static void test_fit() {
+    // A chart spans dark to bright as well as the hues
+    const uint32_t spectra[8][3] = {
+        {5000, 2000, 1300}, {1500, 6000, 2500}, {1200, 1600, 8000},
+        {3000, 3000, 3000}, {2200, 1100, 4000}, {3500, 9000, 1050},
+        {1100, 1100, 1100}, {20000, 20000, 20000}
+    };
+    RGBColor measured[8], reference[8];
+
+    tcs3200.clear_color_correction();
+    for(uint8_t i = 0; i < 8; i++) {
+        simulator.spectrum(spectra[i][0], spectra[i][1], spectra[i][2], 8000);
+        measured[i] = tcs3200.read_uncorrected_rgb_color();
+
+        // The chart reads a little warm and dark
+        reference[i].red = min(255, measured[i].red * 9 / 10 + 10);
+        reference[i].green = measured[i].green * 8 / 10 + 20;
+        reference[i].blue = measured[i].blue * 8 / 10 + measured[i].red / 10;
+    }
+
+    TEST_CHECK(tcs3200.fit_color_correction(measured, reference, 8));
+    TEST_CHECK(tcs3200.color_correction());
+
+    for(uint8_t i = 0; i < 8; i++) {
+        simulator.spectrum(spectra[i][0], spectra[i][1], spectra[i][2], 8000);
+        RGBColor corrected = tcs3200.read_rgb_color();
+
+        TEST_CHECK_NEAR(corrected.red, reference[i].red, 2);
+        TEST_CHECK_NEAR(corrected.green, reference[i].green, 2);
+        TEST_CHECK_NEAR(corrected.blue, reference[i].blue, 2);
+    }
+
+    // Patches are measured uncorrected even while the matrix is set
+    simulator.spectrum(spectra[0][0], spectra[0][1], spectra[0][2], 8000);
+    TEST_CHECK(equal(tcs3200.read_uncorrected_rgb_color(), measured[0]));
+
+    tcs3200.clear_color_correction();
+}
+
+int main() {
+    calibrate();
+
+    test_white();
+    test_reads();
+    test_bounds();
+    test_fit();
+
+    return test_result();
+}
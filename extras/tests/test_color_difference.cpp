@@ -0,0 +1,139 @@
+/*
+ * This file is part of the TCS3200 Color Sensor Arduino library.
+ * Copyright (c) 2023 Nathanne Isip
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "TCS3200.h"
+#include "test.h"
+
+// Sharma, Wu and Dalal, "The CIEDE2000 color-difference formula:
+// implementation notes, supplementary test data, and mathematical
+// observations", Table 1
+static const float sharma_pairs[34][7] = {
+    {50.0000f,   2.6772f, -79.7751f, 50.0000f,   0.0000f, -82.7485f,  2.0425f},
+    {50.0000f,   3.1571f, -77.2803f, 50.0000f,   0.0000f, -82.7485f,  2.8615f},
+    {50.0000f,   2.8361f, -74.0200f, 50.0000f,   0.0000f, -82.7485f,  3.4412f},
+    {50.0000f,  -1.3802f, -84.2814f, 50.0000f,   0.0000f, -82.7485f,  1.0000f},
+    {50.0000f,  -1.1848f, -84.8006f, 50.0000f,   0.0000f, -82.7485f,  1.0000f},
+    {50.0000f,  -0.9009f, -85.5211f, 50.0000f,   0.0000f, -82.7485f,  1.0000f},
+    {50.0000f,   0.0000f,   0.0000f, 50.0000f,  -1.0000f,   2.0000f,  2.3669f},
+    {50.0000f,  -1.0000f,   2.0000f, 50.0000f,   0.0000f,   0.0000f,  2.3669f},
+    {50.0000f,   2.4900f,  -0.0010f, 50.0000f,  -2.4900f,   0.0009f,  7.1792f},
+    {50.0000f,   2.4900f,  -0.0010f, 50.0000f,  -2.4900f,   0.0010f,  7.1792f},
+    {50.0000f,   2.4900f,  -0.0010f, 50.0000f,  -2.4900f,   0.0011f,  7.2195f},
+    {50.0000f,   2.4900f,  -0.0010f, 50.0000f,  -2.4900f,   0.0012f,  7.2195f},
+    {50.0000f,  -0.0010f,   2.4900f, 50.0000f,   0.0009f,  -2.4900f,  4.8045f},
+    {50.0000f,  -0.0010f,   2.4900f, 50.0000f,   0.0010f,  -2.4900f,  4.8045f},
+    {50.0000f,  -0.0010f,   2.4900f, 50.0000f,   0.0011f,  -2.4900f,  4.7461f},
+    {50.0000f,   2.5000f,   0.0000f, 50.0000f,   0.0000f,  -2.5000f,  4.3065f},
+    {50.0000f,   2.5000f,   0.0000f, 73.0000f,  25.0000f, -18.0000f, 27.1492f},
+    {50.0000f,   2.5000f,   0.0000f, 61.0000f,  -5.0000f,  29.0000f, 22.8977f},
+    {50.0000f,   2.5000f,   0.0000f, 56.0000f, -27.0000f,  -3.0000f, 31.9030f},
+    {50.0000f,   2.5000f,   0.0000f, 58.0000f,  24.0000f,  15.0000f, 19.4535f},
+    {50.0000f,   2.5000f,   0.0000f, 50.0000f,   3.1736f,   0.5854f,  1.0000f},
+    {50.0000f,   2.5000f,   0.0000f, 50.0000f,   3.2972f,   0.0000f,  1.0000f},
+    {50.0000f,   2.5000f,   0.0000f, 50.0000f,   1.8634f,   0.5757f,  1.0000f},
+    {50.0000f,   2.5000f,   0.0000f, 50.0000f,   3.2592f,   0.3350f,  1.0000f},
+    {60.2574f, -34.0099f,  36.2677f, 60.4626f, -34.1751f,  39.4387f,  1.2644f},
+    {63.0109f, -31.0961f,  -5.8663f, 62.8187f, -29.7946f,  -4.0864f,  1.2630f},
+    {61.2901f,   3.7196f,  -5.3901f, 61.4292f,   2.2480f,  -4.9620f,  1.8731f},
+    {35.0831f, -44.1164f,   3.7933f, 35.0232f, -40.0716f,   1.5901f,  1.8645f},
+    {22.7233f,  20.0904f, -46.6940f, 23.0331f,  14.9730f, -42.5619f,  2.0373f},
+    {36.4612f,  47.8580f,  18.3852f, 36.2715f,  50.5065f,  21.2231f,  1.4146f},
+    {90.8027f,  -2.0831f,   1.4410f, 91.1528f,  -1.6435f,   0.0447f,  1.4441f},
+    {90.9257f,  -0.5406f,  -0.9208f, 88.6381f,  -0.8985f,  -0.7239f,  1.5381f},
+    { 6.7747f,  -0.2908f,  -2.4247f,  5.8714f,  -0.0985f,  -2.2286f,  0.6377f},
+    { 2.0776f,   0.0795f,  -1.1350f,  0.9033f,  -0.0636f,  -0.5514f,  0.9082f}
+};
+
+static CIELabColor lab(float l, float a, float b) {
+    CIELabColor color;
+    color.l = l;
+    color.a = a;
+    color.b = b;
+
+    return color;
+}
+
+static void test_delta_e2000() {
+    float worst = 0;
+
+    for(uint8_t i = 0; i < 34; i++) {
+        const float *pair = sharma_pairs[i];
+        CIELabColor first = lab(pair[0], pair[1], pair[2]);
+        CIELabColor second = lab(pair[3], pair[4], pair[5]);
+
+        float forward = TCS3200::delta_e2000(first, second);
+        float backward = TCS3200::delta_e2000(second, first);
+
+        worst = fmax(worst, fabs(forward - pair[6]));
+        worst = fmax(worst, fabs(backward - pair[6]));
+    }
+
+    // The table is rounded to 4 decimal places
+    printf("CIEDE2000 worst error against the reference pairs: %.2e\n", worst);
+    TEST_CHECK(worst <= 1e-4f);
+    TEST_CHECK_NEAR(TCS3200::delta_e2000(lab(50, 10, -10), lab(50, 10, -10)), 0, 0);
+}
+
+static void test_delta_e76_e94() {
+    TEST_CHECK_NEAR(TCS3200::delta_e76(lab(50, 0, 0), lab(53, 4, 0)), 5, 1e-6);
+
+    // Pure lightness differences are unweighted
+    TEST_CHECK_NEAR(TCS3200::delta_e94(lab(50, 0, 0), lab(52, 0, 0)), 2, 1e-6);
+
+    // Chroma differences are divided by 1 + 0.045 * C1
+    TEST_CHECK_NEAR(TCS3200::delta_e94(lab(50, 20, 0), lab(50, 30, 0)), 10 / 1.9, 1e-5);
+}
+
+static double lab_f(double t) {
+    return t > 0.008856 ? cbrt(t) : 7.787037 * t + 0.137931;
+}
+
+static void test_cielab() {
+    double worst = 0;
+    RGBColor color;
+
+    for(uint32_t value = 0; value < 0x1000000; value++) {
+        color.red = value;
+        color.green = value >> 8;
+        color.blue = value >> 16;
+
+        CIE1931Color xyz = TCS3200::rgb_to_cie1931(color);
+        CIELabColor fast = TCS3200::cie1931_to_cielab(xyz);
+
+        double fx = lab_f(xyz.x / 0.95047), fy = lab_f(xyz.y), fz = lab_f(xyz.z / 1.08883);
+        worst = fmax(worst, fabs(fast.l - (116.0 * fy - 16.0)));
+        worst = fmax(worst, fabs(fast.a - 500.0 * (fx - fy)));
+        worst = fmax(worst, fabs(fast.b - 200.0 * (fy - fz)));
+    }
+
+    printf("L*a*b* worst error over the RGB cube: %.2e\n", worst);
+    TEST_CHECK(worst <= 5e-4);
+}
+
+int main() {
+    test_delta_e2000();
+    test_delta_e76_e94();
+    test_cielab();
+
+    return test_result();
+}
@@ -0,0 +1,186 @@
+/*
+ * This file is part of the TCS3200 Color Sensor Arduino library.
+ * Copyright (c) 2023 Nathanne Isip
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "TCS3200Simulator.h"
+#include "test.h"
+
+#define S0_PIN  4
+#define S1_PIN  5
+#define S2_PIN  6
+#define S3_PIN  7
+#define OUT_PIN 8
+
+// Pins of the host Arduino core with and without an external interrupt
+#define INTERRUPT_PIN    2
+#define NO_INTERRUPT_PIN 9
+
+static void test_arduino_hal() {
+    TCS3200EdgeCounter counter;
+
+    TEST_CHECK(!counter.attach(NO_INTERRUPT_PIN));
+    TEST_CHECK(!counter.attached());
+    TEST_CHECK_EQUAL(counter.count(), 0);
+
+    TEST_CHECK(counter.attach(INTERRUPT_PIN));
+    TEST_CHECK(counter.attached());
+
+    for(uint8_t i = 0; i < 5; i++)
+        TEST_CHECK(host_interrupt(digitalPinToInterrupt(INTERRUPT_PIN)));
+    TEST_CHECK_EQUAL(counter.count(), 5);
+
+    counter.detach();
+    TEST_CHECK(!counter.attached());
+    TEST_CHECK(!host_interrupt(digitalPinToInterrupt(INTERRUPT_PIN)));
+    TEST_CHECK_EQUAL(counter.count(), 0);
+}
+
+static void test_slots() {
+    TCS3200SimulatedHAL simulator(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN);
+    TCS3200EdgeCounter counters[TCS3200_EDGE_COUNTER_SLOTS + 1];
+
+    for(uint8_t i = 1; i < TCS3200_EDGE_COUNTER_SLOTS + 1; i++)
+        simulator.add_output(OUT_PIN + i);
+
+    for(uint8_t i = 0; i < TCS3200_EDGE_COUNTER_SLOTS + 1; i++)
+        counters[i].hal(&simulator);
+
+    // Failed attaches do not hold on to a slot
+    for(uint8_t i = 0; i < TCS3200_EDGE_COUNTER_SLOTS + 1; i++)
+        TEST_CHECK(!counters[0].attach(OUT_PIN + 20));
+
+    for(uint8_t i = 0; i < TCS3200_EDGE_COUNTER_SLOTS; i++)
+        TEST_CHECK(counters[i].attach(OUT_PIN + i));
+    TEST_CHECK(!counters[TCS3200_EDGE_COUNTER_SLOTS].attach(OUT_PIN));
+
+    counters[0].detach();
+    TEST_CHECK(counters[TCS3200_EDGE_COUNTER_SLOTS].attach(OUT_PIN));
+
+    for(uint8_t i = 0; i < TCS3200_EDGE_COUNTER_SLOTS + 1; i++)
+        counters[i].detach();
+}
+
+static void test_counting() {
+    TCS3200SimulatedHAL simulator(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN);
+    TCS3200EdgeCounter counter;
+
+    simulator.spectrum(10000, 5000, 2500, 20000);
+    simulator.digital_write(S0_PIN, HIGH);
+    simulator.digital_write(S1_PIN, HIGH);
+
+    counter.hal(&simulator);
+    TEST_CHECK(counter.attach(OUT_PIN));
+
+    simulator.advance(5000);
+    TEST_CHECK_EQUAL(counter.count(), 50);
+
+    counter.detach();
+    simulator.advance(5000);
+    TEST_CHECK_EQUAL(counter.count(), 0);
+}
+
+static void test_measurement() {
+    TCS3200SimulatedHAL simulator(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN);
+    TCS3200 tcs3200(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN);
+
+    simulator.spectrum(10000, 5000, 2500, 20000);
+    tcs3200.hal(&simulator);
+    tcs3200.begin();
+    tcs3200.frequency_scaling(TCS3200_OFREQ_20P);
+    tcs3200.integration_time(10000);
+
+    uint8_t channels[4] = {
+        TCS3200_COLOR_RED, TCS3200_COLOR_GREEN,
+        TCS3200_COLOR_BLUE, TCS3200_COLOR_CLEAR
+    };
+    uint32_t expected[4] = {2000, 1000, 500, 4000};
+
+    for(uint8_t i = 0; i < 4; i++) {
+        TEST_CHECK(tcs3200.start_measurement(channels[i]));
+
+        // The measurement runs in the background between polls
+        uint32_t start = simulator.now(), polls = 0;
+        while(!tcs3200.poll_measurement())
+            polls++;
+
+        TEST_CHECK(polls > 100);
+        TEST_CHECK(simulator.now() - start >= 10000);
+        TEST_CHECK_NEAR(tcs3200.measurement_frequency(), expected[i], expected[i] / 100);
+    }
+}
+
+static void test_measurement_without_interrupt() {
+    TCS3200 tcs3200(S0_PIN, S1_PIN, S2_PIN, S3_PIN, NO_INTERRUPT_PIN);
+
+    tcs3200.begin();
+    TEST_CHECK(!tcs3200.start_measurement(TCS3200_COLOR_RED));
+    TEST_CHECK(tcs3200.poll_measurement());
+    TEST_CHECK_EQUAL(tcs3200.measurement_frequency(), 0);
+}
+
+static void test_measurement_during_sampling() {
+    TCS3200SimulatedHAL simulator(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN);
+    TCS3200 tcs3200(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN);
+
+    simulator.spectrum(10000, 5000, 2500, 20000);
+    tcs3200.hal(&simulator);
+    tcs3200.begin();
+    tcs3200.frequency_scaling(TCS3200_OFREQ_20P);
+    tcs3200.integration_time(10000);
+
+    // A frame scan in progress is not clobbered
+    tcs3200.sampling(true);
+    for(uint16_t i = 0; i < 1000; i++)
+        tcs3200.loop();
+    TEST_CHECK(!tcs3200.start_measurement(TCS3200_COLOR_CLEAR));
+
+    while(!tcs3200.available())
+        tcs3200.loop();
+
+    RawRGBC frame = tcs3200.read_frame();
+    TEST_CHECK_NEAR(frame.red, 250, 3);
+    TEST_CHECK_NEAR(frame.green, 500, 5);
+
+    // loop() waits for a running measurement to end before scanning
+    tcs3200.sampling(false);
+    TEST_CHECK(tcs3200.start_measurement(TCS3200_COLOR_CLEAR));
+    tcs3200.sampling(true);
+
+    while(!tcs3200.poll_measurement())
+        tcs3200.loop();
+    TEST_CHECK_NEAR(tcs3200.measurement_frequency(), 4000, 40);
+
+    while(!tcs3200.available())
+        tcs3200.loop();
+    TEST_CHECK_NEAR(tcs3200.read_frame().blue, 1000, 10);
+}
+
+int main() {
+    test_arduino_hal();
+    test_slots();
+    test_counting();
+    test_measurement();
+    test_measurement_without_interrupt();
+    test_measurement_during_sampling();
+
+    return test_result();
+}
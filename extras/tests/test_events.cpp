@@ -0,0 +1,198 @@
+/*
+ * This file is part of the TCS3200 Color Sensor Arduino library.
+ * Copyright (c) 2023 Nathanne Isip
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "TCS3200Simulator.h"
+#include "test.h"
+
+#define S0_PIN  4
+#define S1_PIN  5
+#define S2_PIN  6
+#define S3_PIN  7
+#define OUT_PIN 8
+
+// Normalized readings of about 255, 195 and 0 after calibration
+#define LIGHT   30000
+#define NEAR    3834
+#define DARK    1000
+
+#define IDLE_INTERVAL   250000
+
+static TCS3200SimulatedHAL simulator(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN);
+static TCS3200 tcs3200(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN);
+
+static uint32_t above, below;
+
+static void on_above() {
+    above++;
+}
+
+static void on_below() {
+    below++;
+}
+
+static void setup() {
+    tcs3200.hal(&simulator);
+    tcs3200.begin();
+    tcs3200.frequency_scaling(TCS3200_OFREQ_20P);
+
+    // Gate enough periods of the NEAR light for exact frame readings
+    tcs3200.integration_time(20000);
+
+    simulator.spectrum(LIGHT, LIGHT, LIGHT, 80000);
+    tcs3200.calibrate_light();
+    simulator.spectrum(DARK, DARK, DARK, 2500);
+    tcs3200.calibrate_dark();
+    tcs3200.calibrate();
+}
+
+static void light(uint32_t frequency) {
+    simulator.spectrum(frequency, frequency, frequency, frequency * 8 / 3);
+}
+
+// Runs loop() until a frame is published and returns its end time
+static uint32_t frame() {
+    while(!tcs3200.available())
+        tcs3200.loop();
+    tcs3200.read_frame();
+
+    return simulator.now();
+}
+
+static void frames(uint8_t count) {
+    for(uint8_t i = 0; i < count; i++)
+        frame();
+}
+
+static void test_level_triggered() {
+    RGBColor upper = {200, 200, 200}, lower = {50, 50, 50};
+
+    above = below = 0;
+    tcs3200.upper_bound_interrupt(upper, on_above);
+    tcs3200.lower_bound_interrupt(lower, on_below);
+    tcs3200.edge_triggered_interrupts(false);
+
+    // Callbacks run on every frame past the threshold
+    light(LIGHT);
+    frames(3);
+    TEST_CHECK_EQUAL(above, 3);
+    TEST_CHECK_EQUAL(below, 0);
+
+    light(DARK);
+    frames(2);
+    TEST_CHECK_EQUAL(above, 3);
+    TEST_CHECK_EQUAL(below, 2);
+
+    tcs3200.clear_upper_bound_interrupt();
+    tcs3200.clear_lower_bound_interrupt();
+}
+
+static void test_edge_triggered() {
+    RGBColor upper = {200, 200, 200}, lower = {50, 50, 50};
+
+    above = below = 0;
+    tcs3200.upper_bound_interrupt(upper, on_above);
+    tcs3200.lower_bound_interrupt(lower, on_below);
+    tcs3200.edge_triggered_interrupts(true, 10);
+
+    // Once per crossing, not again while the reading stays past it
+    light(LIGHT);
+    frame();
+    TEST_CHECK_EQUAL(above, 1);
+    frames(4);
+    TEST_CHECK_EQUAL(above, 1);
+
+    // Dropping back within the hysteresis does not re-arm it
+    light(NEAR);
+    frames(2);
+    light(LIGHT);
+    frames(2);
+    TEST_CHECK_EQUAL(above, 1);
+
+    // Crossing the other way fires the lower bound once, and going
+    // back up fires the re-armed upper bound again
+    light(DARK);
+    frames(3);
+    TEST_CHECK_EQUAL(below, 1);
+    light(LIGHT);
+    frames(3);
+    TEST_CHECK_EQUAL(above, 2);
+    TEST_CHECK_EQUAL(below, 1);
+
+    // With debouncing the condition must hold for several frames
+    tcs3200.edge_triggered_interrupts(true, 10, 3);
+    above = 0;
+    light(DARK);
+    frames(1);
+    light(LIGHT);
+    frames(2);
+    TEST_CHECK_EQUAL(above, 0);
+    frame();
+    TEST_CHECK_EQUAL(above, 1);
+    frames(3);
+    TEST_CHECK_EQUAL(above, 1);
+
+    tcs3200.edge_triggered_interrupts(false);
+    tcs3200.clear_upper_bound_interrupt();
+    tcs3200.clear_lower_bound_interrupt();
+}
+
+static void test_adaptive_sampling() {
+    tcs3200.sampling(true);
+    tcs3200.adaptive_sampling(IDLE_INTERVAL, 2, 3);
+
+    light(LIGHT);
+    uint32_t start = frame();
+    uint32_t full_rate = frame() - start;
+    TEST_CHECK(full_rate < IDLE_INTERVAL);
+
+    // Stable frames stretch the interval to the idle one
+    frames(3);
+    TEST_CHECK(tcs3200.idle());
+    start = frame();
+    TEST_CHECK(frame() - start >= IDLE_INTERVAL);
+
+    // The first changed frame shrinks it back to the full rate
+    light(DARK);
+    frame();
+    TEST_CHECK(!tcs3200.idle());
+    start = frame();
+    TEST_CHECK(frame() - start < IDLE_INTERVAL);
+
+    // Turning it off never idles
+    tcs3200.adaptive_sampling(0);
+    frames(6);
+    TEST_CHECK(!tcs3200.idle());
+    start = frame();
+    TEST_CHECK(frame() - start < IDLE_INTERVAL);
+
+    tcs3200.sampling(false);
+}
+
+int main() {
+    setup();
+
+    test_level_triggered();
+    test_edge_triggered();
+    test_adaptive_sampling();
+
+    return test_result();
+}
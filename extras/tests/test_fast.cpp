@@ -0,0 +1,92 @@
+/*
+ * This file is part of the TCS3200 Color Sensor Arduino library.
+ * Copyright (c) 2023 Nathanne Isip
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "TCS3200Fast.h"
+#include "TCS3200Simulator.h"
+#include "test.h"
+
+#define S0_PIN  4
+#define S1_PIN  5
+#define S2_PIN  6
+#define S3_PIN  7
+#define OUT_PIN 8
+
+// Simulator counting the S2/S3 writes that go through the HAL
+class CountingHAL : public TCS3200SimulatedHAL {
+public:
+    uint32_t filter_writes;
+
+    CountingHAL():
+        TCS3200SimulatedHAL(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN),
+        filter_writes(0) { }
+
+    void digital_write(uint8_t pin, uint8_t value) {
+        TCS3200SimulatedHAL::digital_write(pin, value);
+
+        if(pin == S2_PIN || pin == S3_PIN)
+            this->filter_writes++;
+    }
+};
+
+static void test_drop_in() {
+    TCS3200SimulatedHAL simulator(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN);
+    TCS3200T<S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN> tcs3200;
+
+    simulator.spectrum(10000, 5000, 2500, 20000);
+    tcs3200.hal(&simulator);
+    tcs3200.begin();
+    tcs3200.frequency_scaling(TCS3200_OFREQ_20P);
+
+    RawRGBC raw = tcs3200.read_raw_rgbc();
+    TEST_CHECK_EQUAL(raw.red, 250);
+    TEST_CHECK_EQUAL(raw.green, 500);
+    TEST_CHECK_EQUAL(raw.blue, 1000);
+    TEST_CHECK_EQUAL(raw.clear, 125);
+}
+
+static void test_filter_writes() {
+    CountingHAL simulator;
+    TCS3200T<S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN> tcs3200;
+
+    tcs3200.hal(&simulator);
+    tcs3200.begin();
+
+    // Only the pins that change are written
+    tcs3200.read_red();
+    simulator.filter_writes = 0;
+    tcs3200.read_green();
+    TEST_CHECK_EQUAL(simulator.filter_writes, 2);
+    tcs3200.read_blue();
+    TEST_CHECK_EQUAL(simulator.filter_writes, 3);
+    tcs3200.read_blue();
+    TEST_CHECK_EQUAL(simulator.filter_writes, 3);
+    tcs3200.read_clear();
+    TEST_CHECK_EQUAL(simulator.filter_writes, 5);
+}
+
+int main() {
+    test_drop_in();
+    test_filter_writes();
+
+    return test_result();
+}
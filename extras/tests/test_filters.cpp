@@ -0,0 +1,181 @@
+/*
+ * This file is part of the TCS3200 Color Sensor Arduino library.
+ * Copyright (c) 2023 Nathanne Isip
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "TCS3200Filters.h"
+#include "TCS3200Simulator.h"
+#include "test.h"
+
+// Counts the readings fed to the pipeline
+class CountingFilter : public TCS3200Filter {
+public:
+    uint32_t updates;
+
+    CountingFilter(): updates(0) { }
+
+    uint32_t update(uint8_t channel, uint32_t value) {
+        (void) channel;
+        this->updates++;
+
+        return value;
+    }
+
+    void reset() {
+        this->updates = 0;
+    }
+};
+
+static void bound_callback() { }
+
+// Feeds a step from `from` to `to` and returns the settled output
+static uint32_t settle(TCS3200Filter &filter, uint32_t from, uint32_t to, uint16_t updates) {
+    filter.reset();
+    filter.update(0, from);
+
+    uint32_t output = 0;
+    for(uint16_t i = 0; i < updates; i++)
+        output = filter.update(0, to);
+
+    return output;
+}
+
+static void test_ema() {
+    const uint8_t alphas[] = {1, 16, 64, 128, 255};
+    const uint32_t steps[][2] = {
+        {40, 45}, {45, 40}, {1000, 1003}, {1003, 1000},
+        {0, 1}, {1, 0}, {0, 0x7fffff}, {0x7fffff, 0}
+    };
+
+    for(uint8_t i = 0; i < sizeof(alphas) / sizeof(alphas[0]); i++)
+        for(uint8_t j = 0; j < sizeof(steps) / sizeof(steps[0]); j++) {
+            TCS3200EMAFilter filter(alphas[i]);
+            TEST_CHECK_EQUAL(settle(filter, steps[j][0], steps[j][1], 6000), steps[j][1]);
+        }
+
+    // The first reading is taken as is, and larger ones are clamped
+    TCS3200EMAFilter filter(64);
+    TEST_CHECK_EQUAL(filter.update(0, 1234), 1234);
+    TEST_CHECK_EQUAL(filter.update(1, 0xffffffff), 0x7fffff);
+
+    // A quarter of the remaining step per update
+    filter.reset();
+    filter.update(0, 0);
+    TEST_CHECK_EQUAL(filter.update(0, 1024), 256);
+    TEST_CHECK_EQUAL(filter.update(0, 1024), 448);
+
+    // Channels are smoothed independently
+    TEST_CHECK_EQUAL(filter.update(2, 99), 99);
+    TEST_CHECK_EQUAL(filter.update(0, 1024), 592);
+
+    // Matches the exact 64-bit update over the whole input range
+    uint32_t seed = 0x2545f491;
+    for(uint8_t i = 0; i < sizeof(alphas) / sizeof(alphas[0]); i++) {
+        TCS3200EMAFilter split(alphas[i]);
+        int64_t state = -1;
+
+        for(uint16_t j = 0; j < 2000; j++) {
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+
+            uint32_t value = (j & 1) ? (seed & 0x7fffff) : (seed & 0xff);
+            int64_t target = (int64_t) value << 8;
+            state = state < 0 ? target : state + (((target - state) * alphas[i] + 127) >> 8);
+
+            TEST_CHECK_EQUAL(split.update(0, value), (uint32_t) ((state + 128) >> 8));
+        }
+    }
+}
+
+static void test_moving_average() {
+    TCS3200MovingAverage<4> filter;
+
+    TEST_CHECK_EQUAL(filter.update(0, 10), 10);
+    TEST_CHECK_EQUAL(filter.update(0, 20), 15);
+    TEST_CHECK_EQUAL(filter.update(0, 30), 20);
+    TEST_CHECK_EQUAL(filter.update(0, 40), 25);
+    TEST_CHECK_EQUAL(filter.update(0, 50), 35);
+    TEST_CHECK_EQUAL(settle(filter, 40, 45, 4), 45);
+}
+
+static void test_median() {
+    TCS3200MedianFilter<5> filter;
+
+    const uint32_t readings[] = {10, 900, 12, 11, 0, 13, 14};
+    const uint32_t medians[] = {10, 900, 12, 12, 11, 12, 12};
+
+    // Single spikes never reach the output once the window is full
+    for(uint8_t i = 0; i < 7; i++)
+        TEST_CHECK_EQUAL(filter.update(0, readings[i]), medians[i]);
+}
+
+static void test_kalman() {
+    TCS3200KalmanFilter filter(0.01f, 4.0f);
+    TEST_CHECK_EQUAL(settle(filter, 40, 45, 2000), 45);
+    TEST_CHECK_EQUAL(settle(filter, 1003, 1000, 2000), 1000);
+
+    // Without any noise it averages the readings instead of returning NaN
+    TCS3200KalmanFilter noiseless(0.0f, 0.0f);
+    TEST_CHECK_EQUAL(noiseless.update(0, 40), 40);
+    TEST_CHECK_EQUAL(noiseless.update(0, 44), 42);
+    TEST_CHECK_EQUAL(noiseless.update(0, 45), 43);
+}
+
+static void test_single_stream() {
+    TCS3200SimulatedHAL simulator(4, 5, 6, 7, 8);
+    TCS3200 tcs3200(4, 5, 6, 7, 8);
+    CountingFilter filter;
+
+    simulator.spectrum(10000, 5000, 2500, 20000);
+    tcs3200.hal(&simulator);
+    tcs3200.begin();
+    tcs3200.frequency_scaling(TCS3200_OFREQ_20P);
+    tcs3200.attach_filter(&filter);
+
+    // Blocking reads are filtered while loop() is not sampling
+    tcs3200.read_rgb_color();
+    TEST_CHECK_EQUAL(filter.updates, 3);
+
+    // Each sampled frame is filtered once, and blocking reads stay out
+    filter.reset();
+    tcs3200.upper_bound_interrupt({255, 255, 255}, bound_callback);
+
+    for(uint8_t frame = 0; frame < 4; frame++) {
+        while(!tcs3200.available())
+            tcs3200.loop();
+        tcs3200.read_frame();
+    }
+
+    TEST_CHECK_EQUAL(filter.updates, 4 * 3);
+    tcs3200.read_rgb_color();
+    TEST_CHECK_EQUAL(filter.updates, 4 * 3);
+}
+
+int main() {
+    test_ema();
+    test_moving_average();
+    test_median();
+    test_kalman();
+    test_single_stream();
+
+    return test_result();
+}
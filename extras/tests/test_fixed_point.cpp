@@ -0,0 +1,123 @@
+/*
+ * This file is part of the TCS3200 Color Sensor Arduino library.
+ * Copyright (c) 2023 Nathanne Isip
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "TCS3200.h"
+#include "test.h"
+
+// Largest errors against exact math, in units of 1/65536 (degrees for hue)
+#define HUE_TOLERANCE   (0.002 * 65536)
+#define Q16_TOLERANCE   2.0
+
+static double hue_error(double actual, double expected) {
+    double error = fabs(actual - expected);
+    return error > 180.0 * 65536 ? 360.0 * 65536 - error : error;
+}
+
+static void reference_hsv(RGBColor color, double *hue, double *saturation, double *value) {
+    double r = color.red / 255.0, g = color.green / 255.0, b = color.blue / 255.0;
+    double max_val = fmax(r, fmax(g, b)), min_val = fmin(r, fmin(g, b));
+    double delta = max_val - min_val;
+
+    *value = max_val;
+    *saturation = max_val > 0 ? delta / max_val : 0;
+    *hue = 0;
+
+    if(delta > 0) {
+        if(max_val == r)
+            *hue = (g - b) / delta;
+        else if(max_val == g)
+            *hue = 2 + (b - r) / delta;
+        else *hue = 4 + (r - g) / delta;
+
+        *hue *= 60;
+        if(*hue < 0)
+            *hue += 360;
+    }
+}
+
+static void reference_cmyk(RGBColor color, double cmyk[4]) {
+    double c = 1 - color.red / 255.0, m = 1 - color.green / 255.0, y = 1 - color.blue / 255.0;
+    double k = fmin(c, fmin(m, y));
+
+    cmyk[0] = k < 1 ? (c - k) / (1 - k) : 0;
+    cmyk[1] = k < 1 ? (m - k) / (1 - k) : 0;
+    cmyk[2] = k < 1 ? (y - k) / (1 - k) : 0;
+    cmyk[3] = k;
+}
+
+static void reference_xyz(RGBColor color, double xyz[3]) {
+    double r = color.red / 255.0, g = color.green / 255.0, b = color.blue / 255.0;
+
+    xyz[0] = 0.4124564 * r + 0.3575761 * g + 0.1804375 * b;
+    xyz[1] = 0.2126729 * r + 0.7151522 * g + 0.0721750 * b;
+    xyz[2] = 0.0193339 * r + 0.1191920 * g + 0.9503041 * b;
+}
+
+int main() {
+    double hue = 0, saturation = 0, value = 0, cmyk = 0, xyz = 0;
+
+    // Every 24-bit color
+    for(uint32_t i = 0; i < 0x1000000; i++) {
+        RGBColor color;
+        color.red = i >> 16;
+        color.green = i >> 8;
+        color.blue = i;
+
+        double h, s, v, c[4], x[3];
+        reference_hsv(color, &h, &s, &v);
+        reference_cmyk(color, c);
+        reference_xyz(color, x);
+
+        HSVColorQ16 hsv_q16 = TCS3200::rgb_to_hsv_q16(color);
+        hue = fmax(hue, hue_error(hsv_q16.hue, h * 65536));
+        saturation = fmax(saturation, fabs(hsv_q16.saturation - s * 65536));
+        value = fmax(value, fabs(hsv_q16.value - v * 65536));
+
+        CMYKColorQ16 cmyk_q16 = TCS3200::rgb_to_cmyk_q16(color);
+        cmyk = fmax(cmyk, fabs(cmyk_q16.cyan - c[0] * 65536));
+        cmyk = fmax(cmyk, fabs(cmyk_q16.magenta - c[1] * 65536));
+        cmyk = fmax(cmyk, fabs(cmyk_q16.yellow - c[2] * 65536));
+        cmyk = fmax(cmyk, fabs(cmyk_q16.black - c[3] * 65536));
+
+        CIE1931ColorQ16 xyz_q16 = TCS3200::rgb_to_cie1931_q16(color);
+        xyz = fmax(xyz, fabs(xyz_q16.x - x[0] * 65536));
+        xyz = fmax(xyz, fabs(xyz_q16.y - x[1] * 65536));
+        xyz = fmax(xyz, fabs(xyz_q16.z - x[2] * 65536));
+    }
+
+    printf("Q16.16 kernels against exact math, all 2^24 colors\n");
+    printf("  component    max abs error\n");
+    printf("  hue          %.5f deg\n", hue / 65536);
+    printf("  saturation   %.2f/65536\n", saturation);
+    printf("  value        %.2f/65536\n", value);
+    printf("  CMYK         %.2f/65536\n", cmyk);
+    printf("  XYZ          %.2f/65536\n", xyz);
+
+    TEST_CHECK(hue <= HUE_TOLERANCE);
+    TEST_CHECK(saturation <= Q16_TOLERANCE);
+    TEST_CHECK(value <= Q16_TOLERANCE);
+    TEST_CHECK(cmyk <= Q16_TOLERANCE);
+    TEST_CHECK(xyz <= Q16_TOLERANCE);
+
+    return test_result();
+}
@@ -0,0 +1,200 @@
+/*
+ * This file is part of the TCS3200 Color Sensor Arduino library.
+ * Copyright (c) 2023 Nathanne Isip
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "TCS3200Simulator.h"
+#include "test.h"
+
+#include <string.h>
+
+#define S0_PIN  4
+#define S1_PIN  5
+#define S2_PIN  6
+#define S3_PIN  7
+#define OUT_PIN 8
+
+// Every pulse measurement returns the same width
+class PulseHAL : public TCS3200SimulatedHAL {
+public:
+    uint32_t pulse;
+
+    PulseHAL():
+        TCS3200SimulatedHAL(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN),
+        pulse(0) { }
+
+    uint32_t pulse_in(uint8_t pin, uint8_t state, uint32_t timeout) {
+        (void) pin;
+        (void) state;
+        (void) timeout;
+
+        return this->pulse;
+    }
+};
+
+class MemoryStorage : public TCS3200Storage {
+public:
+    uint8_t bytes[TCS3200_CALIBRATION_SIZE];
+
+    bool read(uint16_t address, uint8_t *data, uint16_t length) {
+        memcpy(data, this->bytes + address, length);
+        return true;
+    }
+
+    bool write(uint16_t address, const uint8_t *data, uint16_t length) {
+        memcpy(this->bytes + address, data, length);
+        return true;
+    }
+};
+
+static PulseHAL hal;
+static MemoryStorage storage;
+static TCS3200 tcs3200(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN);
+
+static uint8_t *put_u32(uint8_t *cursor, uint32_t value) {
+    for(uint8_t i = 0; i < 4; i++)
+        *cursor++ = value >> (i * 8);
+
+    return cursor;
+}
+
+// CRC-16/CCITT-FALSE of the stored profiles
+static uint16_t crc16(const uint8_t *data, uint16_t length) {
+    uint16_t crc = 0xffff;
+
+    while(length--) {
+        crc ^= (uint16_t) *data++ << 8;
+
+        for(uint8_t i = 0; i < 8; i++)
+            crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+
+    return crc;
+}
+
+// Loads a profile with the same white and dark pulses on every channel
+static void calibrate(uint32_t white, uint32_t dark) {
+    uint8_t *cursor = storage.bytes;
+
+    *cursor++ = 'T';
+    *cursor++ = 'C';
+    *cursor++ = TCS3200_CALIBRATION_VERSION;
+    *cursor++ = 0x01;
+    *cursor++ = TCS3200_OFREQ_20P;
+
+    for(uint8_t i = 0; i < 4; i++)
+        cursor = put_u32(cursor, white);
+    for(uint8_t i = 0; i < 4; i++)
+        cursor = put_u32(cursor, dark);
+
+    *cursor++ = 255;
+    *cursor++ = 255;
+    *cursor++ = 255;
+
+    uint16_t crc = crc16(storage.bytes, TCS3200_CALIBRATION_SIZE - 2);
+    *cursor++ = crc & 0xff;
+    *cursor++ = crc >> 8;
+
+    TEST_CHECK(tcs3200.load_calibration(storage));
+}
+
+static uint8_t read(uint32_t pulse) {
+    hal.pulse = pulse;
+    return tcs3200.read_red();
+}
+
+// Every pulse of every range up to 1024 us, and a few wide ranges
+static void test_matches_map() {
+    const uint32_t whites[] = {2, 83};
+    uint32_t mismatches = 0;
+
+    for(uint8_t i = 0; i < 2; i++)
+        for(uint32_t range = 1; range <= 1024; range++) {
+            uint32_t white = whites[i], dark = white + range;
+            calibrate(white, dark);
+
+            for(uint32_t pulse = white - 1; pulse <= dark + 1; pulse++) {
+                long expected = map(min(max(pulse, white), dark), white, dark, 255, 0);
+                mismatches += read(pulse) != expected;
+            }
+        }
+
+    const uint32_t ranges[] = {65535, 65536, 65537, 100000, 1000000, 10000000};
+    for(uint8_t i = 0; i < sizeof(ranges) / sizeof(ranges[0]); i++) {
+        calibrate(100, 100 + ranges[i]);
+
+        for(uint32_t step = 0; step < 4096; step++) {
+            uint32_t pulse = 100 + (uint32_t) ((uint64_t) ranges[i] * step / 4096);
+            mismatches += read(pulse) != map(pulse, 100, 100 + ranges[i], 255, 0);
+            mismatches += read(pulse + 1) != map(pulse + 1, 100, 100 + ranges[i], 255, 0);
+        }
+    }
+
+    TEST_CHECK_EQUAL(mismatches, 0);
+}
+
+static void test_linearization() {
+    // Pulses 100-355 us map to every normalized value once
+    calibrate(100, 355);
+    TEST_CHECK_EQUAL(read(100), 255);
+    TEST_CHECK_EQUAL(read(228), 127);
+
+    // An identity curve changes nothing
+    uint8_t curve[TCS3200_CURVE_POINTS];
+    for(uint8_t i = 0; i < TCS3200_CURVE_POINTS; i++)
+        curve[i] = i == TCS3200_CURVE_POINTS - 1 ? 255 : i * 16;
+
+    tcs3200.linearization(curve);
+    for(uint32_t pulse = 100; pulse <= 355; pulse++)
+        TEST_CHECK_EQUAL(read(pulse), 355 - pulse);
+
+    // An inverted curve, interpolated between its points
+    for(uint8_t i = 0; i < TCS3200_CURVE_POINTS; i++)
+        curve[i] = 255 - curve[i];
+
+    tcs3200.linearization(curve);
+    TEST_CHECK_EQUAL(read(355), 255);
+    TEST_CHECK_EQUAL(read(100), 0);
+    TEST_CHECK_EQUAL(read(355 - 40), 215);
+    TEST_CHECK_EQUAL(read(355 - 247), 8);
+
+    // Gamma 2: 128 lies on a point, (128 / 255)^2 * 255 = 64.25
+    tcs3200.linearization(2.0f);
+    TEST_CHECK_EQUAL(read(355 - 128), 64);
+    TEST_CHECK_EQUAL(read(355), 0);
+    TEST_CHECK_EQUAL(read(100), 255);
+
+    // Halfway between the points of 64 (16) and 80 (25)
+    TEST_CHECK_EQUAL(read(355 - 72), 20);
+
+    tcs3200.clear_linearization();
+    TEST_CHECK_EQUAL(read(355 - 72), 72);
+}
+
+int main() {
+    tcs3200.hal(&hal);
+    tcs3200.begin();
+    tcs3200.frequency_scaling(TCS3200_OFREQ_20P);
+
+    test_matches_map();
+    test_linearization();
+
+    return test_result();
+}
@@ -0,0 +1,147 @@
+/*
+ * This file is part of the TCS3200 Color Sensor Arduino library.
+ * Copyright (c) 2023 Nathanne Isip
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "TCS3200Palette.h"
+#include "test.h"
+
+#define MAX_PALETTE 1000
+#define QUERIES     2000
+
+static RGBColor colors[MAX_PALETTE];
+static TCS3200PaletteNode nodes[MAX_PALETTE];
+
+static uint32_t state = 0x2545f491;
+
+static RGBColor random_color() {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+
+    RGBColor color;
+    color.red = state;
+    color.green = state >> 8;
+    color.blue = state >> 16;
+
+    return color;
+}
+
+// Same coordinates as the index, so brute force is exact
+static void to_point(RGBColor color, uint8_t metric, int32_t *point) {
+    if(metric == TCS3200_METRIC_LAB) {
+        CIELabColor lab = TCS3200::cie1931_to_cielab(TCS3200::rgb_to_cie1931(color));
+
+        point[0] = (int16_t) (lab.l * 64.0f);
+        point[1] = (int16_t) (lab.a * 64.0f);
+        point[2] = (int16_t) (lab.b * 64.0f);
+    }
+    else {
+        point[0] = color.red;
+        point[1] = color.green;
+        point[2] = color.blue;
+    }
+}
+
+static uint32_t distance(RGBColor first, RGBColor second, uint8_t metric) {
+    int32_t a[3], b[3];
+    to_point(first, metric, a);
+    to_point(second, metric, b);
+
+    uint32_t sum = 0;
+    for(uint8_t i = 0; i < 3; i++)
+        sum += (a[i] - b[i]) * (a[i] - b[i]);
+
+    return sum;
+}
+
+static void test_brute_force(uint16_t size, uint8_t metric) {
+    for(uint16_t i = 0; i < size; i++)
+        colors[i] = random_color();
+
+    TCS3200Palette palette(nodes, size, metric);
+    palette.build(colors);
+
+    float scale = metric == TCS3200_METRIC_LAB ? 1.0f / 64.0f : 1.0f;
+    uint32_t mismatches = 0;
+
+    for(uint16_t query = 0; query < QUERIES; query++) {
+        RGBColor color = random_color();
+        uint32_t best = 0xffffffff, second = 0xffffffff;
+
+        for(uint16_t i = 0; i < size; i++) {
+            uint32_t d = distance(color, colors[i], metric);
+
+            if(d < best)
+                second = best, best = d;
+            else if(d < second)
+                second = d;
+        }
+
+        PaletteMatch match = palette.classify(color);
+        float confidence = second == 0xffffffff || second == 0 ? 1.0f :
+            1.0f - sqrt((float) best / second);
+
+        // Ties may resolve to any of the nearest colors
+        if(match.index >= size ||
+            distance(color, colors[match.index], metric) != best ||
+            match.distance != sqrt((float) best) * scale ||
+            match.confidence != confidence)
+            mismatches++;
+    }
+
+    if(mismatches > 0)
+        printf("palette of %u, metric %u: %u mismatches\n", size, metric, mismatches);
+    TEST_CHECK_EQUAL(mismatches, 0);
+}
+
+static void test_exact_match() {
+    RGBColor palette_colors[3] = {{255, 0, 0}, {0, 255, 0}, {0, 0, 255}};
+    TCS3200Palette palette(nodes, 3, TCS3200_METRIC_RGB);
+    palette.build(palette_colors);
+
+    PaletteMatch match = palette.classify(palette_colors[1]);
+    TEST_CHECK_EQUAL(match.index, 1);
+    TEST_CHECK_NEAR(match.distance, 0, 0);
+    TEST_CHECK_NEAR(match.confidence, 1, 0);
+
+    // Halfway between two colors nothing is certain
+    RGBColor middle = {128, 127, 0};
+    match = palette.classify(middle);
+    TEST_CHECK(match.index == 0 || match.index == 1);
+    TEST_CHECK(match.confidence < 0.01f);
+
+    const char *labels[3] = {"red", "green", "blue"};
+    RGBColor bluish = {20, 30, 200};
+    TEST_CHECK(strcmp(palette.nearest(labels, bluish), "blue") == 0);
+}
+
+int main() {
+    const uint16_t sizes[] = {1, 2, 3, 17, 100, 500, MAX_PALETTE};
+
+    for(uint8_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        test_brute_force(sizes[i], TCS3200_METRIC_RGB);
+        test_brute_force(sizes[i], TCS3200_METRIC_LAB);
+    }
+
+    test_exact_match();
+    return test_result();
+}
@@ -0,0 +1,164 @@
+/*
+ * This file is part of the TCS3200 Color Sensor Arduino library.
+ * Copyright (c) 2023 Nathanne Isip
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "TCS3200RingBuffer.h"
+#include "test.h"
+
+#include <thread>
+
+#define STRESS_FRAMES 2000000
+
+static RawRGBC frame_of(uint32_t sequence) {
+    RawRGBC frame;
+    frame.red = sequence;
+    frame.green = ~sequence;
+    frame.blue = sequence * 3;
+    frame.clear = sequence ^ 0x5a5a5a5a;
+    frame.timestamp = sequence;
+    frame.scaling = 0;
+    frame.valid = 0x0f;
+
+    return frame;
+}
+
+static bool consistent(const RawRGBC &frame) {
+    uint32_t sequence = frame.red;
+
+    return frame.green == ~sequence &&
+        frame.blue == sequence * 3 &&
+        frame.clear == (sequence ^ 0x5a5a5a5a) &&
+        frame.timestamp == sequence;
+}
+
+static void test_capacity() {
+    RawRGBC storage[16];
+
+    const uint16_t requested[] = {0, 1, 2, 3, 10, 15, 16};
+    const uint16_t rounded[] = {0, 1, 2, 2, 8, 8, 16};
+
+    for(uint8_t i = 0; i < sizeof(requested) / sizeof(requested[0]); i++) {
+        TCS3200RingBuffer buffer(storage, requested[i]);
+        TEST_CHECK_EQUAL(buffer.capacity(), rounded[i]);
+    }
+
+    // An empty buffer drops every frame
+    TCS3200RingBuffer empty(storage, 0);
+    empty.push(frame_of(1));
+    TEST_CHECK_EQUAL(empty.pushed(), 0);
+
+    // Frames beyond the rounded capacity are never touched
+    storage[8] = frame_of(1234);
+    TCS3200RingBuffer buffer(storage, 10);
+    for(uint32_t i = 0; i < 100; i++)
+        buffer.push(frame_of(i));
+    TEST_CHECK_EQUAL(storage[8].red, 1234);
+}
+
+static void test_consumers() {
+    RawRGBC storage[8];
+    TCS3200RingBuffer buffer(storage, 8);
+    TCS3200RingCursor fast, slow;
+
+    buffer.push(frame_of(100));
+    buffer.attach(fast);
+    buffer.attach(slow);
+    TEST_CHECK_EQUAL(buffer.available(fast), 0);
+
+    RawRGBC frame;
+    for(uint32_t i = 0; i < 5; i++)
+        buffer.push(frame_of(i));
+
+    for(uint32_t i = 0; i < 5; i++) {
+        TEST_CHECK(buffer.read(fast, &frame));
+        TEST_CHECK_EQUAL(frame.red, i);
+    }
+    TEST_CHECK(!buffer.read(fast, &frame));
+
+    // Falling a buffer behind loses the oldest frames
+    for(uint32_t i = 5; i < 20; i++)
+        buffer.push(frame_of(i));
+    TEST_CHECK_EQUAL(buffer.available(slow), 7);
+    TEST_CHECK_EQUAL(slow.overruns, 13);
+
+    RawRGBC frames[10];
+    TEST_CHECK_EQUAL(buffer.read(slow, frames, 10), 7);
+    TEST_CHECK_EQUAL(frames[0].red, 13);
+    TEST_CHECK_EQUAL(frames[6].red, 19);
+
+    TEST_CHECK_EQUAL(buffer.read(fast, frames, 4), 4);
+    TEST_CHECK_EQUAL(frames[0].red, 13);
+    TEST_CHECK_EQUAL(fast.overruns, 8);
+}
+
+static void test_concurrent() {
+    static RawRGBC storage[16];
+    TCS3200RingBuffer buffer(storage, 16);
+
+    TCS3200RingCursor cursors[2];
+    uint32_t torn[2] = {0, 0}, reordered[2] = {0, 0}, received[2] = {0, 0};
+    buffer.attach(cursors[0]);
+    buffer.attach(cursors[1]);
+
+    std::thread consumers[2];
+    for(uint8_t i = 0; i < 2; i++)
+        consumers[i] = std::thread([&, i] {
+            RawRGBC frames[4];
+            uint32_t next = 0;
+
+            while(next < STRESS_FRAMES) {
+                uint16_t count = i == 0 ?
+                    buffer.read(cursors[i], frames, 4) :
+                    buffer.read(cursors[i], frames) ? 1 : 0;
+
+                for(uint16_t j = 0; j < count; j++) {
+                    if(!consistent(frames[j]))
+                        torn[i]++;
+                    if(frames[j].red < next)
+                        reordered[i]++;
+
+                    next = frames[j].red + 1;
+                    received[i]++;
+                }
+            }
+        });
+
+    for(uint32_t i = 0; i < STRESS_FRAMES; i++)
+        buffer.push(frame_of(i));
+
+    for(uint8_t i = 0; i < 2; i++) {
+        consumers[i].join();
+
+        // Every frame is either read whole or counted as lost
+        TEST_CHECK_EQUAL(torn[i], 0);
+        TEST_CHECK_EQUAL(reordered[i], 0);
+        TEST_CHECK_EQUAL(received[i] + cursors[i].overruns, STRESS_FRAMES);
+    }
+}
+
+int main() {
+    test_capacity();
+    test_consumers();
+    test_concurrent();
+
+    return test_result();
+}
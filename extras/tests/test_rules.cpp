@@ -0,0 +1,222 @@
+/*
+ * This file is part of the TCS3200 Color Sensor Arduino library.
+ * Copyright (c) 2023 Nathanne Isip
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "TCS3200Palette.h"
+#include "TCS3200Rules.h"
+#include "TCS3200Simulator.h"
+#include "test.h"
+
+#define S0_PIN  4
+#define S1_PIN  5
+#define S2_PIN  6
+#define S3_PIN  7
+#define OUT_PIN 8
+
+// The uncorrected half reads blue and the balanced half red, so a rule
+// matching on the wrong half is caught
+static const RGBColor blue = {40, 40, 200};
+static const RGBColor red = {200, 40, 40};
+static const RGBColor green = {40, 200, 40};
+
+static void on_match(ColorSample &sample, void *context) {
+    (void) sample;
+    (*(uint32_t*) context)++;
+}
+
+static void test_rgb_box() {
+    TCS3200Rule table[2];
+    TCS3200Rules rules(table, 2);
+    uint32_t reds = 0, blues = 0;
+
+    RGBColor red_low = {150, 0, 0}, red_high = {255, 80, 80};
+    RGBColor blue_low = {0, 0, 150}, blue_high = {80, 80, 255};
+    TEST_CHECK_EQUAL(rules.add_rgb_box(red_low, red_high, on_match, &reds), 0);
+    TEST_CHECK_EQUAL(rules.add_rgb_box(blue_low, blue_high, on_match, &blues), 1);
+
+    ColorSample sample(blue, red, 100);
+    rules.evaluate(sample);
+    TEST_CHECK_EQUAL(reds, 1);
+    TEST_CHECK_EQUAL(blues, 0);
+    TEST_CHECK(rules.matching(0));
+    TEST_CHECK(!rules.matching(1));
+
+    // A rule triggers once per match, not on every sample
+    rules.evaluate(sample);
+    TEST_CHECK_EQUAL(reds, 1);
+
+    ColorSample other(red, green, 100);
+    rules.evaluate(other);
+    TEST_CHECK(!rules.matching(0));
+    rules.evaluate(sample);
+    TEST_CHECK_EQUAL(reds, 2);
+}
+
+static void test_hue_range() {
+    TCS3200Rule table[2];
+    TCS3200Rules rules(table, 2);
+    uint32_t reds = 0, greens = 0;
+
+    // The red range wraps around 360 degrees
+    rules.add_hue_range(340, 20, on_match, &reds);
+    rules.add_hue_range(100, 140, on_match, &greens);
+
+    ColorSample sample(blue, red, 100);
+    rules.evaluate(sample);
+    TEST_CHECK_EQUAL(reds, 1);
+    TEST_CHECK_EQUAL(greens, 0);
+
+    ColorSample other(blue, green, 100);
+    rules.evaluate(other);
+    TEST_CHECK_EQUAL(reds, 1);
+    TEST_CHECK_EQUAL(greens, 1);
+    TEST_CHECK(!rules.matching(0));
+    TEST_CHECK(rules.matching(1));
+}
+
+static void test_delta_e() {
+    TCS3200Rule table[1];
+    TCS3200Rules rules(table, 1);
+    uint32_t matches = 0;
+
+    CIELabColor reference = TCS3200::cie1931_to_cielab(TCS3200::rgb_to_cie1931(red));
+    rules.add_delta_e(reference, 2.0f, on_match, &matches);
+
+    ColorSample sample(blue, red, 100);
+    rules.evaluate(sample);
+    TEST_CHECK_EQUAL(matches, 1);
+
+    RGBColor near = {203, 42, 40};
+    ColorSample close(blue, near, 100);
+    rules.evaluate(close);
+    TEST_CHECK(rules.matching(0));
+
+    ColorSample far(red, blue, 100);
+    rules.evaluate(far);
+    TEST_CHECK(!rules.matching(0));
+    TEST_CHECK_EQUAL(matches, 1);
+}
+
+static void test_palette() {
+    const RGBColor colors[3] = {{255, 0, 0}, {0, 255, 0}, {0, 0, 255}};
+    TCS3200PaletteNode nodes[3];
+    TCS3200Palette palette(nodes, 3);
+    palette.build(colors);
+
+    TCS3200Rule table[1];
+    TCS3200Rules rules(table, 1);
+    uint32_t changes = 0;
+
+    // A full table refuses new rules until it is cleared
+    TEST_CHECK_EQUAL(rules.add_palette(&palette, on_match, &changes), 0);
+    TEST_CHECK_EQUAL(rules.add_palette(&palette, on_match, &changes), -1);
+    TEST_CHECK_EQUAL(rules.count(), 1);
+
+    rules.clear();
+    TEST_CHECK_EQUAL(rules.count(), 0);
+    TEST_CHECK_EQUAL(rules.add_palette(&palette, on_match, &changes), 0);
+
+    // Every new nearest color triggers, the same one does not
+    ColorSample sample(blue, red, 100);
+    rules.evaluate(sample);
+    rules.evaluate(sample);
+    TEST_CHECK_EQUAL(changes, 1);
+    TEST_CHECK(rules.matching(0));
+
+    ColorSample other(blue, green, 100);
+    rules.evaluate(other);
+    TEST_CHECK_EQUAL(changes, 2);
+
+    rules.evaluate(sample);
+    TEST_CHECK_EQUAL(changes, 3);
+}
+
+static void test_dominant_color() {
+    ColorSample sample(blue, red, 100);
+
+    TEST_CHECK_EQUAL(sample.dominant_color(), TCS3200_COLOR_RED);
+    TEST_CHECK_EQUAL(sample.balanced().red, red.red);
+    TEST_CHECK_EQUAL(sample.rgb().blue, blue.blue);
+}
+
+static void test_loop() {
+    // Swaps red and blue, so corrected and uncorrected readings differ
+    const float swap_red_blue[3][4] = {
+        {0, 0, 1, 0},
+        {0, 1, 0, 0},
+        {1, 0, 0, 0}
+    };
+
+    TCS3200SimulatedHAL simulator(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN);
+    TCS3200 tcs3200(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN);
+
+    tcs3200.hal(&simulator);
+    tcs3200.begin();
+    tcs3200.frequency_scaling(TCS3200_OFREQ_20P);
+
+    simulator.spectrum(30000, 30000, 30000, 80000);
+    tcs3200.calibrate_light();
+    simulator.spectrum(1000, 1000, 1000, 2500);
+    tcs3200.calibrate_dark();
+    tcs3200.calibrate();
+    tcs3200.integration_time(10000);
+    tcs3200.color_correction(swap_red_blue);
+
+    // A red target reads blue after the correction
+    simulator.spectrum(20000, 1200, 1200, 30000);
+
+    TCS3200Rule table[3];
+    TCS3200Rules rules(table, 3);
+    uint32_t reds = 0, blues = 0, blue_hues = 0;
+
+    RGBColor red_low = {150, 0, 0}, red_high = {255, 80, 80};
+    RGBColor blue_low = {0, 0, 150}, blue_high = {80, 80, 255};
+    rules.add_rgb_box(red_low, red_high, on_match, &reds);
+    rules.add_rgb_box(blue_low, blue_high, on_match, &blues);
+    rules.add_hue_range(200, 260, on_match, &blue_hues);
+    tcs3200.attach_rules(&rules);
+
+    for(uint8_t frames = 0; frames < 4; ) {
+        tcs3200.loop();
+
+        if(tcs3200.available()) {
+            tcs3200.read_frame();
+            frames++;
+        }
+    }
+
+    TEST_CHECK_EQUAL(reds, 0);
+    TEST_CHECK_EQUAL(blues, 1);
+    TEST_CHECK_EQUAL(blue_hues, 1);
+    TEST_CHECK_EQUAL(tcs3200.get_rgb_dominant_color(), TCS3200_COLOR_BLUE);
+}
+
+int main() {
+    test_rgb_box();
+    test_hue_range();
+    test_delta_e();
+    test_palette();
+    test_dominant_color();
+    test_loop();
+
+    return test_result();
+}
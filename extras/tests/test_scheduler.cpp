@@ -0,0 +1,212 @@
+/*
+ * This file is part of the TCS3200 Color Sensor Arduino library.
+ * Copyright (c) 2023 Nathanne Isip
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "TCS3200Simulator.h"
+#include "test.h"
+
+#include <algorithm>
+#include <time.h>
+
+#define S0_PIN  4
+#define S1_PIN  5
+#define S2_PIN  6
+#define S3_PIN  7
+#define OUT_PIN 8
+
+// Worst-case virtual time of one loop() call: a few clock readings
+// and no pulse measurement or busy-wait
+#define LOOP_VIRTUAL_BOUND  4
+
+// CPU time of one loop() call on the host, in microseconds. Host
+// interrupts can stretch single calls, so the 99.9th percentile is
+// held to the actual cost and the worst case to a bound that still
+// catches a call that waits for the sensor.
+#define LOOP_CPU_P999       10
+#define LOOP_CPU_BOUND      1000
+
+#define SETTLING_TIME   500
+#define FRAMES          8
+#define MAX_CALLS       65536
+
+class SwitchHAL : public TCS3200SimulatedHAL {
+public:
+    uint32_t switch_time;
+
+    SwitchHAL():
+        TCS3200SimulatedHAL(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN),
+        switch_time(0) { }
+
+    void digital_write(uint8_t pin, uint8_t value) {
+        TCS3200SimulatedHAL::digital_write(pin, value);
+
+        if(pin == S2_PIN || pin == S3_PIN)
+            this->switch_time = this->now();
+    }
+};
+
+// An OUT pin without an external interrupt, like most pins of an Uno
+class NoInterruptHAL : public TCS3200SimulatedHAL {
+public:
+    NoInterruptHAL():
+        TCS3200SimulatedHAL(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN) { }
+
+    bool attach_edge(uint8_t pin, void (*isr)()) {
+        (void) pin;
+        (void) isr;
+
+        return false;
+    }
+};
+
+static uint32_t callbacks = 0;
+static uint64_t cpu_times[MAX_CALLS];
+
+static void on_bound() {
+    callbacks++;
+}
+
+static uint64_t cpu_time() {
+    struct timespec time;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+
+    return (uint64_t) time.tv_sec * 1000000000ULL + time.tv_nsec;
+}
+
+static void test_latency() {
+    SwitchHAL simulator;
+    TCS3200 tcs3200(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN);
+
+    tcs3200.hal(&simulator);
+    tcs3200.begin();
+    tcs3200.frequency_scaling(TCS3200_OFREQ_20P);
+
+    simulator.spectrum(30000, 30000, 30000, 80000);
+    tcs3200.calibrate_light();
+    simulator.spectrum(300, 300, 300, 800);
+    tcs3200.calibrate_dark();
+    tcs3200.calibrate();
+
+    simulator.spectrum(12000, 6000, 3000, 20000);
+    tcs3200.settling_time(SETTLING_TIME);
+    tcs3200.integration_time(2000);
+
+    // Arm both bounds so every frame is evaluated
+    RGBColor upper = {10, 10, 10}, lower = {250, 250, 250};
+    tcs3200.upper_bound_interrupt(upper, on_bound);
+    tcs3200.lower_bound_interrupt(lower, on_bound);
+
+    uint64_t worst_cpu = 0;
+    uint32_t worst_virtual = 0, calls = 0, settling_calls = 0, frames = 0;
+
+    while(frames < FRAMES) {
+        uint32_t start = simulator.now();
+        uint64_t cpu_start = cpu_time();
+
+        tcs3200.loop();
+
+        uint64_t cpu = cpu_time() - cpu_start;
+        uint32_t elapsed = simulator.now() - start - 1;
+
+        if(cpu > worst_cpu)
+            worst_cpu = cpu;
+        if(calls < MAX_CALLS)
+            cpu_times[calls] = cpu;
+        if(elapsed > worst_virtual)
+            worst_virtual = elapsed;
+
+        // Calls made while the last filter switch is settling
+        if(start - simulator.switch_time < SETTLING_TIME)
+            settling_calls++;
+
+        if(tcs3200.available()) {
+            tcs3200.read_frame();
+            frames++;
+        }
+
+        calls++;
+    }
+
+    uint32_t measured = min(calls, (uint32_t) MAX_CALLS);
+    std::sort(cpu_times, cpu_times + measured);
+    uint64_t p999 = cpu_times[measured * 999 / 1000];
+
+    printf("%u calls, %u while settling, %u us virtual, CPU p99.9 %.2f us, worst %.2f us\n",
+        calls, settling_calls, worst_virtual, p999 / 1000.0, worst_cpu / 1000.0);
+
+    TEST_CHECK(callbacks > 0);
+    TEST_CHECK(worst_virtual <= LOOP_VIRTUAL_BOUND);
+    TEST_CHECK(p999 <= LOOP_CPU_P999 * 1000ULL);
+    TEST_CHECK(worst_cpu <= LOOP_CPU_BOUND * 1000ULL);
+
+    // The scheduler keeps returning while a filter settles
+    TEST_CHECK(settling_calls >= FRAMES * 4 * SETTLING_TIME / (2 * LOOP_VIRTUAL_BOUND));
+
+    tcs3200.clear_upper_bound_interrupt();
+    tcs3200.clear_lower_bound_interrupt();
+}
+
+static void test_without_interrupt() {
+    NoInterruptHAL simulator;
+    TCS3200 tcs3200(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN);
+
+    tcs3200.hal(&simulator);
+    tcs3200.begin();
+    tcs3200.frequency_scaling(TCS3200_OFREQ_20P);
+    TEST_CHECK(!tcs3200.start_measurement(TCS3200_COLOR_RED));
+
+    // Half the periods of 2400, 1200, 600 and 4000 Hz
+    simulator.spectrum(12000, 6000, 3000, 20000);
+    RGBColor lower = {255, 255, 255};
+    tcs3200.lower_bound_interrupt(lower, on_bound);
+    callbacks = 0;
+
+    uint32_t calls = 0, frames = 0;
+    while(frames < FRAMES && calls < MAX_CALLS) {
+        tcs3200.loop();
+        calls++;
+
+        if(tcs3200.available()) {
+            RawRGBC frame = tcs3200.read_frame();
+
+            TEST_CHECK_EQUAL(frame.valid, 0x0f);
+            TEST_CHECK_NEAR(frame.red, 208, 2);
+            TEST_CHECK_NEAR(frame.green, 417, 2);
+            TEST_CHECK_NEAR(frame.blue, 833, 2);
+            TEST_CHECK_NEAR(frame.clear, 125, 2);
+            frames++;
+        }
+    }
+
+    TEST_CHECK_EQUAL(frames, FRAMES);
+    TEST_CHECK_EQUAL(callbacks, FRAMES);
+    TEST_CHECK_EQUAL(tcs3200.status(), TCS3200_STATUS_OK);
+
+    tcs3200.clear_lower_bound_interrupt();
+}
+
+int main() {
+    test_latency();
+    test_without_interrupt();
+
+    return test_result();
+}
@@ -0,0 +1,113 @@
+/*
+ * This file is part of the TCS3200 Color Sensor Arduino library.
+ * Copyright (c) 2023 Nathanne Isip
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "TCS3200Simulator.h"
+#include "test.h"
+
+#define S0_PIN  4
+#define S1_PIN  5
+#define S2_PIN  6
+#define S3_PIN  7
+#define OUT_PIN 8
+
+#define INTEGRATION_TIME    10000
+#define FRAMES              50
+
+// loop() may overrun the budget by the few microseconds each of its
+// calls takes, but not by a settling time or a gate
+#define FRAME_TOLERANCE     0.01
+
+static void test_polled_timestamps() {
+    TCS3200SimulatedHAL simulator(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN);
+    TCS3200EdgeCounter counter;
+    uint32_t span, periods;
+
+    simulator.spectrum(10000, 5000, 2500, 20000);
+    simulator.digital_write(S0_PIN, HIGH);
+    simulator.digital_write(S1_PIN, HIGH);
+    counter.hal(&simulator);
+
+    // Polling every tick timestamps the edges exactly, 100 us apart
+    TEST_CHECK(counter.attach(OUT_PIN));
+    for(uint32_t start = simulator.now(); simulator.now() - start < 5000;)
+        counter.poll();
+
+    uint32_t edges = counter.count(&span, &periods);
+    TEST_CHECK(edges >= 49);
+    TEST_CHECK(periods >= edges - 2);
+    TEST_CHECK_EQUAL(span, periods * 100);
+    counter.detach();
+
+    // A single poll at gate close has no whole periods to measure
+    TEST_CHECK(counter.attach(OUT_PIN));
+    simulator.advance(5000);
+    counter.poll();
+
+    TEST_CHECK_EQUAL(counter.count(&span, &periods), 50);
+    TEST_CHECK_EQUAL(periods, 0);
+    TEST_CHECK_EQUAL(span, 0);
+    counter.detach();
+}
+
+static void test_frame_budget() {
+    TCS3200SimulatedHAL simulator(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN);
+    TCS3200 tcs3200(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN);
+
+    simulator.spectrum(10000, 5000, 2500, 20000);
+    tcs3200.hal(&simulator);
+    tcs3200.begin();
+    tcs3200.frequency_scaling(TCS3200_OFREQ_20P);
+    tcs3200.integration_time(INTEGRATION_TIME);
+    tcs3200.sampling(true);
+
+    // Let the first frame start from a settled filter
+    while(!tcs3200.available())
+        tcs3200.loop();
+    tcs3200.read_frame();
+
+    uint32_t start = simulator.now();
+    for(uint8_t i = 0; i < FRAMES; i++) {
+        while(!tcs3200.available())
+            tcs3200.loop();
+
+        // Half the periods of 2000, 1000, 500 and 4000 Hz
+        RawRGBC frame = tcs3200.read_frame();
+        TEST_CHECK_EQUAL(frame.valid, 0x0f);
+        TEST_CHECK_NEAR(frame.red, 250, 2);
+        TEST_CHECK_NEAR(frame.green, 500, 5);
+        TEST_CHECK_NEAR(frame.blue, 1000, 10);
+        TEST_CHECK_NEAR(frame.clear, 125, 1);
+    }
+
+    double frame_time = (double) (simulator.now() - start) / FRAMES;
+    TEST_CHECK(frame_time >= tcs3200.frame_budget());
+    TEST_CHECK_NEAR(frame_time, tcs3200.frame_budget(),
+        tcs3200.frame_budget() * FRAME_TOLERANCE);
+}
+
+int main() {
+    test_polled_timestamps();
+    test_frame_budget();
+
+    return test_result();
+}
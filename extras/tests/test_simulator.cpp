@@ -0,0 +1,209 @@
+/*
+ * This file is part of the TCS3200 Color Sensor Arduino library.
+ * Copyright (c) 2023 Nathanne Isip
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "TCS3200Simulator.h"
+#include "test.h"
+
+#define S0_PIN  4
+#define S1_PIN  5
+#define S2_PIN  6
+#define S3_PIN  7
+#define OUT_PIN 8
+
+static uint32_t edges = 0, other_edges = 0;
+
+static void count_edge() {
+    edges++;
+}
+
+static void count_other_edge() {
+    other_edges++;
+}
+
+static void select(TCS3200SimulatedHAL &simulator, uint8_t s0, uint8_t s1, uint8_t s2, uint8_t s3) {
+    simulator.digital_write(S0_PIN, s0);
+    simulator.digital_write(S1_PIN, s1);
+    simulator.digital_write(S2_PIN, s2);
+    simulator.digital_write(S3_PIN, s3);
+}
+
+static void test_waveform() {
+    TCS3200SimulatedHAL simulator(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN);
+    simulator.spectrum(10000, 5000, 2500, 20000);
+
+    // Filters follow the S2/S3 truth table of the datasheet
+    select(simulator, HIGH, HIGH, LOW, LOW);
+    TEST_CHECK_EQUAL(simulator.pulse_in(OUT_PIN, LOW, 1000), 50);
+    select(simulator, HIGH, HIGH, HIGH, HIGH);
+    TEST_CHECK_EQUAL(simulator.pulse_in(OUT_PIN, LOW, 1000), 100);
+    select(simulator, HIGH, HIGH, LOW, HIGH);
+    TEST_CHECK_EQUAL(simulator.pulse_in(OUT_PIN, LOW, 1000), 200);
+    select(simulator, HIGH, HIGH, HIGH, LOW);
+    TEST_CHECK_EQUAL(simulator.pulse_in(OUT_PIN, LOW, 1000), 25);
+
+    // S0/S1 scale the output frequency
+    select(simulator, HIGH, LOW, LOW, LOW);
+    TEST_CHECK_EQUAL(simulator.pulse_in(OUT_PIN, LOW, 10000), 250);
+    select(simulator, LOW, HIGH, LOW, LOW);
+    TEST_CHECK_EQUAL(simulator.pulse_in(OUT_PIN, LOW, 10000), 2500);
+
+    // Power down and other pins time out after the full timeout
+    select(simulator, LOW, LOW, LOW, LOW);
+    uint32_t start = simulator.now();
+    TEST_CHECK_EQUAL(simulator.pulse_in(OUT_PIN, LOW, 1000), 0);
+    TEST_CHECK(simulator.now() - start >= 1000);
+
+    select(simulator, HIGH, HIGH, LOW, LOW);
+    TEST_CHECK_EQUAL(simulator.pulse_in(OUT_PIN + 1, LOW, 1000), 0);
+
+    // Pulses longer than the timeout are not reported
+    TEST_CHECK_EQUAL(simulator.pulse_in(OUT_PIN, LOW, 40), 0);
+}
+
+static void test_edges() {
+    TCS3200SimulatedHAL simulator(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN);
+    simulator.spectrum(10000, 5000, 2500, 20000);
+    select(simulator, HIGH, HIGH, LOW, LOW);
+
+    edges = 0;
+    simulator.attach_edge(OUT_PIN, count_edge);
+    simulator.advance(10000);
+    TEST_CHECK_EQUAL(edges, 100);
+
+    simulator.detach_edge(OUT_PIN);
+    simulator.advance(10000);
+    TEST_CHECK_EQUAL(edges, 100);
+
+    // Time only moves forward by the tick on every clock reading
+    simulator.tick(3);
+    uint32_t time = simulator.now();
+    TEST_CHECK_EQUAL(simulator.now() - time, 3);
+}
+
+static void test_outputs() {
+    TCS3200SimulatedHAL simulator(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN);
+
+    TEST_CHECK(simulator.add_output(OUT_PIN + 1));
+    TEST_CHECK(!simulator.add_output(OUT_PIN + 1));
+    TEST_CHECK(!simulator.add_output(OUT_PIN));
+
+    uint8_t added = 2;
+    while(simulator.add_output(OUT_PIN + added))
+        added++;
+    TEST_CHECK_EQUAL(added, TCS3200_SIM_OUTPUTS);
+
+    // Every output has its own spectrum and waveform
+    simulator.spectrum(10000, 5000, 2500, 20000);
+    simulator.spectrum(OUT_PIN + 1, 2000, 1000, 500, 4000);
+    select(simulator, HIGH, HIGH, LOW, LOW);
+
+    TEST_CHECK_EQUAL(simulator.pulse_in(OUT_PIN, LOW, 1000), 50);
+    TEST_CHECK_EQUAL(simulator.pulse_in(OUT_PIN + 1, LOW, 1000), 250);
+    TEST_CHECK_EQUAL(simulator.pulse_in(OUT_PIN + 2, LOW, 1000), 0);
+
+    // ...and its own edge interrupt, fired in time order
+    edges = other_edges = 0;
+    simulator.attach_edge(OUT_PIN, count_edge);
+    simulator.attach_edge(OUT_PIN + 1, count_other_edge);
+    simulator.advance(10000);
+    TEST_CHECK_EQUAL(edges, 100);
+    TEST_CHECK_EQUAL(other_edges, 20);
+
+    // Filter switches apply to every output at once
+    select(simulator, HIGH, HIGH, HIGH, HIGH);
+    simulator.advance(10000);
+    TEST_CHECK_EQUAL(edges, 150);
+    TEST_CHECK_EQUAL(other_edges, 30);
+
+    simulator.detach_edge(OUT_PIN);
+    simulator.advance(10000);
+    TEST_CHECK_EQUAL(edges, 150);
+    TEST_CHECK_EQUAL(other_edges, 40);
+}
+
+static uint32_t mean_pulse(TCS3200SimulatedHAL &simulator, uint32_t *spread) {
+    uint32_t sum = 0, low = 0xffffffff, high = 0;
+
+    for(uint8_t i = 0; i < 100; i++) {
+        uint32_t pulse = simulator.pulse_in(OUT_PIN, LOW, 10000);
+        sum += pulse;
+        low = min(low, pulse);
+        high = max(high, pulse);
+    }
+
+    *spread = high - low;
+    return sum / 100;
+}
+
+static void test_noise() {
+    TCS3200SimulatedHAL first(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN);
+    TCS3200SimulatedHAL second(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN);
+
+    TCS3200SimulatedHAL *simulators[2] = {&first, &second};
+    for(uint8_t i = 0; i < 2; i++) {
+        simulators[i]->spectrum(1000, 1000, 1000, 1000);
+        simulators[i]->noise(10);
+        simulators[i]->seed(42);
+        select(*simulators[i], HIGH, HIGH, LOW, LOW);
+    }
+
+    // The same seed reproduces the same sequence
+    bool same = true;
+    for(uint8_t i = 0; i < 50; i++)
+        same &= first.pulse_in(OUT_PIN, LOW, 10000) == second.pulse_in(OUT_PIN, LOW, 10000);
+    TEST_CHECK(same);
+
+    uint32_t spread;
+    uint32_t mean = mean_pulse(first, &spread);
+    TEST_CHECK_NEAR(mean, 500, 10);
+    TEST_CHECK(spread > 0);
+    TEST_CHECK(spread <= 100);
+}
+
+static void test_sensor() {
+    TCS3200SimulatedHAL simulator(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN);
+    TCS3200 tcs3200(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN);
+
+    simulator.spectrum(10000, 5000, 2500, 20000);
+    tcs3200.hal(&simulator);
+    tcs3200.begin();
+    tcs3200.frequency_scaling(TCS3200_OFREQ_20P);
+
+    RawRGBC raw = tcs3200.read_raw_rgbc();
+    TEST_CHECK_EQUAL(raw.red, 250);
+    TEST_CHECK_EQUAL(raw.green, 500);
+    TEST_CHECK_EQUAL(raw.blue, 1000);
+    TEST_CHECK_EQUAL(raw.clear, 125);
+    TEST_CHECK_EQUAL(raw.valid, 0x0f);
+    TEST_CHECK_EQUAL(raw.scaling, TCS3200_OFREQ_20P);
+}
+
+int main() {
+    test_waveform();
+    test_edges();
+    test_outputs();
+    test_noise();
+    test_sensor();
+
+    return test_result();
+}
@@ -0,0 +1,129 @@
+/*
+ * This file is part of the TCS3200 Color Sensor Arduino library.
+ * Copyright (c) 2023 Nathanne Isip
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "TCS3200Simulator.h"
+#include "test.h"
+
+#define S0_PIN  4
+#define S1_PIN  5
+#define S2_PIN  6
+#define S3_PIN  7
+#define OUT_PIN 8
+
+#define READS   10
+#define FRAMES  4
+
+// Built without TCS3200_ENABLE_STATS against a library built with it,
+// so this also checks that the class layout does not depend on it
+#if TCS3200_ENABLE_STATS
+#error "test_stats must be compiled without TCS3200_ENABLE_STATS"
+#endif
+
+static TCS3200SimulatedHAL simulator(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN);
+static TCS3200 tcs3200(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN);
+static uint32_t callbacks = 0;
+
+static void on_bound() {
+    callbacks++;
+}
+
+static void test_blocking_reads() {
+    tcs3200.reset_stats();
+
+    // Half the periods of 2000 and 4000 Hz
+    simulator.spectrum(10000, 10000, 10000, 20000);
+    for(uint8_t i = 0; i < READS; i++) {
+        tcs3200.read_raw_red();
+        tcs3200.read_raw_clear();
+    }
+
+    TCS3200Stats stats = tcs3200.stats();
+    TCS3200ChannelStats red = stats.channels[TCS3200_COLOR_RED];
+    TCS3200ChannelStats clear = stats.channels[TCS3200_COLOR_CLEAR];
+
+    TEST_CHECK_EQUAL(red.samples, READS);
+    TEST_CHECK_EQUAL(red.timeouts, 0);
+    TEST_CHECK_EQUAL(clear.samples, READS);
+    TEST_CHECK_EQUAL(stats.channels[TCS3200_COLOR_GREEN].samples, 0);
+
+    // pulseIn() waits for the pulse in progress, then measures one
+    TEST_CHECK(red.min_time >= 250 && red.max_time <= 3 * 250 + 2);
+    TEST_CHECK(clear.min_time >= 125 && clear.max_time <= 3 * 125 + 2);
+    TEST_CHECK(red.min_time <= red.mean_time && red.mean_time <= red.max_time);
+
+    // Uncalibrated readings of 255 us or more saturate at 0
+    simulator.spectrum(0, 0, 0, 0);
+    tcs3200.read_red();
+    stats = tcs3200.stats();
+    TEST_CHECK_EQUAL(stats.channels[TCS3200_COLOR_RED].timeouts, 1);
+    TEST_CHECK_EQUAL(stats.channels[TCS3200_COLOR_RED].saturated, 1);
+    TEST_CHECK_EQUAL(tcs3200.status(), TCS3200_STATUS_TIMEOUT);
+
+    tcs3200.reset_stats();
+    stats = tcs3200.stats();
+    TEST_CHECK_EQUAL(stats.channels[TCS3200_COLOR_RED].samples, 0);
+    TEST_CHECK_EQUAL(stats.channels[TCS3200_COLOR_RED].max_time, 0);
+}
+
+static void test_loop() {
+    tcs3200.reset_stats();
+    tcs3200.integration_time(2000);
+
+    simulator.spectrum(10000, 10000, 10000, 20000);
+    RGBColor lower = {255, 255, 255};
+    tcs3200.lower_bound_interrupt(lower, on_bound);
+
+    for(uint8_t frames = 0; frames < FRAMES; ) {
+        tcs3200.loop();
+
+        if(tcs3200.available()) {
+            tcs3200.read_frame();
+            frames++;
+        }
+    }
+
+    TCS3200Stats stats = tcs3200.stats();
+    TEST_CHECK_EQUAL(stats.frames, FRAMES);
+    TEST_CHECK_EQUAL(stats.callbacks, callbacks);
+    TEST_CHECK_EQUAL(callbacks, FRAMES);
+
+    // Each channel is counted over one gate per frame
+    for(uint8_t i = 0; i < 4; i++) {
+        TEST_CHECK_EQUAL(stats.channels[i].samples, FRAMES);
+        TEST_CHECK(stats.channels[i].min_time >= 2000);
+        TEST_CHECK(stats.channels[i].max_time <= 2010);
+    }
+
+    tcs3200.clear_lower_bound_interrupt();
+}
+
+int main() {
+    tcs3200.hal(&simulator);
+    tcs3200.begin();
+    tcs3200.frequency_scaling(TCS3200_OFREQ_20P);
+
+    test_blocking_reads();
+    test_loop();
+
+    return test_result();
+}
@@ -0,0 +1,153 @@
+/*
+ * This file is part of the TCS3200 Color Sensor Arduino library.
+ * Copyright (c) 2023 Nathanne Isip
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "TCS3200Simulator.h"
+#include "test.h"
+
+#define S0_PIN  4
+#define S1_PIN  5
+#define S2_PIN  6
+#define S3_PIN  7
+#define OUT_PIN 8
+
+// Clock readings and rounding on top of a measurement
+#define SLACK   16
+
+static TCS3200SimulatedHAL simulator(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN);
+static TCS3200 tcs3200(S0_PIN, S1_PIN, S2_PIN, S3_PIN, OUT_PIN);
+
+static void test_no_signal() {
+    simulator.spectrum(0, 0, 0, 0);
+
+    // A missing pulse reads as the darkest value
+    TEST_CHECK_EQUAL(tcs3200.read_red(), 0);
+    TEST_CHECK_EQUAL(tcs3200.status(), TCS3200_STATUS_TIMEOUT);
+    TEST_CHECK_EQUAL(tcs3200.status(), TCS3200_STATUS_OK);
+
+    RawRGBC raw = tcs3200.read_raw_rgbc();
+    TEST_CHECK_EQUAL(raw.valid, 0);
+    TEST_CHECK_EQUAL(raw.red, 0);
+    TEST_CHECK_EQUAL(raw.clear, 0);
+    TEST_CHECK_EQUAL(tcs3200.status(), TCS3200_STATUS_TIMEOUT);
+
+    // Partial frames mark only the channels that were measured
+    simulator.spectrum(0, 10000, 10000, 20000);
+    raw = tcs3200.read_raw_rgbc();
+    TEST_CHECK_EQUAL(raw.valid, 1 << TCS3200_COLOR_GREEN |
+        1 << TCS3200_COLOR_BLUE | 1 << TCS3200_COLOR_CLEAR);
+    TEST_CHECK_EQUAL(raw.green, 250);
+    TEST_CHECK_EQUAL(tcs3200.status(), TCS3200_STATUS_TIMEOUT);
+
+    // Frames of loop() report the timeout as well
+    simulator.spectrum(0, 0, 0, 0);
+    tcs3200.sampling(true);
+    while(!tcs3200.available())
+        tcs3200.loop();
+    TEST_CHECK_EQUAL(tcs3200.read_frame().valid, 0);
+    TEST_CHECK_EQUAL(tcs3200.status(), TCS3200_STATUS_TIMEOUT);
+    tcs3200.sampling(false);
+}
+
+static void test_deadline() {
+    simulator.spectrum(0, 0, 0, 0);
+
+    // Derived from the 2 ms integration time and the scaling
+    TEST_CHECK_EQUAL(tcs3200.read_timeout(), 10000);
+    tcs3200.frequency_scaling(TCS3200_OFREQ_2P);
+    TEST_CHECK_EQUAL(tcs3200.read_timeout(), 100000);
+    tcs3200.frequency_scaling(TCS3200_OFREQ_100P);
+    TEST_CHECK_EQUAL(tcs3200.read_timeout(), 2000);
+    tcs3200.frequency_scaling(TCS3200_OFREQ_20P);
+
+    // A read without signal waits for the settling time and the deadline
+    tcs3200.read_green();
+    uint32_t start = simulator.now();
+    tcs3200.read_red();
+    uint32_t elapsed = simulator.now() - start;
+    TEST_CHECK(elapsed >= tcs3200.read_timeout());
+    TEST_CHECK(elapsed <= tcs3200.settling_time() + tcs3200.read_timeout() + SLACK);
+
+    // A frame takes at most four deadlines
+    start = simulator.now();
+    tcs3200.read_raw_rgbc();
+    TEST_CHECK(simulator.now() - start <= 4 * (tcs3200.settling_time() + tcs3200.read_timeout() + SLACK));
+
+    // A fixed deadline replaces the derived one at every scaling
+    tcs3200.read_timeout(1000);
+    TEST_CHECK_EQUAL(tcs3200.read_timeout(), 1000);
+    tcs3200.frequency_scaling(TCS3200_OFREQ_2P);
+    TEST_CHECK_EQUAL(tcs3200.read_timeout(), 1000);
+    tcs3200.frequency_scaling(TCS3200_OFREQ_20P);
+
+    // Pulses of 2500 us do not fit a 1000 us deadline
+    simulator.spectrum(1000, 1000, 1000, 1000);
+    tcs3200.status();
+    start = simulator.now();
+    TEST_CHECK_EQUAL(tcs3200.read_raw_rgbc().valid, 0);
+    TEST_CHECK(simulator.now() - start <= 4 * (tcs3200.settling_time() + 1000 + SLACK));
+    TEST_CHECK_EQUAL(tcs3200.status(), TCS3200_STATUS_TIMEOUT);
+
+    // They fit the derived deadline again
+    tcs3200.read_timeout(0);
+    TEST_CHECK_EQUAL(tcs3200.read_raw_rgbc().red, 2500);
+    TEST_CHECK_EQUAL(tcs3200.status(), TCS3200_STATUS_OK);
+}
+
+static void test_out_of_range() {
+    simulator.spectrum(30000, 30000, 30000, 80000);
+    tcs3200.calibrate_light();
+    simulator.spectrum(1000, 1000, 1000, 2500);
+    tcs3200.calibrate_dark();
+    tcs3200.calibrate();
+    tcs3200.status();
+
+    // Readings inside the calibrated range are valid
+    simulator.spectrum(10000, 10000, 10000, 25000);
+    tcs3200.read_rgb_color();
+    TEST_CHECK_EQUAL(tcs3200.status(), TCS3200_STATUS_OK);
+
+    // Brighter than white and darker than black are clamped
+    simulator.spectrum(60000, 60000, 60000, 160000);
+    TEST_CHECK_EQUAL(tcs3200.read_red(), 255);
+    TEST_CHECK_EQUAL(tcs3200.status(), TCS3200_STATUS_SATURATED);
+
+    simulator.spectrum(800, 800, 800, 2000);
+    TEST_CHECK_EQUAL(tcs3200.read_red(), 0);
+    TEST_CHECK_EQUAL(tcs3200.status(), TCS3200_STATUS_SATURATED);
+
+    // A missing pulse is both past the deadline and darker than black
+    simulator.spectrum(0, 0, 0, 0);
+    TEST_CHECK_EQUAL(tcs3200.read_red(), 0);
+    TEST_CHECK_EQUAL(tcs3200.status(), TCS3200_STATUS_TIMEOUT | TCS3200_STATUS_SATURATED);
+}
+
+int main() {
+    tcs3200.hal(&simulator);
+    tcs3200.begin();
+    tcs3200.frequency_scaling(TCS3200_OFREQ_20P);
+
+    test_no_signal();
+    test_deadline();
+    test_out_of_range();
+
+    return test_result();
+}
@@ -21,304 +21,2021 @@
  * THE SOFTWARE.
  */
 
-#include "tcs3200.h"
+#include "TCS3200.h"
+#include "TCS3200Filters.h"
+#include "TCS3200RingBuffer.h"
+#include "TCS3200Rules.h"
+
+#if TCS3200_EDGE_COUNTER_SLOTS < 1 || TCS3200_EDGE_COUNTER_SLOTS > 8
+#error "TCS3200_EDGE_COUNTER_SLOTS must be between 1 and 8"
+#endif
+
+#define TCS3200_SAMPLE_HSV      0x01
+#define TCS3200_SAMPLE_CMYK     0x02
+#define TCS3200_SAMPLE_CIE1931  0x04
+#define TCS3200_SAMPLE_CHROMA   0x08
+#define TCS3200_SAMPLE_CIELAB   0x10
+
+#define TCS3200_Q24_ONE         16777216UL
+#define TCS3200_Q16_FROM_8BIT(x) (((int32_t) (x) * 65793L + 128) >> 8)
+
+#define TCS3200_SCAN_SELECT     0x00
+#define TCS3200_SCAN_SETTLE     0x01
+#define TCS3200_SCAN_MEASURE    0x02
+
+#if TCS3200_ENABLE_STATS
+#define TCS3200_STAT(statement) statement
+#else
+#define TCS3200_STAT(statement)
+#endif
+
+#if defined(ESP32) || defined(ESP8266)
+#define TCS3200_ISR_ATTR IRAM_ATTR
+#else
+#define TCS3200_ISR_ATTR
+#endif
+
+static const uint8_t tcs3200_channel_orders[2][4] = {
+    {TCS3200_COLOR_RED, TCS3200_COLOR_GREEN, TCS3200_COLOR_BLUE, TCS3200_COLOR_CLEAR},
+    {TCS3200_COLOR_RED, TCS3200_COLOR_BLUE, TCS3200_COLOR_GREEN, TCS3200_COLOR_CLEAR}
+};
+
+static volatile uint32_t tcs3200_edge_counts[TCS3200_EDGE_COUNTER_SLOTS];
+static bool tcs3200_edge_slots_used[TCS3200_EDGE_COUNTER_SLOTS];
+
+// Edges are timestamped by poll(), never from the interrupt
+template <uint8_t slot>
+static void TCS3200_ISR_ATTR tcs3200_edge_isr() {
+    tcs3200_edge_counts[slot]++;
+}
+
+// Only instantiate the interrupts of existing slots
+static void (*const tcs3200_edge_isrs[TCS3200_EDGE_COUNTER_SLOTS])() = {
+    tcs3200_edge_isr<0>
+#if TCS3200_EDGE_COUNTER_SLOTS > 1
+    , tcs3200_edge_isr<1>
+#endif
+#if TCS3200_EDGE_COUNTER_SLOTS > 2
+    , tcs3200_edge_isr<2>
+#endif
+#if TCS3200_EDGE_COUNTER_SLOTS > 3
+    , tcs3200_edge_isr<3>
+#endif
+#if TCS3200_EDGE_COUNTER_SLOTS > 4
+    , tcs3200_edge_isr<4>
+#endif
+#if TCS3200_EDGE_COUNTER_SLOTS > 5
+    , tcs3200_edge_isr<5>
+#endif
+#if TCS3200_EDGE_COUNTER_SLOTS > 6
+    , tcs3200_edge_isr<6>
+#endif
+#if TCS3200_EDGE_COUNTER_SLOTS > 7
+    , tcs3200_edge_isr<7>
+#endif
+};
+
+void TCS3200HAL::digital_write_pair(uint8_t first_pin, uint8_t first_value,
+    uint8_t second_pin, uint8_t second_value) {
+    this->digital_write(first_pin, first_value);
+    this->digital_write(second_pin, second_value);
+}
+
+void TCS3200ArduinoHAL::pin_mode(uint8_t pin, uint8_t mode) {
+    pinMode(pin, mode);
+}
+
+void TCS3200ArduinoHAL::digital_write(uint8_t pin, uint8_t value) {
+    digitalWrite(pin, value);
+}
+
+uint32_t TCS3200ArduinoHAL::pulse_in(uint8_t pin, uint8_t state, uint32_t timeout) {
+    return pulseIn(pin, state, timeout);
+}
+
+uint32_t TCS3200ArduinoHAL::now() {
+    return micros();
+}
+
+bool TCS3200ArduinoHAL::attach_edge(uint8_t pin, void (*isr)()) {
+    int interrupt = digitalPinToInterrupt(pin);
+
+#ifdef NOT_AN_INTERRUPT
+    if(interrupt == NOT_AN_INTERRUPT)
+        return false;
+#endif
+
+    attachInterrupt(interrupt, isr, FALLING);
+    return true;
+}
+
+void TCS3200ArduinoHAL::detach_edge(uint8_t pin) {
+    detachInterrupt(digitalPinToInterrupt(pin));
+}
+
+static TCS3200ArduinoHAL tcs3200_arduino_hal;
+
+TCS3200HAL *TCS3200ArduinoHAL::instance() {
+    return &tcs3200_arduino_hal;
+}
+
+TCS3200EdgeCounter::TCS3200EdgeCounter():
+    _slot(-1),
+    _pin(0),
+    _first_edges(0),
+    _first_time(0),
+    _last_edges(0),
+    _last_time(0),
+    _hal(TCS3200ArduinoHAL::instance()) { }
+
+bool TCS3200EdgeCounter::attach(uint8_t pin) {
+    if(this->_slot >= 0)
+        this->detach();
+
+    for(uint8_t i = 0; i < TCS3200_EDGE_COUNTER_SLOTS; i++) {
+        if(tcs3200_edge_slots_used[i])
+            continue;
+
+        tcs3200_edge_counts[i] = 0;
+        this->_first_edges = 0;
+        this->_last_edges = 0;
+
+        if(!this->_hal->attach_edge(pin, tcs3200_edge_isrs[i]))
+            return false;
+
+        tcs3200_edge_slots_used[i] = true;
+        this->_slot = i;
+        this->_pin = pin;
+
+        return true;
+    }
+
+    return false;
+}
+
+void TCS3200EdgeCounter::detach() {
+    if(this->_slot < 0)
+        return;
+
+    this->_hal->detach_edge(this->_pin);
+    tcs3200_edge_slots_used[this->_slot] = false;
+    this->_slot = -1;
+}
+
+bool TCS3200EdgeCounter::attached() {
+    return this->_slot >= 0;
+}
+
+uint32_t TCS3200EdgeCounter::edges() {
+#ifdef __AVR__
+    // Restore the interrupt flag rather than setting it, so callers
+    // running with interrupts disabled keep them disabled
+    uint8_t sreg = SREG;
+    cli();
+    uint32_t edges = tcs3200_edge_counts[this->_slot];
+    SREG = sreg;
+
+    return edges;
+#else
+    // Aligned 32-bit loads cannot be torn by the interrupt elsewhere
+    return tcs3200_edge_counts[this->_slot];
+#endif
+}
+
+void TCS3200EdgeCounter::poll() {
+    if(this->_slot < 0)
+        return;
+
+    uint32_t edges = this->edges();
+    if(edges == this->_last_edges)
+        return;
+
+    // The count moved since the last poll, so its newest edge is now
+    uint32_t time = this->_hal->now();
+    if(this->_first_edges == 0) {
+        this->_first_edges = edges;
+        this->_first_time = time;
+    }
+
+    this->_last_edges = edges;
+    this->_last_time = time;
+}
+
+uint32_t TCS3200EdgeCounter::count(uint32_t *span, uint32_t *periods) {
+    uint32_t edges = this->_slot >= 0 ? this->edges() : 0;
+
+    if(span != nullptr)
+        *span = edges > 0 ? this->_last_time - this->_first_time : 0;
+
+    if(periods != nullptr)
+        *periods = edges > 0 ? this->_last_edges - this->_first_edges : 0;
+
+    return edges;
+}
+
+void TCS3200EdgeCounter::hal(TCS3200HAL *hal) {
+    this->_hal = hal;
+}
+
+ColorSample::ColorSample():
+    _clear(0),
+    _cached(0) {
+    this->_rgb.red = this->_rgb.green = this->_rgb.blue = 0;
+    this->_balanced = this->_rgb;
+}
+
+ColorSample::ColorSample(RGBColor rgb, RGBColor balanced, uint8_t clear):
+    _rgb(rgb),
+    _balanced(balanced),
+    _clear(clear),
+    _cached(0) { }
+
+RGBColor ColorSample::rgb() {
+    return this->_rgb;
+}
+
+RGBColor ColorSample::balanced() {
+    return this->_balanced;
+}
+
+uint8_t ColorSample::clear() {
+    return this->_clear;
+}
+
+HSVColor ColorSample::hsv() {
+    if(!(this->_cached & TCS3200_SAMPLE_HSV)) {
+        this->_hsv = TCS3200::rgb_to_hsv(this->_balanced);
+        this->_cached |= TCS3200_SAMPLE_HSV;
+    }
+
+    return this->_hsv;
+}
+
+CMYKColor ColorSample::cmyk() {
+    if(!(this->_cached & TCS3200_SAMPLE_CMYK)) {
+        this->_cmyk = TCS3200::rgb_to_cmyk(this->_balanced);
+        this->_cached |= TCS3200_SAMPLE_CMYK;
+    }
+
+    return this->_cmyk;
+}
+
+CIE1931Color ColorSample::cie1931() {
+    if(!(this->_cached & TCS3200_SAMPLE_CIE1931)) {
+        this->_cie1931 = TCS3200::rgb_to_cie1931(this->_balanced);
+        this->_cached |= TCS3200_SAMPLE_CIE1931;
+    }
+
+    return this->_cie1931;
+}
+
+float ColorSample::chroma() {
+    if(!(this->_cached & TCS3200_SAMPLE_CHROMA)) {
+        this->_chroma = TCS3200::cie1931_to_chroma(this->cie1931());
+        this->_cached |= TCS3200_SAMPLE_CHROMA;
+    }
+
+    return this->_chroma;
+}
+
+CIELabColor ColorSample::cielab() {
+    if(!(this->_cached & TCS3200_SAMPLE_CIELAB)) {
+        this->_cielab = TCS3200::cie1931_to_cielab(this->cie1931());
+        this->_cached |= TCS3200_SAMPLE_CIELAB;
+    }
+
+    return this->_cielab;
+}
+
+uint8_t ColorSample::dominant_color() {
+    return TCS3200::rgb_dominant_color(this->_balanced);
+}
 
 TCS3200::TCS3200(uint8_t s0_pin, uint8_t s1_pin, uint8_t s2_pin, uint8_t s3_pin, uint8_t out_pin):
     _s0_pin(s0_pin),
     _s1_pin(s1_pin),
     _s2_pin(s2_pin),
     _s3_pin(s3_pin),
-    _out_pin(out_pin) { }
+    _out_pin(out_pin),
+    _hal(TCS3200ArduinoHAL::instance()),
+    _s2_level(0xff),
+    _s3_level(0xff),
+    _channel_order(TCS3200_ORDER_RGBC),
+    _ir_compensation(false),
+    upper_bound_interrupt_callback(nullptr),
+    lower_bound_interrupt_callback(nullptr),
+    _color_correction(false),
+    _edge_triggered(false),
+    _ub_active(false),
+    _lb_active(false),
+    _event_hysteresis(0),
+    _event_debounce(1),
+    _ub_count(0),
+    _lb_count(0),
+    _idle_interval(0),
+    _frame_end(0),
+    _idle_delta(0),
+    _idle_frames(0),
+    _stable_frames(0),
+    _measuring(false),
+    _measurement_start(0),
+    _measurement_elapsed(0),
+    _measurement_edges(0),
+    _measurement_periods(0),
+    _measurement_span(0),
+    _sampling(false),
+    _frame_available(false),
+    _scan_state(TCS3200_SCAN_SELECT),
+    _scan_channel(0),
+    _switch_time(0),
+    _ring_buffer(nullptr),
+    _filters(nullptr),
+    _rules(nullptr),
+    _curve_enabled(false),
+    _cal_active(false),
+    _cal_samples(10),
+    calibration_progress_callback(nullptr) {
+    this->_cal_stats.samples = 0;
+    this->reset_stats();
+    this->white_balance_rgb.red = this->white_balance_rgb.green = this->white_balance_rgb.blue = 0;
+    this->ub_threshold.red = this->ub_threshold.green = this->ub_threshold.blue = 255;
+    this->lb_threshold.red = this->lb_threshold.green = this->lb_threshold.blue = 0;
+    this->_last_reading.red = this->_last_reading.green = this->_last_reading.blue = 0;
+
+    for(uint8_t i = 0; i < 4; i++)
+        this->_settling_times[i] = TCS3200_SETTLING_TIME;
+}
 
 void TCS3200::begin() {
-    pinMode(this->_s0_pin, OUTPUT);
-    pinMode(this->_s1_pin, OUTPUT);
-    pinMode(this->_s2_pin, OUTPUT);
-    pinMode(this->_s3_pin, OUTPUT);
-    pinMode(this->_out_pin, INPUT);
+    this->_hal->pin_mode(this->_s0_pin, OUTPUT);
+    this->_hal->pin_mode(this->_s1_pin, OUTPUT);
+    this->_hal->pin_mode(this->_s2_pin, OUTPUT);
+    this->_hal->pin_mode(this->_s3_pin, OUTPUT);
+    this->_hal->pin_mode(this->_out_pin, INPUT);
 
     this->_integration_time = 2000;
     this->_frequency_scaling = 1.0;
+    this->_calibration_scaling = this->_frequency_scaling;
+    this->_auto_range = false;
+    this->_gate_time = this->_integration_time;
+    this->_read_timeout = 0;
+    this->_status = TCS3200_STATUS_OK;
+    this->_s2_level = this->_s3_level = 0xff;
     this->is_calibrated = false;
+
+    this->reset_stats();
 }
 
 void TCS3200::select_filter(uint8_t filter) {
+    uint8_t s2, s3;
+
     switch(filter) {
         case TCS3200_COLOR_RED:
-            digitalWrite(this->_s2_pin, LOW);
-            digitalWrite(this->_s3_pin, LOW);
+            s2 = LOW, s3 = LOW;
             break;
         case TCS3200_COLOR_GREEN:
-            digitalWrite(this->_s2_pin, HIGH);
-            digitalWrite(this->_s3_pin, HIGH);
+            s2 = HIGH, s3 = HIGH;
             break;
         case TCS3200_COLOR_BLUE:
-            digitalWrite(this->_s2_pin, LOW);
-            digitalWrite(this->_s3_pin, HIGH);
+            s2 = LOW, s3 = HIGH;
             break;
         case TCS3200_COLOR_CLEAR:
-            digitalWrite(this->_s2_pin, HIGH);
-            digitalWrite(this->_s3_pin, LOW);
+            s2 = HIGH, s3 = LOW;
             break;
+        default:
+            return;
     }
+
+    if(s2 == this->_s2_level && s3 == this->_s3_level)
+        return;
+
+    if(s2 != this->_s2_level && s3 != this->_s3_level)
+        this->_hal->digital_write_pair(this->_s2_pin, s2, this->_s3_pin, s3);
+    else if(s2 != this->_s2_level)
+        this->_hal->digital_write(this->_s2_pin, s2);
+    else this->_hal->digital_write(this->_s3_pin, s3);
+
+    this->_s2_level = s2;
+    this->_s3_level = s3;
+    this->_switch_time = this->_hal->now();
 }
 
-uint8_t TCS3200::read_red() {
-    this->select_filter(TCS3200_COLOR_RED);
+bool TCS3200::settled() {
+    return this->_hal->now() - this->_switch_time >=
+        this->_settling_times[this->_frequency_scaling & 0x03];
+}
 
-    uint8_t red = pulseIn(this->_out_pin, LOW);
-    red = this->is_calibrated ?
-        map(red, this->min_r, this->max_r, 255, 0) :
-        map(red, 0, 255, 255, 0);
+uint32_t TCS3200::edge_pulse_width(uint32_t edges, uint32_t periods,
+    uint32_t span, uint32_t elapsed) {
+    // Half the mean period between the first and last timestamped edge,
+    // which leaves out the partial period the gate opened in
+    if(periods > 0 && span > 0)
+        return span / (2 * periods);
 
-    return red;
+    // Without whole periods the edges are only bounded by the gate
+    return edges > 0 ? elapsed / (2 * edges) : 0;
 }
 
-uint8_t TCS3200::read_green() {
-    this->select_filter(TCS3200_COLOR_GREEN);
+uint32_t TCS3200::read_raw(uint8_t filter) {
+    this->abort_scan();
+    this->select_filter(filter);
+
+    while(!this->settled());
+
+    TCS3200_STAT(uint32_t start = this->_hal->now());
+    uint32_t raw = this->_hal->pulse_in(this->_out_pin, LOW,
+        this->deadline(this->_frequency_scaling));
+    TCS3200_STAT(this->record_acquisition(filter, this->_hal->now() - start, raw == 0));
 
-    uint8_t green = pulseIn(this->_out_pin, LOW);
-    green = this->is_calibrated ?
-        map(green, this->min_g, this->max_g, 255, 0) :
-        map(green, 0, 255, 255, 0);
+    if(raw == 0)
+        this->_status |= TCS3200_STATUS_TIMEOUT;
 
-    return green;
+    return raw;
 }
 
-uint8_t TCS3200::read_blue() {
-    this->select_filter(TCS3200_COLOR_BLUE);
+uint8_t TCS3200::normalize(uint8_t channel, uint32_t raw) {
+    uint8_t value;
+
+    if(this->is_calibrated) {
+        uint32_t min_raw, max_raw, scale;
+
+        switch(channel) {
+            case TCS3200_COLOR_RED:
+                min_raw = this->min_r, max_raw = this->max_r, scale = this->_scale_r;
+                break;
+            case TCS3200_COLOR_GREEN:
+                min_raw = this->min_g, max_raw = this->max_g, scale = this->_scale_g;
+                break;
+            case TCS3200_COLOR_BLUE:
+                min_raw = this->min_b, max_raw = this->max_b, scale = this->_scale_b;
+                break;
+            default:
+                min_raw = this->min_c, max_raw = this->max_c, scale = this->_scale_c;
+                break;
+        }
+
+        if(raw <= min_raw)
+            value = 255;
+        else if(raw >= max_raw)
+            value = 0;
+        else {
+            uint32_t range = max_raw - min_raw, delta = raw - min_raw;
+            uint32_t steps = (delta * scale) >> 16;
+
+            // The reciprocal is rounded down, so the product can fall
+            // one step short of the exact quotient (or more on ranges
+            // past 16 bits); a multiply and compare restores it
+            while((steps + 1) * range <= delta * 255)
+                steps++;
+
+            value = 255 - steps;
+        }
+
+        if(raw <= min_raw || raw >= max_raw) {
+            this->_status |= TCS3200_STATUS_SATURATED;
+            TCS3200_STAT(this->_stats.channels[channel & 0x03].saturated++);
+        }
+    }
+    else {
+        value = raw >= 255 ? 0 : 255 - raw;
+        TCS3200_STAT(if(raw >= 255) this->_stats.channels[channel & 0x03].saturated++);
+    }
+
+    if(!this->_curve_enabled)
+        return value;
 
-    uint8_t blue = pulseIn(this->_out_pin, LOW);
-    blue = this->is_calibrated ?
-        map(blue, this->min_b, this->max_b, 255, 0) :
-        map(blue, 0, 255, 255, 0);
+    // Points are 16 apart except the last segment, which spans 240-255
+    uint8_t index = value >> 4, fraction = value & 0x0f;
+    int16_t rise = (int16_t) this->_curve[index + 1] - this->_curve[index];
 
-    return blue;
+    return this->_curve[index] + (index < 15 ?
+        (rise * fraction) >> 4 :
+        (rise * fraction) / 15);
 }
 
-uint8_t TCS3200::read_clear() {
-    this->select_filter(TCS3200_COLOR_CLEAR);
-    return pulseIn(this->_out_pin, LOW);
+void TCS3200::update_normalization() {
+    this->_scale_r = this->max_r > this->min_r ? (255UL << 16) / (this->max_r - this->min_r) : 0;
+    this->_scale_g = this->max_g > this->min_g ? (255UL << 16) / (this->max_g - this->min_g) : 0;
+    this->_scale_b = this->max_b > this->min_b ? (255UL << 16) / (this->max_b - this->min_b) : 0;
+    this->_scale_c = this->max_c > this->min_c ? (255UL << 16) / (this->max_c - this->min_c) : 0;
 }
 
-void TCS3200::calibrate() {
-    this->is_calibrated = true;
+void TCS3200::linearization(float gamma) {
+    for(uint8_t i = 0; i < TCS3200_CURVE_POINTS; i++) {
+        float x = i == TCS3200_CURVE_POINTS - 1 ? 1.0f : (i * 16) / 255.0f;
+        this->_curve[i] = (uint8_t) (pow(x, gamma) * 255.0f + 0.5f);
+    }
+
+    this->_curve_enabled = true;
 }
 
-void TCS3200::calibrate_light() {
-    uint8_t r = 0, g = 0, b = 0, c = 0;
+void TCS3200::linearization(const uint8_t curve[TCS3200_CURVE_POINTS]) {
+    for(uint8_t i = 0; i < TCS3200_CURVE_POINTS; i++)
+        this->_curve[i] = curve[i];
 
-    for(int i = 0; i < 10; i++) {
-        r += this->read_red();
-        g += this->read_green();
-        b += this->read_blue();
+    this->_curve_enabled = true;
+}
 
-        delay(this->_integration_time / 10);
-    }
+void TCS3200::clear_linearization() {
+    this->_curve_enabled = false;
+}
 
-    this->white_balance_rgb.red = this->min_r = r / 10;
-    this->white_balance_rgb.green = this->min_g = g / 10;
-    this->white_balance_rgb.blue = this->min_b = b / 10;
+uint32_t TCS3200::read_raw_red() {
+    return this->read_raw(TCS3200_COLOR_RED);
 }
 
-void TCS3200::calibrate_dark() {
-    uint8_t r = 0, g = 0, b = 0, c = 0;
+uint32_t TCS3200::read_raw_green() {
+    return this->read_raw(TCS3200_COLOR_GREEN);
+}
+
+uint32_t TCS3200::read_raw_blue() {
+    return this->read_raw(TCS3200_COLOR_BLUE);
+}
+
+uint32_t TCS3200::read_raw_clear() {
+    return this->read_raw(TCS3200_COLOR_CLEAR);
+}
 
-    for(int i = 0; i < 10; i++) {
-        r += this->read_red();
-        g += this->read_green();
-        b += this->read_blue();
-        c += this->read_clear();
+RawRGBC TCS3200::read_raw_rgbc() {
+    const uint8_t *order = tcs3200_channel_orders[this->_channel_order];
+    uint32_t values[4];
 
-        delay(this->_integration_time / 10);
-    }
+    RawRGBC readings;
+    readings.timestamp = this->_hal->now();
 
-    this->max_r = r / 10;
-    this->max_g = g / 10;
-    this->max_b = b / 10;
+    for(uint8_t i = 0; i < 4; i++)
+        values[order[i]] = this->read_raw(order[i]);
+
+    readings.red = values[TCS3200_COLOR_RED];
+    readings.green = values[TCS3200_COLOR_GREEN];
+    readings.blue = values[TCS3200_COLOR_BLUE];
+    readings.clear = values[TCS3200_COLOR_CLEAR];
+    readings.scaling = this->_frequency_scaling;
+    readings.valid = (readings.red > 0 ? 1 << TCS3200_COLOR_RED : 0) |
+        (readings.green > 0 ? 1 << TCS3200_COLOR_GREEN : 0) |
+        (readings.blue > 0 ? 1 << TCS3200_COLOR_BLUE : 0) |
+        (readings.clear > 0 ? 1 << TCS3200_COLOR_CLEAR : 0);
+
+    if(this->_auto_range)
+        this->range_frame(readings);
+
+    return readings;
 }
 
-void TCS3200::integration_time(unsigned int time) {
-    this->_integration_time = time;
+uint8_t TCS3200::read_red() {
+    return this->normalize(TCS3200_COLOR_RED,
+        this->apply_filters(TCS3200_COLOR_RED, this->read_scaled(TCS3200_COLOR_RED), false));
 }
 
-unsigned int TCS3200::integration_time() {
-    return this->_integration_time;
+uint8_t TCS3200::read_green() {
+    return this->normalize(TCS3200_COLOR_GREEN,
+        this->apply_filters(TCS3200_COLOR_GREEN, this->read_scaled(TCS3200_COLOR_GREEN), false));
 }
 
-void TCS3200::frequency_scaling(int scaling) {
-    this->_frequency_scaling = scaling;
+uint8_t TCS3200::read_blue() {
+    return this->normalize(TCS3200_COLOR_BLUE,
+        this->apply_filters(TCS3200_COLOR_BLUE, this->read_scaled(TCS3200_COLOR_BLUE), false));
+}
 
-    switch(this->_frequency_scaling) {
-        case TCS3200_PWR_DOWN:
-            digitalWrite(this->_s0_pin, LOW);
-            digitalWrite(this->_s1_pin, LOW);
-            break;
-        case TCS3200_OFREQ_2P:
-            digitalWrite(this->_s0_pin, LOW);
-            digitalWrite(this->_s1_pin, HIGH);
-            break;
-        case TCS3200_OFREQ_20P:
-            digitalWrite(this->_s0_pin, HIGH);
-            digitalWrite(this->_s1_pin, LOW);
-            break;
-        case TCS3200_OFREQ_100P:
-            digitalWrite(this->_s0_pin, HIGH);
-            digitalWrite(this->_s1_pin, HIGH);
-            break;
+uint8_t TCS3200::read_clear() {
+    return this->normalize(TCS3200_COLOR_CLEAR,
+        this->apply_filters(TCS3200_COLOR_CLEAR, this->read_scaled(TCS3200_COLOR_CLEAR), false));
+}
+
+bool TCS3200::start_measurement(uint8_t filter) {
+    // The loop() scan owns the edge counter while it samples
+    if(this->sampling_needed())
+        return false;
+
+    this->abort_scan();
+    this->select_filter(filter);
+    this->begin_counting();
+
+    return this->_measuring;
+}
+
+void TCS3200::begin_counting() {
+    this->_measuring = this->_counter.attach(this->_out_pin);
+    this->_measurement_start = this->_hal->now();
+
+    // A pin without interrupt measures nothing, not the last result
+    if(!this->_measuring) {
+        this->_measurement_edges = 0;
+        this->_measurement_periods = 0;
+        this->_measurement_span = 0;
+        this->_measurement_elapsed = 0;
     }
 }
 
-int TCS3200::frequency_scaling() {
-    return this->_frequency_scaling;
+bool TCS3200::poll_measurement() {
+    if(!this->_measuring)
+        return true;
+
+    uint32_t elapsed = this->_hal->now() - this->_measurement_start;
+
+    // The poll at gate close timestamps the final edge
+    this->_counter.poll();
+    if(elapsed < this->_gate_time)
+        return false;
+
+    this->_measurement_edges = this->_counter.count(&this->_measurement_span,
+        &this->_measurement_periods);
+    this->_measurement_elapsed = elapsed;
+    this->_counter.detach();
+    this->_measuring = false;
+
+    return true;
 }
 
-void TCS3200::white_balance(RGBColor white_balance_rgb) {
-    this->white_balance_rgb = white_balance_rgb;
+uint32_t TCS3200::measurement_frequency() {
+    if(this->_measurement_periods > 0 && this->_measurement_span > 0)
+        return (uint32_t) (((uint64_t) this->_measurement_periods * 1000000UL) /
+            this->_measurement_span);
+
+    if(this->_measurement_elapsed == 0)
+        return 0;
+
+    return (uint32_t) (((uint64_t) this->_measurement_edges * 1000000UL) /
+        this->_measurement_elapsed);
 }
 
-RGBColor TCS3200::white_balance() {
-    return this->white_balance_rgb;
+void TCS3200::calibrate() {
+    this->update_normalization();
+    this->is_calibrated = true;
 }
 
-RGBColor TCS3200::read_rgb_color() {
-    RGBColor readings;
-    readings.red = this->read_red();
-    readings.green = this->read_green();
-    readings.blue = this->read_blue();
+void TCS3200::calibrate_light() {
+    this->start_calibration(TCS3200_CAL_LIGHT);
 
-    return readings;
+    while(this->_cal_active)
+        this->accumulate_calibration(this->read_raw_rgbc());
 }
 
-HSVColor TCS3200::read_hsv() {
-    HSVColor hsv_color;
+void TCS3200::calibrate_dark() {
+    this->start_calibration(TCS3200_CAL_DARK);
 
-    float r = this->read_red() / 255.0;
-    float g = this->read_green() / 255.0;
-    float b = this->read_blue() / 255.0;
+    while(this->_cal_active)
+        this->accumulate_calibration(this->read_raw_rgbc());
+}
 
-    r = r * (this->white_balance_rgb.red > 0 ? (this->white_balance_rgb.red / 255.0) : 1.0);
-    g = g * (this->white_balance_rgb.green > 0 ? (this->white_balance_rgb.green / 255.0) : 1.0);
-    b = b * (this->white_balance_rgb.blue > 0 ? (this->white_balance_rgb.blue / 255.0) : 1.0);
+void TCS3200::calibration_samples(uint8_t samples) {
+    this->_cal_samples = samples > 0 ? samples : 1;
+}
 
-    float max_val = max(r, max(g, b));
-    hsv_color.value = max_val;
+uint8_t TCS3200::calibration_samples() {
+    return this->_cal_samples;
+}
 
-    float min_val = min(r, min(g, b));
-    float delta = max_val - min_val;
-    hsv_color.saturation = (max_val > 0.0) ? delta / max_val : 0.0;
+void TCS3200::calibration_callback(void (*callback)(uint8_t target, uint8_t collected, uint8_t total)) {
+    this->calibration_progress_callback = callback;
+}
+
+void TCS3200::start_calibration(uint8_t target) {
+    this->_cal_target = target;
+    this->_cal_collected = 0;
+    this->_cal_active = true;
+
+    for(uint8_t i = 0; i < 4; i++) {
+        this->_cal_sum[i] = 0;
+        this->_cal_min[i] = 0xffffffff;
+        this->_cal_max[i] = 0;
+        this->_cal_mean[i] = 0.0f;
+        this->_cal_m2[i] = 0.0f;
+    }
+}
+
+bool TCS3200::calibrating() {
+    return this->_cal_active;
+}
 
-    if(delta > 0.0) {
-        hsv_color.hue = max_val == r ? (g - b) / delta : (max_val == g ? 2.0 + (b - r) / delta : 4.0 + (r - g) /delta);
-        hsv_color.hue *= 60.0;
+CalibrationStats TCS3200::calibration_stats() {
+    return this->_cal_stats;
+}
 
-        if(hsv_color.hue < 0.0)
-            hsv_color.hue += 360.0;
+void TCS3200::accumulate_calibration(RawRGBC frame) {
+    uint32_t values[4] = {
+        this->rescale(frame.red, frame.scaling),
+        this->rescale(frame.green, frame.scaling),
+        this->rescale(frame.blue, frame.scaling),
+        this->rescale(frame.clear, frame.scaling)
+    };
+    this->_cal_collected++;
+
+    for(uint8_t i = 0; i < 4; i++) {
+        this->_cal_sum[i] += values[i];
+        this->_cal_min[i] = min(this->_cal_min[i], values[i]);
+        this->_cal_max[i] = max(this->_cal_max[i], values[i]);
+
+        // Welford's online variance
+        float delta = values[i] - this->_cal_mean[i];
+        this->_cal_mean[i] += delta / this->_cal_collected;
+        this->_cal_m2[i] += delta * (values[i] - this->_cal_mean[i]);
     }
-    else hsv_color.hue = 0.0;
 
-    return hsv_color;
+    if(this->_cal_collected >= this->_cal_samples)
+        this->finish_calibration();
+
+    if(this->calibration_progress_callback != nullptr)
+        this->calibration_progress_callback(this->_cal_target, this->_cal_collected, this->_cal_samples);
 }
 
-CMYKColor TCS3200::read_cmyk() {
-    float r = this->read_red() / 255.0;
-    float g = this->read_green() / 255.0;
-    float b = this->read_blue() / 255.0;
+void TCS3200::finish_calibration() {
+    uint32_t means[4];
+    float variances[4];
+
+    for(uint8_t i = 0; i < 4; i++) {
+        // Drop the lowest and highest sample once there are enough to spare
+        means[i] = this->_cal_collected > 2 ?
+            (this->_cal_sum[i] - this->_cal_min[i] - this->_cal_max[i]) / (this->_cal_collected - 2) :
+            this->_cal_sum[i] / this->_cal_collected;
+        variances[i] = this->_cal_collected > 1 ?
+            this->_cal_m2[i] / (this->_cal_collected - 1) : 0.0f;
+    }
 
-    float c = 1.0 - r;
-    float m = 1.0 - g;
-    float y = 1.0 - b;
-    float k = min(c, min(m, y));
+    this->_cal_stats.red = means[0];
+    this->_cal_stats.green = means[1];
+    this->_cal_stats.blue = means[2];
+    this->_cal_stats.clear = means[3];
+    this->_cal_stats.red_variance = variances[0];
+    this->_cal_stats.green_variance = variances[1];
+    this->_cal_stats.blue_variance = variances[2];
+    this->_cal_stats.clear_variance = variances[3];
+    this->_cal_stats.samples = this->_cal_collected;
+
+    if(this->_cal_target == TCS3200_CAL_LIGHT) {
+        this->min_r = means[0];
+        this->min_g = means[1];
+        this->min_b = means[2];
+        this->min_c = means[3];
+
+        // Normalization maps the light target to 255, so in normalized
+        // units the white balance is a gain of one on every channel
+        this->white_balance_rgb.red = 255;
+        this->white_balance_rgb.green = 255;
+        this->white_balance_rgb.blue = 255;
+    }
+    else {
+        this->max_r = means[0];
+        this->max_g = means[1];
+        this->max_b = means[2];
+        this->max_c = means[3];
+    }
 
-    c = (c - k) / (1.0 - k);
-    m = (m - k) / (1.0 - k);
-    y = (y - k) / (1.0 - k);
+    this->update_normalization();
+    this->_cal_active = false;
+}
 
-    CMYKColor cmyk_color;
-    cmyk_color.cyan = c;
-    cmyk_color.magenta = m;
-    cmyk_color.yellow = y;
-    cmyk_color.black = k;
+static uint8_t *tcs3200_put_u32(uint8_t *buffer, uint32_t value) {
+    for(uint8_t i = 0; i < 4; i++)
+        *buffer++ = (value >> (i * 8)) & 0xff;
 
-    return cmyk_color;
+    return buffer;
 }
 
-CIE1931Color TCS3200::read_cie1931() {
-    uint8_t red = this->read_red();
-    uint8_t green = this->read_green();
-    uint8_t blue = this->read_blue();
+static const uint8_t *tcs3200_get_u32(const uint8_t *buffer, uint32_t *value) {
+    *value = 0;
+    for(uint8_t i = 0; i < 4; i++)
+        *value |= (uint32_t) *buffer++ << (i * 8);
 
-    red = red * (this->white_balance_rgb.red > 0 ? (this->white_balance_rgb.red / 255.0) : 1.0);
-    green = green * (this->white_balance_rgb.green > 0 ? (this->white_balance_rgb.green / 255.0) : 1.0);
-    blue = blue * (this->white_balance_rgb.blue > 0 ? (this->white_balance_rgb.blue / 255.0) : 1.0);
+    return buffer;
+}
 
-    float r = red / 255.0;
-    float g = green / 255.0;
-    float b = blue / 255.0;
+uint16_t TCS3200::crc16(const uint8_t *data, uint16_t length) {
+    uint16_t crc = 0xffff;
 
-    CIE1931Color cie1931_color;
-    cie1931_color.x = 0.4124564 * r + 0.3575761 * g + 0.1804375 * b;
-    cie1931_color.y = 0.2126729 * r + 0.7151522 * g + 0.0721750 * b;
-    cie1931_color.z = 0.0193339 * r + 0.1191920 * g + 0.9503041 * b;
+    while(length--) {
+        crc ^= (uint16_t) *data++ << 8;
 
-    return cie1931_color;
+        for(uint8_t i = 0; i < 8; i++)
+            crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+
+    return crc;
 }
 
-float TCS3200::get_chroma() {
-    CIE1931Color cie1931_color = this->read_cie1931();
+bool TCS3200::save_calibration(TCS3200Storage &storage, uint16_t address) {
+    uint8_t profile[TCS3200_CALIBRATION_SIZE];
+    uint8_t *cursor = profile;
+
+    *cursor++ = 'T';
+    *cursor++ = 'C';
+    *cursor++ = TCS3200_CALIBRATION_VERSION;
+    *cursor++ = this->is_calibrated ? 0x01 : 0x00;
+    *cursor++ = (uint8_t) this->_calibration_scaling;
+
+    cursor = tcs3200_put_u32(cursor, this->min_r);
+    cursor = tcs3200_put_u32(cursor, this->min_g);
+    cursor = tcs3200_put_u32(cursor, this->min_b);
+    cursor = tcs3200_put_u32(cursor, this->min_c);
+    cursor = tcs3200_put_u32(cursor, this->max_r);
+    cursor = tcs3200_put_u32(cursor, this->max_g);
+    cursor = tcs3200_put_u32(cursor, this->max_b);
+    cursor = tcs3200_put_u32(cursor, this->max_c);
+
+    *cursor++ = this->white_balance_rgb.red;
+    *cursor++ = this->white_balance_rgb.green;
+    *cursor++ = this->white_balance_rgb.blue;
+
+    uint16_t crc = TCS3200::crc16(profile, TCS3200_CALIBRATION_SIZE - 2);
+    *cursor++ = crc & 0xff;
+    *cursor++ = crc >> 8;
+
+    return storage.write(address, profile, TCS3200_CALIBRATION_SIZE);
+}
+
+bool TCS3200::load_calibration(TCS3200Storage &storage, uint16_t address) {
+    uint8_t profile[TCS3200_CALIBRATION_SIZE];
+    if(!storage.read(address, profile, TCS3200_CALIBRATION_SIZE))
+        return false;
+
+    uint16_t crc = profile[TCS3200_CALIBRATION_SIZE - 2] |
+        (uint16_t) profile[TCS3200_CALIBRATION_SIZE - 1] << 8;
+    if(profile[0] != 'T' || profile[1] != 'C' ||
+        profile[2] != TCS3200_CALIBRATION_VERSION ||
+        crc != TCS3200::crc16(profile, TCS3200_CALIBRATION_SIZE - 2))
+        return false;
+
+    const uint8_t *cursor = profile + 3;
+    this->is_calibrated = *cursor++ & 0x01;
+    this->_calibration_scaling = *cursor;
+    this->apply_scaling(*cursor++);
+
+    cursor = tcs3200_get_u32(cursor, &this->min_r);
+    cursor = tcs3200_get_u32(cursor, &this->min_g);
+    cursor = tcs3200_get_u32(cursor, &this->min_b);
+    cursor = tcs3200_get_u32(cursor, &this->min_c);
+    cursor = tcs3200_get_u32(cursor, &this->max_r);
+    cursor = tcs3200_get_u32(cursor, &this->max_g);
+    cursor = tcs3200_get_u32(cursor, &this->max_b);
+    cursor = tcs3200_get_u32(cursor, &this->max_c);
+
+    this->white_balance_rgb.red = *cursor++;
+    this->white_balance_rgb.green = *cursor++;
+    this->white_balance_rgb.blue = *cursor++;
+
+    this->update_normalization();
+    return true;
+}
 
-    float dx = cie1931_color.x - 0.95047;
-    float dy = cie1931_color.y - 1.0;
-    float dz = cie1931_color.z - 1.08883;
+void TCS3200::integration_time(unsigned int time) {
+    this->_integration_time = time;
 
-    return sqrt(dx * dx + dy * dy + dz * dz);
+    if(!this->_auto_range)
+        this->_gate_time = time;
 }
 
-uint8_t TCS3200::get_rgb_dominant_color() {
-    RGBColor color = this->read_rgb_color();
+unsigned int TCS3200::integration_time() {
+    return this->_integration_time;
+}
 
-    uint8_t max_color = max(color.red, max(color.green, color.blue));
-    if(max_color == color.red)
-        return TCS3200_COLOR_RED;
-    else if(max_color == color.green)
-        return TCS3200_COLOR_GREEN;
+void TCS3200::frequency_scaling(int scaling) {
+    this->apply_scaling(scaling);
 
-    return TCS3200_COLOR_BLUE;
+    if(!this->is_calibrated)
+        this->_calibration_scaling = scaling;
 }
 
-void TCS3200::upper_bound_interrupt(RGBColor threshold, void (*callback)()) {
-    this->upper_bound_interrupt_callback = callback;
-    this->ub_threshold = threshold;
+int TCS3200::frequency_scaling() {
+    return this->_frequency_scaling;
 }
 
-void TCS3200::lower_bound_interrupt(RGBColor threshold, void (*callback)()) {
-    this->lower_bound_interrupt_callback = callback;
-    this->lb_threshold = threshold;
+void TCS3200::auto_range(bool enabled) {
+    this->_auto_range = enabled;
+
+    if(!enabled)
+        this->_gate_time = this->_integration_time;
 }
 
-void TCS3200::clear_upper_bound_interrupt() {
-    this->upper_bound_interrupt_callback = nullptr;
+bool TCS3200::auto_range() {
+    return this->_auto_range;
 }
 
-void TCS3200::clear_lower_bound_interrupt() {
-    this->lower_bound_interrupt_callback = nullptr;
+static const uint8_t tcs3200_scaling_percent[4] = {0, 2, 20, 100};
+
+void TCS3200::read_timeout(uint32_t time) {
+    this->_read_timeout = time;
 }
 
-void TCS3200::loop() {
-    if(this->upper_bound_interrupt_callback == nullptr &&
-        this->lower_bound_interrupt_callback == nullptr)
-        return;
+uint32_t TCS3200::read_timeout() {
+    return this->deadline(this->_frequency_scaling);
+}
 
-    RGBColor current_reading = this->read_rgb_color();
-    if(this->upper_bound_interrupt_callback != nullptr &&
-        current_reading.red > this->ub_threshold.red &&
-        current_reading.green > this->ub_threshold.green &&
-        current_reading.blue > this->ub_threshold.blue)
-        this->upper_bound_interrupt_callback();
+uint8_t TCS3200::status() {
+    uint8_t status = this->_status;
+    this->_status = TCS3200_STATUS_OK;
 
-    if(this->lower_bound_interrupt_callback != nullptr &&
-        current_reading.red < this->lb_threshold.red &&
-        current_reading.green < this->lb_threshold.green &&
-        current_reading.blue < this->lb_threshold.blue)
-        this->lower_bound_interrupt_callback();
+    return status;
+}
+
+uint32_t TCS3200::deadline(uint8_t scaling) {
+    if(this->_read_timeout > 0)
+        return this->_read_timeout;
+
+    uint8_t percent = tcs3200_scaling_percent[scaling & 0x03];
+    return percent > 0 ?
+        (uint32_t) this->_integration_time * 100 / percent :
+        this->_integration_time;
+}
+
+uint32_t TCS3200::rescale(uint32_t raw, uint8_t scaling) {
+    // A missing pulse is at least as long as the deadline
+    if(raw == 0)
+        raw = this->deadline(scaling);
+
+    uint8_t from = tcs3200_scaling_percent[scaling & 0x03];
+    uint8_t to = tcs3200_scaling_percent[this->_calibration_scaling & 0x03];
+
+    if(from == to || from == 0 || to == 0)
+        return raw;
+
+    // Pulse widths are inversely proportional to the output frequency
+    return (raw * from + to / 2) / to;
+}
+
+uint32_t TCS3200::read_scaled(uint8_t channel) {
+    uint8_t scaling = this->_frequency_scaling;
+    uint32_t raw = this->read_raw(channel);
+
+    if(this->_auto_range && scaling != TCS3200_PWR_DOWN) {
+        if((raw == 0 || raw > TCS3200_AUTO_RANGE_MAX_PULSE) && scaling < TCS3200_OFREQ_100P)
+            this->apply_scaling(scaling + 1);
+        else if(raw > 0 && raw < TCS3200_AUTO_RANGE_MIN_PULSE && scaling > TCS3200_OFREQ_2P)
+            this->apply_scaling(scaling - 1);
+    }
+
+    return this->rescale(raw, scaling);
+}
+
+void TCS3200::range_frame(const RawRGBC &frame) {
+    if(frame.scaling == TCS3200_PWR_DOWN)
+        return;
+
+    uint32_t pulses[4] = {frame.red, frame.green, frame.blue, frame.clear};
+    uint32_t shortest = 0xffffffff, longest = 0;
+
+    for(uint8_t i = 0; i < 4; i++) {
+        // A missing pulse means the channel was too dark to be measured
+        uint32_t pulse = pulses[i] > 0 ? pulses[i] : 0xffffffff;
+
+        shortest = min(shortest, pulse);
+        longest = max(longest, pulse);
+    }
+
+    uint8_t scaling = frame.scaling;
+    if(shortest < TCS3200_AUTO_RANGE_MIN_PULSE && scaling > TCS3200_OFREQ_2P)
+        scaling--;
+    else if(longest > TCS3200_AUTO_RANGE_MAX_PULSE && scaling < TCS3200_OFREQ_100P &&
+        shortest / (tcs3200_scaling_percent[scaling + 1] / tcs3200_scaling_percent[scaling]) >=
+            TCS3200_AUTO_RANGE_MIN_PULSE)
+        scaling++;
+
+    // Size the gate to count enough edges of the darkest channel at the new scaling
+    uint32_t darkest = min(longest, (uint32_t) TCS3200_AUTO_RANGE_MAX_GATE) *
+        tcs3200_scaling_percent[frame.scaling] / tcs3200_scaling_percent[scaling];
+    this->_gate_time = min(darkest * 2 * TCS3200_AUTO_RANGE_EDGES,
+        (uint32_t) TCS3200_AUTO_RANGE_MAX_GATE);
+
+    if(scaling != this->_frequency_scaling)
+        this->apply_scaling(scaling);
+}
+
+void TCS3200::apply_scaling(int scaling) {
+    // A frame being scanned would mix scalings, so start it over
+    if(scaling != this->_frequency_scaling && this->_scan_channel != 0) {
+        this->abort_scan();
+        this->_scan_channel = 0;
+    }
+
+    this->_frequency_scaling = scaling;
+
+    switch(this->_frequency_scaling) {
+        case TCS3200_PWR_DOWN:
+            this->_hal->digital_write_pair(this->_s0_pin, LOW, this->_s1_pin, LOW);
+            break;
+        case TCS3200_OFREQ_2P:
+            this->_hal->digital_write_pair(this->_s0_pin, LOW, this->_s1_pin, HIGH);
+            break;
+        case TCS3200_OFREQ_20P:
+            this->_hal->digital_write_pair(this->_s0_pin, HIGH, this->_s1_pin, LOW);
+            break;
+        case TCS3200_OFREQ_100P:
+            this->_hal->digital_write_pair(this->_s0_pin, HIGH, this->_s1_pin, HIGH);
+            break;
+    }
+
+    this->_switch_time = this->_hal->now();
+}
+
+void TCS3200::white_balance(RGBColor white_balance_rgb) {
+    this->white_balance_rgb = white_balance_rgb;
+}
+
+RGBColor TCS3200::white_balance() {
+    return this->white_balance_rgb;
+}
+
+RGBColor TCS3200::read_rgb_color() {
+    return this->apply_white_balance(this->read_uncorrected_rgb_color());
+}
+
+RGBColor TCS3200::read_uncorrected_rgb_color() {
+    RGBColor readings;
+    readings.red = this->read_red();
+    readings.green = this->read_green();
+    readings.blue = this->read_blue();
+
+    return readings;
+}
+
+RGBCColor TCS3200::read_rgbc_color() {
+    RGBCColor readings = this->normalize_frame(this->read_raw_rgbc());
+
+    RGBColor balanced;
+    balanced.red = readings.red;
+    balanced.green = readings.green;
+    balanced.blue = readings.blue;
+    balanced = this->apply_white_balance(balanced);
+
+    readings.red = balanced.red;
+    readings.green = balanced.green;
+    readings.blue = balanced.blue;
+
+    return readings;
+}
+
+RGBCColor TCS3200::normalize_frame(const RawRGBC &frame) {
+    RGBCColor readings;
+
+    readings.red = this->normalize(TCS3200_COLOR_RED,
+        this->apply_filters(TCS3200_COLOR_RED, this->rescale(frame.red, frame.scaling), false));
+    readings.green = this->normalize(TCS3200_COLOR_GREEN,
+        this->apply_filters(TCS3200_COLOR_GREEN, this->rescale(frame.green, frame.scaling), false));
+    readings.blue = this->normalize(TCS3200_COLOR_BLUE,
+        this->apply_filters(TCS3200_COLOR_BLUE, this->rescale(frame.blue, frame.scaling), false));
+    readings.clear = this->normalize(TCS3200_COLOR_CLEAR,
+        this->apply_filters(TCS3200_COLOR_CLEAR, this->rescale(frame.clear, frame.scaling), false));
+
+    return readings;
+}
+
+static void tcs3200_compensate_ir(float *frequencies) {
+    // Infrared reaches all photodiode types, so the colored ones count it
+    // three times while the clear ones count it once
+    float ir = (frequencies[0] + frequencies[1] + frequencies[2] - frequencies[3]) / 2.0f;
+    if(ir <= 0.0f)
+        return;
+
+    for(uint8_t i = 0; i < 4; i++)
+        frequencies[i] = max(frequencies[i] - ir, 0.0f);
+}
+
+RGBColor TCS3200::read_chromaticity() {
+    RawRGBC frame = this->read_raw_rgbc();
+    uint32_t pulses[4] = {
+        this->rescale(frame.red, frame.scaling),
+        this->rescale(frame.green, frame.scaling),
+        this->rescale(frame.blue, frame.scaling),
+        this->rescale(frame.clear, frame.scaling)
+    };
+
+    const uint32_t white[4] = {this->min_r, this->min_g, this->min_b, this->min_c};
+    const uint32_t dark[4] = {this->max_r, this->max_g, this->max_b, this->max_c};
+    float sample[4], reference[4];
+
+    // Frequencies are relative; the 2x of the half period cancels out in the ratios
+    for(uint8_t i = 0; i < 4; i++) {
+        sample[i] = pulses[i] > 0 ? 1.0f / pulses[i] : 0.0f;
+        reference[i] = 1.0f;
+
+        if(this->is_calibrated) {
+            float offset = dark[i] > 0 ? 1.0f / dark[i] : 0.0f;
+
+            sample[i] = max(sample[i] - offset, 0.0f);
+            reference[i] = white[i] > 0 ? max(1.0f / white[i] - offset, 0.0f) : 0.0f;
+        }
+    }
+
+    if(this->_ir_compensation) {
+        tcs3200_compensate_ir(sample);
+
+        if(this->is_calibrated)
+            tcs3200_compensate_ir(reference);
+    }
+
+    uint8_t values[3];
+    for(uint8_t i = 0; i < 3; i++) {
+        float ratio = 0.0f;
+        if(sample[3] > 0.0f && reference[i] > 0.0f)
+            ratio = (sample[i] / sample[3]) * (reference[3] / reference[i]);
+
+        values[i] = ratio >= 1.0f ? 255 : (uint8_t) (ratio * 255.0f + 0.5f);
+    }
+
+    RGBColor readings;
+    readings.red = values[0];
+    readings.green = values[1];
+    readings.blue = values[2];
+
+    return readings;
+}
+
+void TCS3200::ir_compensation(bool enabled) {
+    this->_ir_compensation = enabled;
+}
+
+bool TCS3200::ir_compensation() {
+    return this->_ir_compensation;
+}
+
+void TCS3200::channel_order(uint8_t order) {
+    this->_channel_order = order == TCS3200_ORDER_GRAY ?
+        TCS3200_ORDER_GRAY : TCS3200_ORDER_RGBC;
+
+    // Restart the frame being scanned in the new order
+    this->abort_scan();
+    this->_scan_channel = 0;
+}
+
+uint8_t TCS3200::channel_order() {
+    return this->_channel_order;
+}
+
+RGBColor TCS3200::apply_white_balance(RGBColor color) {
+    RGBColor balanced;
+
+    if(this->_color_correction) {
+        const int32_t input[3] = {color.red, color.green, color.blue};
+        uint8_t output[3];
+
+        // Q16.16 multiply-accumulate; the clamped coefficients keep it in range
+        for(uint8_t i = 0; i < 3; i++) {
+            int32_t value = (this->_correction[i][0] * input[0] +
+                this->_correction[i][1] * input[1] +
+                this->_correction[i][2] * input[2] +
+                this->_correction[i][3] + 32768L) >> 16;
+
+            output[i] = value < 0 ? 0 : (value > 255 ? 255 : (uint8_t) value);
+        }
+
+        balanced.red = output[0];
+        balanced.green = output[1];
+        balanced.blue = output[2];
+
+        return balanced;
+    }
+
+    balanced.red = this->white_balance_rgb.red > 0 ?
+        ((uint16_t) color.red * this->white_balance_rgb.red + 127) / 255 :
+        color.red;
+    balanced.green = this->white_balance_rgb.green > 0 ?
+        ((uint16_t) color.green * this->white_balance_rgb.green + 127) / 255 :
+        color.green;
+    balanced.blue = this->white_balance_rgb.blue > 0 ?
+        ((uint16_t) color.blue * this->white_balance_rgb.blue + 127) / 255 :
+        color.blue;
+
+    return balanced;
+}
+
+bool TCS3200::fit_color_correction(const RGBColor *measured, const RGBColor *reference, uint8_t count) {
+    if(measured == nullptr || reference == nullptr || count < 4)
+        return false;
+
+    // Normal equations (X^T X) B = X^T Y with rows X = [r g b 1],
+    // augmented with the three right-hand sides
+    float system[4][7] = {{0.0f}};
+    for(uint8_t k = 0; k < count; k++) {
+        const float x[4] = {
+            (float) measured[k].red,
+            (float) measured[k].green,
+            (float) measured[k].blue,
+            1.0f
+        };
+        const float y[3] = {
+            (float) reference[k].red,
+            (float) reference[k].green,
+            (float) reference[k].blue
+        };
+
+        for(uint8_t i = 0; i < 4; i++) {
+            for(uint8_t j = 0; j < 4; j++)
+                system[i][j] += x[i] * x[j];
+
+            for(uint8_t j = 0; j < 3; j++)
+                system[i][4 + j] += x[i] * y[j];
+        }
+    }
+
+    float tolerance = 0.0f;
+    for(uint8_t i = 0; i < 4; i++)
+        tolerance = max(tolerance, system[i][i]);
+    tolerance *= 1e-6f;
+
+    // Gauss-Jordan elimination with partial pivoting
+    for(uint8_t column = 0; column < 4; column++) {
+        uint8_t pivot = column;
+        for(uint8_t row = column + 1; row < 4; row++)
+            if(fabs(system[row][column]) > fabs(system[pivot][column]))
+                pivot = row;
+
+        if(fabs(system[pivot][column]) <= tolerance)
+            return false;
+
+        if(pivot != column)
+            for(uint8_t j = 0; j < 7; j++) {
+                float swap = system[column][j];
+                system[column][j] = system[pivot][j];
+                system[pivot][j] = swap;
+            }
+
+        float scale = 1.0f / system[column][column];
+        for(uint8_t j = column; j < 7; j++)
+            system[column][j] *= scale;
+
+        for(uint8_t row = 0; row < 4; row++) {
+            if(row == column || system[row][column] == 0.0f)
+                continue;
+
+            float factor = system[row][column];
+            for(uint8_t j = column; j < 7; j++)
+                system[row][j] -= factor * system[column][j];
+        }
+    }
+
+    float matrix[3][4];
+    for(uint8_t i = 0; i < 3; i++)
+        for(uint8_t j = 0; j < 4; j++)
+            matrix[i][j] = system[j][4 + i];
+
+    this->color_correction(matrix);
+    return true;
+}
+
+void TCS3200::color_correction(const float matrix[3][4]) {
+    for(uint8_t i = 0; i < 3; i++)
+        for(uint8_t j = 0; j < 4; j++) {
+            float limit = j < 3 ? 32.0f : 512.0f;
+            float value = constrain(matrix[i][j], -limit, limit) * 65536.0f;
+
+            this->_correction[i][j] = (int32_t) (value < 0.0f ? value - 0.5f : value + 0.5f);
+        }
+
+    this->_color_correction = true;
+}
+
+bool TCS3200::color_correction() {
+    return this->_color_correction;
+}
+
+void TCS3200::clear_color_correction() {
+    this->_color_correction = false;
+}
+
+ColorSample TCS3200::read_sample() {
+    RGBCColor frame = this->normalize_frame(this->read_raw_rgbc());
+
+    RGBColor readings;
+    readings.red = frame.red;
+    readings.green = frame.green;
+    readings.blue = frame.blue;
+
+    return ColorSample(readings, this->apply_white_balance(readings), frame.clear);
+}
+
+HSVColor TCS3200::read_hsv() {
+    return TCS3200::rgb_to_hsv(this->read_rgb_color());
+}
+
+CMYKColor TCS3200::read_cmyk() {
+    return TCS3200::rgb_to_cmyk(this->read_rgb_color());
+}
+
+CIE1931Color TCS3200::read_cie1931() {
+    return TCS3200::rgb_to_cie1931(this->read_rgb_color());
+}
+
+CIELabColor TCS3200::read_cielab() {
+    return TCS3200::cie1931_to_cielab(this->read_cie1931());
+}
+
+float TCS3200::get_chroma() {
+    return TCS3200::cie1931_to_chroma(this->read_cie1931());
+}
+
+uint8_t TCS3200::get_rgb_dominant_color() {
+    return TCS3200::rgb_dominant_color(this->read_rgb_color());
+}
+
+HSVColor TCS3200::rgb_to_hsv(RGBColor color) {
+#if TCS3200_FIXED_POINT
+    HSVColorQ16 fixed = TCS3200::rgb_to_hsv_q16(color);
+
+    HSVColor hsv_color;
+    hsv_color.hue = fixed.hue * (1.0f / TCS3200_Q16_ONE);
+    hsv_color.saturation = fixed.saturation * (1.0f / TCS3200_Q16_ONE);
+    hsv_color.value = fixed.value * (1.0f / TCS3200_Q16_ONE);
+
+    return hsv_color;
+#else
+    HSVColor hsv_color;
+
+    float r = color.red / 255.0f;
+    float g = color.green / 255.0f;
+    float b = color.blue / 255.0f;
+
+    float max_val = max(r, max(g, b));
+    hsv_color.value = max_val;
+
+    float min_val = min(r, min(g, b));
+    float delta = max_val - min_val;
+    hsv_color.saturation = (max_val > 0.0f) ? delta / max_val : 0.0f;
+
+    if(delta > 0.0f) {
+        hsv_color.hue = max_val == r ? (g - b) / delta : (max_val == g ? 2.0f + (b - r) / delta : 4.0f + (r - g) / delta);
+        hsv_color.hue *= 60.0f;
+
+        if(hsv_color.hue < 0.0f)
+            hsv_color.hue += 360.0f;
+    }
+    else hsv_color.hue = 0.0f;
+
+    return hsv_color;
+#endif
+}
+
+CMYKColor TCS3200::rgb_to_cmyk(RGBColor color) {
+#if TCS3200_FIXED_POINT
+    CMYKColorQ16 fixed = TCS3200::rgb_to_cmyk_q16(color);
+
+    CMYKColor cmyk_color;
+    cmyk_color.cyan = fixed.cyan * (1.0f / TCS3200_Q16_ONE);
+    cmyk_color.magenta = fixed.magenta * (1.0f / TCS3200_Q16_ONE);
+    cmyk_color.yellow = fixed.yellow * (1.0f / TCS3200_Q16_ONE);
+    cmyk_color.black = fixed.black * (1.0f / TCS3200_Q16_ONE);
+
+    return cmyk_color;
+#else
+    float c = 1.0f - color.red / 255.0f;
+    float m = 1.0f - color.green / 255.0f;
+    float y = 1.0f - color.blue / 255.0f;
+    float k = min(c, min(m, y));
+
+    if(k < 1.0f) {
+        c = (c - k) / (1.0f - k);
+        m = (m - k) / (1.0f - k);
+        y = (y - k) / (1.0f - k);
+    }
+    else c = m = y = 0.0f;
+
+    CMYKColor cmyk_color;
+    cmyk_color.cyan = c;
+    cmyk_color.magenta = m;
+    cmyk_color.yellow = y;
+    cmyk_color.black = k;
+
+    return cmyk_color;
+#endif
+}
+
+CIE1931Color TCS3200::rgb_to_cie1931(RGBColor color) {
+#if TCS3200_FIXED_POINT
+    CIE1931ColorQ16 fixed = TCS3200::rgb_to_cie1931_q16(color);
+
+    CIE1931Color cie1931_color;
+    cie1931_color.x = fixed.x * (1.0f / TCS3200_Q16_ONE);
+    cie1931_color.y = fixed.y * (1.0f / TCS3200_Q16_ONE);
+    cie1931_color.z = fixed.z * (1.0f / TCS3200_Q16_ONE);
+
+    return cie1931_color;
+#else
+    float r = color.red / 255.0f;
+    float g = color.green / 255.0f;
+    float b = color.blue / 255.0f;
+
+    CIE1931Color cie1931_color;
+    cie1931_color.x = 0.4124564f * r + 0.3575761f * g + 0.1804375f * b;
+    cie1931_color.y = 0.2126729f * r + 0.7151522f * g + 0.0721750f * b;
+    cie1931_color.z = 0.0193339f * r + 0.1191920f * g + 0.9503041f * b;
+
+    return cie1931_color;
+#endif
+}
+
+HSVColorQ16 TCS3200::rgb_to_hsv_q16(RGBColor color) {
+    uint8_t max_val = max(color.red, max(color.green, color.blue));
+    uint8_t min_val = min(color.red, min(color.green, color.blue));
+    uint8_t delta = max_val - min_val;
+
+    HSVColorQ16 hsv_color;
+    hsv_color.value = TCS3200_Q16_FROM_8BIT(max_val);
+    hsv_color.hue = 0;
+    hsv_color.saturation = 0;
+
+    if(delta == 0)
+        return hsv_color;
+
+    // Q8.24 reciprocals, (255 << 24) still fits in 32 bits
+    hsv_color.saturation = ((uint32_t) delta * (TCS3200_Q24_ONE / max_val)) >> 8;
+
+    uint32_t delta_reciprocal = TCS3200_Q24_ONE / delta;
+    int16_t difference;
+    int32_t offset;
+
+    if(max_val == color.red) {
+        difference = (int16_t) color.green - color.blue;
+        offset = 0;
+    }
+    else if(max_val == color.green) {
+        difference = (int16_t) color.blue - color.red;
+        offset = 120 * TCS3200_Q16_ONE;
+    }
+    else {
+        difference = (int16_t) color.red - color.green;
+        offset = 240 * TCS3200_Q16_ONE;
+    }
+
+    int32_t sector = (int32_t) ((abs(difference) * delta_reciprocal) >> 8) * 60;
+    hsv_color.hue = offset + (difference < 0 ? -sector : sector);
+
+    if(hsv_color.hue < 0)
+        hsv_color.hue += 360 * TCS3200_Q16_ONE;
+
+    return hsv_color;
+}
+
+CMYKColorQ16 TCS3200::rgb_to_cmyk_q16(RGBColor color) {
+    uint8_t max_val = max(color.red, max(color.green, color.blue));
+
+    CMYKColorQ16 cmyk_color;
+    cmyk_color.black = TCS3200_Q16_ONE - TCS3200_Q16_FROM_8BIT(max_val);
+
+    if(max_val == 0) {
+        cmyk_color.cyan = cmyk_color.magenta = cmyk_color.yellow = 0;
+        return cmyk_color;
+    }
+
+    uint32_t max_reciprocal = TCS3200_Q24_ONE / max_val;
+    cmyk_color.cyan = ((uint32_t) (max_val - color.red) * max_reciprocal) >> 8;
+    cmyk_color.magenta = ((uint32_t) (max_val - color.green) * max_reciprocal) >> 8;
+    cmyk_color.yellow = ((uint32_t) (max_val - color.blue) * max_reciprocal) >> 8;
+
+    return cmyk_color;
+}
+
+CIE1931ColorQ16 TCS3200::rgb_to_cie1931_q16(RGBColor color) {
+    // sRGB to XYZ matrix in Q8.24, pre-divided by 255
+    static const uint32_t matrix[9] = {
+        27137, 23526, 11872,
+        13992, 47052, 4749,
+        1272, 7842, 62523
+    };
+
+    CIE1931ColorQ16 cie1931_color;
+    cie1931_color.x = (matrix[0] * color.red + matrix[1] * color.green + matrix[2] * color.blue + 128) >> 8;
+    cie1931_color.y = (matrix[3] * color.red + matrix[4] * color.green + matrix[5] * color.blue + 128) >> 8;
+    cie1931_color.z = (matrix[6] * color.red + matrix[7] * color.green + matrix[8] * color.blue + 128) >> 8;
+
+    return cie1931_color;
+}
+
+float TCS3200::cie1931_to_chroma(CIE1931Color color) {
+    float dx = color.x - 0.95047f;
+    float dy = color.y - 1.0f;
+    float dz = color.z - 1.08883f;
+
+    return sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+static float tcs3200_fast_cbrt(float value) {
+    union {
+        float f;
+        uint32_t i;
+    } bits = { value };
+
+    // Divide the exponent by three for the initial guess
+    bits.i = bits.i / 3 + 709921077UL;
+
+    float root = bits.f;
+    root = (2.0f * root + value / (root * root)) * (1.0f / 3.0f);
+    root = (2.0f * root + value / (root * root)) * (1.0f / 3.0f);
+
+    return root;
+}
+
+static float tcs3200_lab_f(float t) {
+    return t > 0.008856f ? tcs3200_fast_cbrt(t) : 7.787037f * t + 0.137931f;
+}
+
+CIELabColor TCS3200::cie1931_to_cielab(CIE1931Color color) {
+    float fx = tcs3200_lab_f(color.x / 0.95047f);
+    float fy = tcs3200_lab_f(color.y);
+    float fz = tcs3200_lab_f(color.z / 1.08883f);
+
+    CIELabColor lab_color;
+    lab_color.l = 116.0f * fy - 16.0f;
+    lab_color.a = 500.0f * (fx - fy);
+    lab_color.b = 200.0f * (fy - fz);
+
+    return lab_color;
+}
+
+float TCS3200::delta_e76(CIELabColor first, CIELabColor second) {
+    float dl = first.l - second.l;
+    float da = first.a - second.a;
+    float db = first.b - second.b;
+
+    return sqrt(dl * dl + da * da + db * db);
+}
+
+float TCS3200::delta_e94(CIELabColor reference, CIELabColor sample) {
+    float c1 = sqrt(reference.a * reference.a + reference.b * reference.b);
+    float c2 = sqrt(sample.a * sample.a + sample.b * sample.b);
+
+    float dl = reference.l - sample.l;
+    float dc = c1 - c2;
+    float da = reference.a - sample.a;
+    float db = reference.b - sample.b;
+
+    float dh2 = da * da + db * db - dc * dc;
+    if(dh2 < 0.0f)
+        dh2 = 0.0f;
+
+    float sc = 1.0f + 0.045f * c1;
+    float sh = 1.0f + 0.015f * c1;
+
+    dc /= sc;
+    return sqrt(dl * dl + dc * dc + dh2 / (sh * sh));
+}
+
+float TCS3200::delta_e2000(CIELabColor reference, CIELabColor sample) {
+    const float deg = 180.0f / PI;
+    const float pow25_7 = 6103515625.0f;
+
+    float c1 = sqrt(reference.a * reference.a + reference.b * reference.b);
+    float c2 = sqrt(sample.a * sample.a + sample.b * sample.b);
+    float c_mean = (c1 + c2) * 0.5f;
+
+    float c_mean7 = pow(c_mean, 7);
+    float g = 0.5f * (1.0f - sqrt(c_mean7 / (c_mean7 + pow25_7)));
+
+    float a1 = reference.a * (1.0f + g);
+    float a2 = sample.a * (1.0f + g);
+
+    float c1p = sqrt(a1 * a1 + reference.b * reference.b);
+    float c2p = sqrt(a2 * a2 + sample.b * sample.b);
+
+    float h1p = (a1 == 0.0f && reference.b == 0.0f) ? 0.0f : atan2(reference.b, a1) * deg;
+    float h2p = (a2 == 0.0f && sample.b == 0.0f) ? 0.0f : atan2(sample.b, a2) * deg;
+
+    if(h1p < 0.0f)
+        h1p += 360.0f;
+    if(h2p < 0.0f)
+        h2p += 360.0f;
+
+    float dlp = sample.l - reference.l;
+    float dcp = c2p - c1p;
+    float dhp = 0.0f;
+    float h_mean = h1p + h2p;
+
+    if(c1p * c2p != 0.0f) {
+        dhp = h2p - h1p;
+        if(dhp > 180.0f)
+            dhp -= 360.0f;
+        else if(dhp < -180.0f)
+            dhp += 360.0f;
+
+        if(fabs(h1p - h2p) <= 180.0f)
+            h_mean *= 0.5f;
+        else h_mean = h_mean < 360.0f ?
+            (h_mean + 360.0f) * 0.5f :
+            (h_mean - 360.0f) * 0.5f;
+    }
+
+    float dhp_big = 2.0f * sqrt(c1p * c2p) * sin(dhp * 0.5f / deg);
+
+    float l_mean = (reference.l + sample.l) * 0.5f;
+    float cp_mean = (c1p + c2p) * 0.5f;
+
+    float t = 1.0f -
+        0.17f * cos((h_mean - 30.0f) / deg) +
+        0.24f * cos((2.0f * h_mean) / deg) +
+        0.32f * cos((3.0f * h_mean + 6.0f) / deg) -
+        0.20f * cos((4.0f * h_mean - 63.0f) / deg);
+
+    float l50 = (l_mean - 50.0f) * (l_mean - 50.0f);
+    float sl = 1.0f + (0.015f * l50) / sqrt(20.0f + l50);
+    float sc = 1.0f + 0.045f * cp_mean;
+    float sh = 1.0f + 0.015f * cp_mean * t;
+
+    float cp_mean7 = pow(cp_mean, 7);
+    float h_offset = (h_mean - 275.0f) / 25.0f;
+    float rt = -2.0f * sqrt(cp_mean7 / (cp_mean7 + pow25_7)) *
+        sin(60.0f * exp(-h_offset * h_offset) / deg);
+
+    float l_term = dlp / sl;
+    float c_term = dcp / sc;
+    float h_term = dhp_big / sh;
+
+    return sqrt(l_term * l_term + c_term * c_term + h_term * h_term + rt * c_term * h_term);
+}
+
+uint8_t TCS3200::rgb_dominant_color(RGBColor color) {
+    uint8_t max_color = max(color.red, max(color.green, color.blue));
+    if(max_color == color.red)
+        return TCS3200_COLOR_RED;
+    else if(max_color == color.green)
+        return TCS3200_COLOR_GREEN;
+
+    return TCS3200_COLOR_BLUE;
+}
+
+void TCS3200::upper_bound_interrupt(RGBColor threshold, void (*callback)()) {
+    this->upper_bound_interrupt_callback = callback;
+    this->ub_threshold = threshold;
+}
+
+void TCS3200::lower_bound_interrupt(RGBColor threshold, void (*callback)()) {
+    this->lower_bound_interrupt_callback = callback;
+    this->lb_threshold = threshold;
+}
+
+void TCS3200::clear_upper_bound_interrupt() {
+    this->upper_bound_interrupt_callback = nullptr;
+}
+
+void TCS3200::clear_lower_bound_interrupt() {
+    this->lower_bound_interrupt_callback = nullptr;
+}
+
+void TCS3200::edge_triggered_interrupts(bool enabled, uint8_t hysteresis, uint8_t debounce) {
+    this->_edge_triggered = enabled;
+    this->_event_hysteresis = hysteresis;
+    this->_event_debounce = debounce > 0 ? debounce : 1;
+
+    this->_ub_active = this->_lb_active = false;
+    this->_ub_count = this->_lb_count = 0;
+}
+
+void TCS3200::adaptive_sampling(uint32_t idle_interval, uint8_t delta, uint8_t stable_frames) {
+    this->_idle_interval = idle_interval;
+    this->_idle_delta = delta;
+    this->_idle_frames = stable_frames;
+    this->_stable_frames = 0;
+}
+
+bool TCS3200::idle() {
+    return this->_idle_interval > 0 &&
+        this->_stable_frames >= this->_idle_frames;
+}
+
+bool TCS3200::update_event(bool &active, uint8_t &count, bool entered, bool held) {
+    bool next = active ? held : entered;
+
+    if(next == active) {
+        count = 0;
+        return false;
+    }
+
+    if(++count < this->_event_debounce)
+        return false;
+
+    count = 0;
+    active = next;
+
+    return active;
+}
+
+void TCS3200::sampling(bool enabled) {
+    this->_sampling = enabled;
+
+    if(!enabled)
+        this->abort_scan();
+}
+
+bool TCS3200::sampling() {
+    return this->_sampling;
+}
+
+void TCS3200::settling_time(unsigned int time) {
+    for(uint8_t i = 0; i < 4; i++)
+        this->_settling_times[i] = time;
+}
+
+void TCS3200::settling_time(uint8_t scaling, unsigned int time) {
+    this->_settling_times[scaling & 0x03] = time;
+}
+
+unsigned int TCS3200::settling_time() {
+    return this->_settling_times[this->_frequency_scaling & 0x03];
+}
+
+uint32_t TCS3200::frame_budget() {
+    return 4 * ((uint32_t) this->settling_time() + this->_gate_time);
+}
+
+bool TCS3200::available() {
+    return this->_frame_available;
+}
+
+RawRGBC TCS3200::read_frame() {
+    this->_frame_available = false;
+    return this->_frame;
+}
+
+void TCS3200::attach_ring_buffer(TCS3200RingBuffer *buffer) {
+    this->_ring_buffer = buffer;
+}
+
+void TCS3200::attach_filter(TCS3200Filter *filter) {
+    filter->next = nullptr;
+
+    if(this->_filters == nullptr) {
+        this->_filters = filter;
+        return;
+    }
+
+    TCS3200Filter *last = this->_filters;
+    while(last->next != nullptr)
+        last = last->next;
+
+    last->next = filter;
+}
+
+void TCS3200::clear_filters() {
+    this->_filters = nullptr;
+}
+
+void TCS3200::attach_rules(TCS3200Rules *rules) {
+    this->_rules = rules;
+}
+
+void TCS3200::hal(TCS3200HAL *hal) {
+    this->_hal = hal;
+    this->_counter.hal(hal);
+}
+
+TCS3200HAL *TCS3200::hal() {
+    return this->_hal;
+}
+
+TCS3200Stats TCS3200::stats() {
+    TCS3200Stats snapshot = this->_stats;
+
+    for(uint8_t i = 0; i < 4; i++)
+        if(snapshot.channels[i].samples > 0)
+            snapshot.channels[i].mean_time = this->_stats_time[i] / snapshot.channels[i].samples;
+
+    return snapshot;
+}
+
+void TCS3200::reset_stats() {
+    for(uint8_t i = 0; i < 4; i++) {
+        TCS3200ChannelStats &channel = this->_stats.channels[i];
+
+        channel.samples = channel.timeouts = channel.saturated = 0;
+        channel.min_time = 0xffffffff;
+        channel.max_time = channel.mean_time = 0;
+        this->_stats_time[i] = 0;
+    }
+
+    this->_stats.frames = this->_stats.callbacks = 0;
+}
+
+void TCS3200::record_acquisition(uint8_t channel, uint32_t time, bool timeout) {
+    TCS3200ChannelStats &stats = this->_stats.channels[channel & 0x03];
+
+    stats.samples++;
+    if(timeout)
+        stats.timeouts++;
+
+    if(time < stats.min_time)
+        stats.min_time = time;
+    if(time > stats.max_time)
+        stats.max_time = time;
+
+    this->_stats_time[channel & 0x03] += time;
+}
+
+uint32_t TCS3200::apply_filters(uint8_t channel, uint32_t raw, bool scanned) {
+    // Only one stream of readings feeds the filter state: the frames
+    // of loop() while it samples, the blocking reads otherwise
+    if(scanned != this->sampling_needed())
+        return raw;
+
+    for(TCS3200Filter *filter = this->_filters; filter != nullptr; filter = filter->next)
+        raw = filter->update(channel, raw);
+
+    return raw;
+}
+
+void TCS3200::abort_scan() {
+    if(this->_scan_state == TCS3200_SCAN_MEASURE) {
+        this->_counter.detach();
+        this->_measuring = false;
+    }
+
+    this->_scan_state = TCS3200_SCAN_SELECT;
+}
+
+bool TCS3200::scan_step() {
+    uint8_t channel = tcs3200_channel_orders[this->_channel_order][this->_scan_channel];
+
+    switch(this->_scan_state) {
+        case TCS3200_SCAN_SELECT:
+            if(this->_scan_channel == 0) {
+                this->_scan_frame.timestamp = this->_hal->now();
+                this->_scan_frame.scaling = this->_frequency_scaling;
+                this->_scan_frame.valid = 0;
+            }
+
+            // Already selected when the previous channel completed
+            this->select_filter(channel);
+            this->_scan_state = TCS3200_SCAN_SETTLE;
+            break;
+
+        case TCS3200_SCAN_SETTLE: {
+            if(!this->settled())
+                break;
+
+            this->begin_counting();
+            if(this->_measuring) {
+                this->_scan_state = TCS3200_SCAN_MEASURE;
+                break;
+            }
+
+            // A pin without an external interrupt cannot be edge-counted,
+            // so it blocks in pulseIn() like the blocking reads do
+            TCS3200_STAT(uint32_t start = this->_hal->now());
+            uint32_t pulse_width = this->_hal->pulse_in(this->_out_pin, LOW,
+                this->deadline(this->_frequency_scaling));
+            TCS3200_STAT(this->record_acquisition(channel,
+                this->_hal->now() - start, pulse_width == 0));
+
+            return this->complete_channel(channel, pulse_width);
+        }
+
+        case TCS3200_SCAN_MEASURE: {
+            if(!this->poll_measurement())
+                break;
+
+            uint32_t pulse_width = this->edge_pulse_width(this->_measurement_edges,
+                this->_measurement_periods, this->_measurement_span,
+                this->_measurement_elapsed);
+
+            TCS3200_STAT(this->record_acquisition(channel,
+                this->_measurement_elapsed, this->_measurement_edges == 0));
+
+            return this->complete_channel(channel, pulse_width);
+        }
+    }
+
+    return false;
+}
+
+bool TCS3200::complete_channel(uint8_t channel, uint32_t pulse_width) {
+    if(pulse_width > 0)
+        this->_scan_frame.valid |= 1 << channel;
+    else this->_status |= TCS3200_STATUS_TIMEOUT;
+
+    switch(channel) {
+        case TCS3200_COLOR_RED:
+            this->_scan_frame.red = pulse_width;
+            break;
+        case TCS3200_COLOR_GREEN:
+            this->_scan_frame.green = pulse_width;
+            break;
+        case TCS3200_COLOR_BLUE:
+            this->_scan_frame.blue = pulse_width;
+            break;
+        case TCS3200_COLOR_CLEAR:
+            this->_scan_frame.clear = pulse_width;
+            break;
+    }
+
+    if(++this->_scan_channel == 4)
+        this->_scan_channel = 0;
+
+    // Switch to the next channel right away, so it settles
+    // while the caller handles this result
+    this->select_filter(tcs3200_channel_orders[this->_channel_order][this->_scan_channel]);
+    this->_scan_state = this->_scan_channel == 0 ?
+        TCS3200_SCAN_SELECT : TCS3200_SCAN_SETTLE;
+
+    return this->_scan_channel == 0;
+}
+
+void TCS3200::publish_frame() {
+    this->_frame = this->_scan_frame;
+    this->_frame_available = true;
+    TCS3200_STAT(this->_stats.frames++);
+
+    if(this->_ring_buffer != nullptr)
+        this->_ring_buffer->push(this->_frame);
+
+    if(this->_cal_active)
+        this->accumulate_calibration(this->_frame);
+
+    if(this->_auto_range)
+        this->range_frame(this->_frame);
+
+    this->_frame_end = this->_hal->now();
+
+    if(this->upper_bound_interrupt_callback == nullptr &&
+        this->lower_bound_interrupt_callback == nullptr &&
+        this->_rules == nullptr &&
+        this->_idle_interval == 0)
+        return;
+
+    RGBColor current_reading;
+    current_reading.red = this->normalize(TCS3200_COLOR_RED,
+        this->apply_filters(TCS3200_COLOR_RED,
+            this->rescale(this->_frame.red, this->_frame.scaling), true));
+    current_reading.green = this->normalize(TCS3200_COLOR_GREEN,
+        this->apply_filters(TCS3200_COLOR_GREEN,
+            this->rescale(this->_frame.green, this->_frame.scaling), true));
+    current_reading.blue = this->normalize(TCS3200_COLOR_BLUE,
+        this->apply_filters(TCS3200_COLOR_BLUE,
+            this->rescale(this->_frame.blue, this->_frame.scaling), true));
+
+    if(this->_idle_interval > 0) {
+        bool stable = abs(current_reading.red - this->_last_reading.red) <= this->_idle_delta &&
+            abs(current_reading.green - this->_last_reading.green) <= this->_idle_delta &&
+            abs(current_reading.blue - this->_last_reading.blue) <= this->_idle_delta;
+
+        if(!stable)
+            this->_stable_frames = 0;
+        else if(this->_stable_frames < this->_idle_frames)
+            this->_stable_frames++;
+
+        this->_last_reading = current_reading;
+    }
+
+    RGBColor balanced = this->apply_white_balance(current_reading);
+
+    if(this->_rules != nullptr) {
+        uint8_t clear = this->normalize(TCS3200_COLOR_CLEAR,
+            this->apply_filters(TCS3200_COLOR_CLEAR,
+                this->rescale(this->_frame.clear, this->_frame.scaling), true));
+        ColorSample sample(current_reading, balanced, clear);
+
+        this->_rules->evaluate(sample);
+    }
+
+    bool above = balanced.red > this->ub_threshold.red &&
+        balanced.green > this->ub_threshold.green &&
+        balanced.blue > this->ub_threshold.blue;
+    bool below = balanced.red < this->lb_threshold.red &&
+        balanced.green < this->lb_threshold.green &&
+        balanced.blue < this->lb_threshold.blue;
+
+    if(this->_edge_triggered) {
+        uint8_t margin = this->_event_hysteresis;
+
+        bool above_held = balanced.red + margin > this->ub_threshold.red &&
+            balanced.green + margin > this->ub_threshold.green &&
+            balanced.blue + margin > this->ub_threshold.blue;
+        bool below_held = balanced.red < this->lb_threshold.red + margin &&
+            balanced.green < this->lb_threshold.green + margin &&
+            balanced.blue < this->lb_threshold.blue + margin;
+
+        above = this->update_event(this->_ub_active, this->_ub_count, above, above_held);
+        below = this->update_event(this->_lb_active, this->_lb_count, below, below_held);
+    }
+
+    if(this->upper_bound_interrupt_callback != nullptr && above) {
+        TCS3200_STAT(this->_stats.callbacks++);
+        this->upper_bound_interrupt_callback();
+    }
+
+    if(this->lower_bound_interrupt_callback != nullptr && below) {
+        TCS3200_STAT(this->_stats.callbacks++);
+        this->lower_bound_interrupt_callback();
+    }
+}
+
+bool TCS3200::sampling_needed() {
+    return this->_sampling ||
+        this->_cal_active ||
+        this->_ring_buffer != nullptr ||
+        this->_rules != nullptr ||
+        this->upper_bound_interrupt_callback != nullptr ||
+        this->lower_bound_interrupt_callback != nullptr;
+}
+
+void TCS3200::loop() {
+    if(!this->sampling_needed())
+        return;
+
+    // Wait for a start_measurement() window to be polled to its end
+    if(this->_measuring && this->_scan_state != TCS3200_SCAN_MEASURE)
+        return;
+
+    if(this->_scan_channel == 0 &&
+        this->_scan_state == TCS3200_SCAN_SELECT &&
+        this->idle() &&
+        this->_hal->now() - this->_frame_end < this->_idle_interval)
+        return;
+
+    if(this->scan_step())
+        this->publish_frame();
 }
@@ -154,11 +154,64 @@
 #define TCS3200_COLOR_BLUE    0x02  ///< Blue color channel for filtering
 #define TCS3200_COLOR_CLEAR   0x03  ///< Clear color channel for filtering
 
+#define TCS3200_CAL_LIGHT     0x00  ///< Light (white) calibration target
+#define TCS3200_CAL_DARK      0x01  ///< Dark (black) calibration target
+
+#define TCS3200_CALIBRATION_VERSION 0x02 ///< Version of the stored calibration profile
+#define TCS3200_CALIBRATION_SIZE    42   ///< Size of the stored calibration profile in bytes
+
+#define TCS3200_ORDER_RGBC    0x00  ///< Measure frames in red, green, blue, clear order
+#define TCS3200_ORDER_GRAY    0x01  ///< Measure frames in red, blue, green, clear order (one S2/S3 pin change per switch)
+
 #define TCS3200_PWR_DOWN      0x00  ///< Power down mode
 #define TCS3200_OFREQ_2P      0x01  ///< 2% frequency scaling
 #define TCS3200_OFREQ_20P     0x02  ///< 20% frequency scaling
 #define TCS3200_OFREQ_100P    0x03  ///< 100% frequency scaling
 
+#define TCS3200_STATUS_OK         0x00  ///< Every reading was valid
+#define TCS3200_STATUS_TIMEOUT    0x01  ///< A channel saw no pulse before the deadline
+#define TCS3200_STATUS_SATURATED  0x02  ///< A reading was clamped to the calibrated range
+
+#define TCS3200_Q16_ONE       65536L ///< 1.0 in Q16.16 fixed-point
+
+#define TCS3200_CURVE_POINTS  17    ///< Number of points in a linearization curve
+
+#ifndef TCS3200_FIXED_POINT
+#ifdef __AVR__
+#define TCS3200_FIXED_POINT 1   ///< Derive float conversions from the Q16.16 kernels
+#else
+#define TCS3200_FIXED_POINT 0   ///< Compute float conversions in floating point, for FPU-equipped targets
+#endif
+#endif
+
+#ifndef TCS3200_EDGE_COUNTER_SLOTS
+#define TCS3200_EDGE_COUNTER_SLOTS 4  ///< Number of OUT pins that can be edge-counted at once (max 8)
+#endif
+
+#ifndef TCS3200_ENABLE_STATS
+#define TCS3200_ENABLE_STATS 0        ///< Collect acquisition statistics when building the library (see `TCS3200::stats()`)
+#endif
+
+#ifndef TCS3200_AUTO_RANGE_MIN_PULSE
+#define TCS3200_AUTO_RANGE_MIN_PULSE 20       ///< Pulse width (microseconds) below which auto-ranging scales down
+#endif
+
+#ifndef TCS3200_AUTO_RANGE_MAX_PULSE
+#define TCS3200_AUTO_RANGE_MAX_PULSE 2000     ///< Pulse width (microseconds) above which auto-ranging scales up
+#endif
+
+#ifndef TCS3200_AUTO_RANGE_EDGES
+#define TCS3200_AUTO_RANGE_EDGES     32       ///< Edges an auto-ranged measurement gate is sized to count
+#endif
+
+#ifndef TCS3200_AUTO_RANGE_MAX_GATE
+#define TCS3200_AUTO_RANGE_MAX_GATE  250000UL ///< Longest auto-ranged measurement gate in microseconds
+#endif
+
+#ifndef TCS3200_SETTLING_TIME
+#define TCS3200_SETTLING_TIME 100   ///< Default time in microseconds for the output to settle after a filter or scaling switch
+#endif
+
 /**
  * 
  * @brief Structure to represent RGB color values.
@@ -170,6 +223,79 @@ typedef struct _RGBColor {
     uint8_t blue;   ///< Blue color intensity (0-255)
 } RGBColor;
 
+/**
+ * 
+ * @brief Structure to represent RGB and clear color values.
+ * 
+ */
+typedef struct _RGBCColor {
+    uint8_t red;    ///< Red color intensity (0-255)
+    uint8_t green;  ///< Green color intensity (0-255)
+    uint8_t blue;   ///< Blue color intensity (0-255)
+    uint8_t clear;  ///< Clear (unfiltered) intensity (0-255)
+} RGBCColor;
+
+/**
+ * 
+ * @brief Structure to represent raw, full-resolution channel readings.
+ *
+ * Each channel holds the width of the LOW pulse on the OUT pin in
+ * microseconds, as measured by `pulseIn()`. Brighter light produces
+ * shorter pulses.
+ * 
+ */
+typedef struct _RawRGBC {
+    uint32_t red;       ///< Red channel pulse width (microseconds)
+    uint32_t green;     ///< Green channel pulse width (microseconds)
+    uint32_t blue;      ///< Blue channel pulse width (microseconds)
+    uint32_t clear;     ///< Clear channel pulse width (microseconds)
+    uint32_t timestamp; ///< Value of `micros()` when the reading started
+    uint8_t scaling;    ///< Frequency scaling the pulse widths were measured at
+    uint8_t valid;      ///< Bit n is set if channel n was measured before the deadline
+} RawRGBC;
+
+/**
+ * 
+ * @brief Structure to represent the acquisition statistics of a channel.
+ * 
+ */
+typedef struct _TCS3200ChannelStats {
+    uint32_t samples;   ///< Number of measurements
+    uint32_t timeouts;  ///< Measurements that saw no pulse or edge
+    uint32_t saturated; ///< Normalized readings clamped to 0 or 255
+    uint32_t min_time;  ///< Shortest measurement in microseconds
+    uint32_t max_time;  ///< Longest measurement in microseconds
+    uint32_t mean_time; ///< Mean measurement time in microseconds
+} TCS3200ChannelStats;
+
+/**
+ * 
+ * @brief Structure to represent the acquisition statistics of a sensor.
+ * 
+ */
+typedef struct _TCS3200Stats {
+    TCS3200ChannelStats channels[4];    ///< Statistics of each channel (e.g. `TCS3200_COLOR_RED`)
+    uint32_t frames;                    ///< Frames published by `loop()`
+    uint32_t callbacks;                 ///< Bound interrupt callbacks executed by `loop()`
+} TCS3200Stats;
+
+/**
+ * 
+ * @brief Structure to represent the statistics of a calibration run.
+ * 
+ */
+typedef struct _CalibrationStats {
+    uint32_t red;           ///< Red channel trimmed mean pulse width (microseconds)
+    uint32_t green;         ///< Green channel trimmed mean pulse width (microseconds)
+    uint32_t blue;          ///< Blue channel trimmed mean pulse width (microseconds)
+    uint32_t clear;         ///< Clear channel trimmed mean pulse width (microseconds)
+    float red_variance;     ///< Red channel sample variance (microseconds squared)
+    float green_variance;   ///< Green channel sample variance (microseconds squared)
+    float blue_variance;    ///< Blue channel sample variance (microseconds squared)
+    float clear_variance;   ///< Clear channel sample variance (microseconds squared)
+    uint8_t samples;        ///< Number of samples taken
+} CalibrationStats;
+
 /**
  * 
  * @brief Structure to represent HSV color values.
@@ -206,228 +332,1329 @@ typedef struct _CIE1931 {
 
 /**
  * 
- * @class TCS3200
- * @brief Class representing the TCS3200 color sensor.
+ * @brief Structure to represent CIE 1976 L*a*b* color values.
+ * 
+ */
+typedef struct _CIELab {
+    float l;    ///< Lightness (0-100)
+    float a;    ///< Green-red axis
+    float b;    ///< Blue-yellow axis
+} CIELabColor;
+
+/**
+ * 
+ * @brief Structure to represent HSV color values in Q16.16 fixed-point.
+ * 
+ */
+typedef struct _HSVColorQ16 {
+    int32_t hue;        ///< Hue value in degrees (0-360 << 16)
+    int32_t saturation; ///< Saturation value (0-1 << 16)
+    int32_t value;      ///< Value (brightness) value (0-1 << 16)
+} HSVColorQ16;
+
+/**
+ * 
+ * @brief Structure to represent CMYK color values in Q16.16 fixed-point.
+ * 
+ */
+typedef struct _CMYKColorQ16 {
+    int32_t cyan;       ///< Cyan color intensity (0-1 << 16)
+    int32_t magenta;    ///< Magenta color intensity (0-1 << 16)
+    int32_t yellow;     ///< Yellow color intensity (0-1 << 16)
+    int32_t black;      ///< Black (Key) color intensity (0-1 << 16)
+} CMYKColorQ16;
+
+/**
+ * 
+ * @brief Structure to represent CIE 1931 XYZ color values in
+ *        Q16.16 fixed-point.
+ * 
+ */
+typedef struct _CIE1931Q16 {
+    int32_t x;  ///< X value (<< 16)
+    int32_t y;  ///< Y value (<< 16)
+    int32_t z;  ///< Z value (<< 16)
+} CIE1931ColorQ16;
+
+/**
+ * 
+ * @class ColorSample
+ * @brief A single color acquisition with cached color space conversions.
  *
- * This class provides functions to interface with the %TCS3200 color
- * sensor, read color intensity values, perform calibration, white
- * balancing, color space conversions, and nearest color detection.
- * It also supports customization of integration time and frequency
- * scaling.
+ * A sample is taken with one read of the red, green, blue and clear
+ * channels. All conversions describe that same instant and are only
+ * computed the first time they are requested, so asking for several
+ * formats does not trigger any further sensor reads.
  * 
  */
-class TCS3200 {
+class ColorSample {
 public:
     /**
      * 
-     * @brief Constructor for TCS3200 class.
+     * @brief Construct an empty (black) color sample.
      * 
-     * @param s0_pin Arduino pin connected to S0 pin of the %TCS3200.
-     * @param s1_pin Arduino pin connected to S1 pin of the %TCS3200.
-     * @param s2_pin Arduino pin connected to S2 pin of the %TCS3200.
-     * @param s3_pin Arduino pin connected to S3 pin of the %TCS3200.
-     * @param out_pin Arduino pin connected to OUT pin of the %TCS3200.
+     */
+    ColorSample();
+
+    /**
+     * 
+     * @brief Construct a color sample from existing readings.
+     * 
+     * @param rgb RGB color readings.
+     * @param balanced White balanced RGB color readings, used
+     *                 for the HSV, CMYK and CIE 1931 conversions.
+     * @param clear Clear channel reading.
      * 
      */
-    TCS3200(uint8_t s0_pin, uint8_t s1_pin, uint8_t s2_pin, uint8_t s3_pin, uint8_t out_pin);
+    ColorSample(RGBColor rgb, RGBColor balanced, uint8_t clear);
 
     /**
      * 
-     * @brief Initialize the %TCS3200 sensor and configure pins.
+     * @brief Get the RGB color readings of the sample.
+     *
+     * These are the normalized readings before the white balance
+     * or color correction, as needed by `fit_color_correction()`.
+     * 
+     * @return `RGBColor` of the sample.
      * 
      */
-    void begin();
+    RGBColor rgb();
+
+    /**
+     * 
+     * @brief Get the white balanced RGB color readings of the sample.
+     *
+     * The readings went through `TCS3200::apply_white_balance()`,
+     * so they match `TCS3200::read_rgb_color()`. Every conversion
+     * and rule uses them.
+     * 
+     * @return White balanced `RGBColor` of the sample.
+     * 
+     */
+    RGBColor balanced();
+
+    /**
+     * 
+     * @brief Get the clear channel reading of the sample.
+     * 
+     * @return Clear channel intensity (0-255).
+     * 
+     */
+    uint8_t clear();
+
+    /**
+     * 
+     * @brief Get the sample in the HSV color space.
+     * 
+     * @return `HSVColor` of the white balanced sample.
+     * 
+     */
+    HSVColor hsv();
+
+    /**
+     * 
+     * @brief Get the sample in the CMYK color space.
+     * 
+     * @return `CMYKColor` of the white balanced sample.
+     * 
+     */
+    CMYKColor cmyk();
+
+    /**
+     * 
+     * @brief Get the sample in the CIE 1931 XYZ color space.
+     * 
+     * @return `CIE1931Color` of the white balanced sample.
+     * 
+     */
+    CIE1931Color cie1931();
+
+    /**
+     * 
+     * @brief Get the chroma of the sample.
+     * 
+     * @return Chroma value.
+     * 
+     */
+    float chroma();
+
+    /**
+     * 
+     * @brief Get the sample in the CIE L*a*b* color space.
+     * 
+     * @return `CIELabColor` of the white balanced sample.
+     * 
+     */
+    CIELabColor cielab();
+
+    /**
+     * 
+     * @brief Get the dominant RGB color channel of the sample.
+     * 
+     * @return Dominant RGB color channel of the white balanced sample.
+     * 
+     */
+    uint8_t dominant_color();
+
+private:
+    RGBColor _rgb, _balanced;
+    uint8_t _clear, _cached;
+
+    HSVColor _hsv;
+    CMYKColor _cmyk;
+    CIE1931Color _cie1931;
+    CIELabColor _cielab;
+    float _chroma;
+};
+
+/**
+ * 
+ * @class TCS3200HAL
+ * @brief Interface to the pins and clock the sensor is driven through.
+ *
+ * Every pin access and time reading of the library goes through a
+ * HAL, which defaults to the Arduino core (`TCS3200ArduinoHAL`).
+ * Implement this interface to drive the sensor through an I/O
+ * expander, or to run the library against a simulated sensor such
+ * as `TCS3200SimulatedHAL` in `TCS3200Simulator.h`.
+ * 
+ */
+class TCS3200HAL {
+public:
+    /**
+     * 
+     * @brief Configure a pin as an input or output.
+     * 
+     * @param pin Pin to be configured.
+     * @param mode `INPUT` or `OUTPUT`.
+     * 
+     */
+    virtual void pin_mode(uint8_t pin, uint8_t mode) = 0;
+
+    /**
+     * 
+     * @brief Drive an output pin.
+     * 
+     * @param pin Pin to be driven.
+     * @param value `LOW` or `HIGH`.
+     * 
+     */
+    virtual void digital_write(uint8_t pin, uint8_t value) = 0;
+
+    /**
+     * 
+     * @brief Drive two output pins together.
+     *
+     * Used when a filter or frequency scaling change flips both of
+     * its select pins. The default drives the pins one after another
+     * through `digital_write()`; a HAL that can update both pins in
+     * a single register write should override it.
+     * 
+     * @param first_pin First pin to be driven.
+     * @param first_value `LOW` or `HIGH` for the first pin.
+     * @param second_pin Second pin to be driven.
+     * @param second_value `LOW` or `HIGH` for the second pin.
+     * 
+     */
+    virtual void digital_write_pair(uint8_t first_pin, uint8_t first_value,
+        uint8_t second_pin, uint8_t second_value);
+
+    /**
+     * 
+     * @brief Measure the width of a pulse on an input pin.
+     * 
+     * @param pin Pin to be measured.
+     * @param state `LOW` or `HIGH` pulse to be measured.
+     * @param timeout Longest time to wait in microseconds.
+     * 
+     * @return Pulse width in microseconds, or 0 on timeout.
+     * 
+     */
+    virtual uint32_t pulse_in(uint8_t pin, uint8_t state, uint32_t timeout) = 0;
+
+    /**
+     * 
+     * @brief Get the current time.
+     * 
+     * @return Time in microseconds, wrapping around like `micros()`.
+     * 
+     */
+    virtual uint32_t now() = 0;
+
+    /**
+     * 
+     * @brief Execute a function on every falling edge of a pin.
+     * 
+     * @param pin Pin to be watched.
+     * @param isr Function to be executed from the interrupt.
+     * 
+     * @return `true` if the interrupt was attached, `false` if the
+     *         pin cannot raise one.
+     * 
+     */
+    virtual bool attach_edge(uint8_t pin, void (*isr)()) = 0;
+
+    /**
+     * 
+     * @brief Stop watching the falling edges of a pin.
+     * 
+     * @param pin Pin to stop watching.
+     * 
+     */
+    virtual void detach_edge(uint8_t pin) = 0;
+};
+
+/**
+ * 
+ * @class TCS3200ArduinoHAL
+ * @brief HAL backed by the Arduino core functions.
+ * 
+ */
+class TCS3200ArduinoHAL : public TCS3200HAL {
+public:
+    void pin_mode(uint8_t pin, uint8_t mode);
+    void digital_write(uint8_t pin, uint8_t value);
+    uint32_t pulse_in(uint8_t pin, uint8_t state, uint32_t timeout);
+    uint32_t now();
+    bool attach_edge(uint8_t pin, void (*isr)());
+    void detach_edge(uint8_t pin);
+
+    /**
+     * 
+     * @brief Get the HAL shared by every sensor by default.
+     * 
+     * @return Pointer to the shared Arduino HAL.
+     * 
+     */
+    static TCS3200HAL *instance();
+};
+
+/**
+ * 
+ * @class TCS3200EdgeCounter
+ * @brief Interrupt-driven counter of falling edges on an OUT pin.
+ *
+ * While attached, the counter claims one of the
+ * `TCS3200_EDGE_COUNTER_SLOTS` pin-change interrupt slots and
+ * increments its count on every falling edge of the pin. This
+ * lets the frequency of the %TCS3200 output be measured over a
+ * gate window without busy-waiting like `pulseIn()` does.
+ *
+ * Counting at 100% frequency scaling can produce several hundred
+ * thousand interrupts per second on a bright surface, which is
+ * more than most 8-bit boards can service. Prefer 2% or 20%
+ * scaling when using edge counting.
+ * 
+ */
+class TCS3200EdgeCounter {
+public:
+    /**
+     * 
+     * @brief Constructor for TCS3200EdgeCounter class.
+     * 
+     */
+    TCS3200EdgeCounter();
+
+    /**
+     * 
+     * @brief Start counting falling edges on a pin.
+     * 
+     * @param pin Arduino pin to be counted. With the Arduino HAL it
+     *            must have an external interrupt, as reported by
+     *            `digitalPinToInterrupt()`.
+     * 
+     * @return `true` if an interrupt slot was claimed, `false` if
+     *         all slots are in use or the pin has no interrupt.
+     * 
+     */
+    bool attach(uint8_t pin);
+
+    /**
+     * 
+     * @brief Stop counting and release the interrupt slot.
+     * 
+     */
+    void detach();
+
+    /**
+     * 
+     * @brief Check whether the counter is currently attached.
+     * 
+     * @return `true` if counting, `false` otherwise.
+     * 
+     */
+    bool attached();
+
+    /**
+     * 
+     * @brief Timestamp the newest edge if the count moved.
+     *
+     * The interrupt only increments the count, so edges are
+     * timestamped here instead: the first poll that sees an edge
+     * and the last one that sees the count move. Poll often while
+     * the gate is open and once more when it closes; the timestamps
+     * are as accurate as the time between polls.
+     * 
+     */
+    void poll();
+
+    /**
+     * 
+     * @brief Get the number of falling edges counted since `attach()`.
+     *
+     * `span` and `periods` cover the edges timestamped by `poll()`,
+     * so they measure whole periods only: the partial periods before
+     * the first edge and after the last one are left out.
+     * 
+     * @param span If not null, receives the time in microseconds
+     *             between the first and last timestamped edge.
+     * @param periods If not null, receives the number of periods
+     *                within `span`.
+     * 
+     * @return Edge count.
+     * 
+     */
+    uint32_t count(uint32_t *span = nullptr, uint32_t *periods = nullptr);
+
+    /**
+     * 
+     * @brief Set the HAL the pin is watched through.
+     *
+     * The HAL must not be changed while the counter is attached.
+     * 
+     * @param hal HAL to be used.
+     * 
+     */
+    void hal(TCS3200HAL *hal);
+
+private:
+    int8_t _slot;
+    uint8_t _pin;
+    uint32_t _first_edges, _first_time, _last_edges, _last_time;
+    TCS3200HAL *_hal;
+
+    uint32_t edges();
+};
+
+class TCS3200Filter;
+class TCS3200RingBuffer;
+class TCS3200Rules;
+
+/**
+ * 
+ * @class TCS3200Storage
+ * @brief Interface to a non-volatile storage for calibration profiles.
+ *
+ * Implement this interface to save calibration profiles to any kind
+ * of storage, such as flash memory or a file. An EEPROM backend is
+ * provided by `TCS3200EEPROMStorage` in `TCS3200EEPROM.h`.
+ * 
+ */
+class TCS3200Storage {
+public:
+    /**
+     * 
+     * @brief Read bytes from the storage.
+     * 
+     * @param address Address of the first byte.
+     * @param data Buffer to receive the bytes.
+     * @param length Number of bytes to read.
+     * 
+     * @return `true` on success, `false` otherwise.
+     * 
+     */
+    virtual bool read(uint16_t address, uint8_t *data, uint16_t length) = 0;
+
+    /**
+     * 
+     * @brief Write bytes to the storage.
+     * 
+     * @param address Address of the first byte.
+     * @param data Bytes to be written.
+     * @param length Number of bytes to write.
+     * 
+     * @return `true` on success, `false` otherwise.
+     * 
+     */
+    virtual bool write(uint16_t address, const uint8_t *data, uint16_t length) = 0;
+};
+
+/**
+ * 
+ * @class TCS3200
+ * @brief Class representing the TCS3200 color sensor.
+ *
+ * This class provides functions to interface with the %TCS3200 color
+ * sensor, read color intensity values, perform calibration, white
+ * balancing, color space conversions, and nearest color detection.
+ * It also supports customization of integration time and frequency
+ * scaling.
+ * 
+ */
+class TCS3200 {
+public:
+    /**
+     * 
+     * @brief Constructor for TCS3200 class.
+     * 
+     * @param s0_pin Arduino pin connected to S0 pin of the %TCS3200.
+     * @param s1_pin Arduino pin connected to S1 pin of the %TCS3200.
+     * @param s2_pin Arduino pin connected to S2 pin of the %TCS3200.
+     * @param s3_pin Arduino pin connected to S3 pin of the %TCS3200.
+     * @param out_pin Arduino pin connected to OUT pin of the %TCS3200.
+     * 
+     */
+    TCS3200(uint8_t s0_pin, uint8_t s1_pin, uint8_t s2_pin, uint8_t s3_pin, uint8_t out_pin);
+
+    /**
+     * 
+     * @brief Initialize the %TCS3200 sensor and configure pins.
+     * 
+     */
+    void begin();
+
+    /**
+     * 
+     * @brief Read the intensity of the red color channel.
+     * 
+     * @return Red color intensity (0-255).
+     * 
+     */
+    uint8_t read_red();
+
+    /**
+     * 
+     * @brief Read the intensity of the green color channel.
+     * 
+     * @return Green color intensity (0-255).
+     * 
+     */
+    uint8_t read_green();
+
+    /**
+     * 
+     * @brief Read the intensity of the blue color channel.
+     * 
+     * @return Blue color intensity (0-255).
+     * 
+     */
+    uint8_t read_blue();
+
+    /**
+     * 
+     * @brief Read the intensity of the clear (ambient) color channel.
+     * 
+     * @return Clear color intensity (0-255).
+     * 
+     */
+    uint8_t read_clear();
+
+    /**
+     * 
+     * @brief Read the raw pulse width of the red color channel.
+     * 
+     * @return Red channel pulse width in microseconds.
+     * 
+     */
+    uint32_t read_raw_red();
+
+    /**
+     * 
+     * @brief Read the raw pulse width of the green color channel.
+     * 
+     * @return Green channel pulse width in microseconds.
+     * 
+     */
+    uint32_t read_raw_green();
+
+    /**
+     * 
+     * @brief Read the raw pulse width of the blue color channel.
+     * 
+     * @return Blue channel pulse width in microseconds.
+     * 
+     */
+    uint32_t read_raw_blue();
+
+    /**
+     * 
+     * @brief Read the raw pulse width of the clear color channel.
+     * 
+     * @return Clear channel pulse width in microseconds.
+     * 
+     */
+    uint32_t read_raw_clear();
+
+    /**
+     * 
+     * @brief Read the raw pulse widths of all four color channels.
+     * 
+     * @return `RawRGBC` holding the full-resolution readings.
+     * 
+     */
+    RawRGBC read_raw_rgbc();
+
+    /**
+     * 
+     * @brief Start a non-blocking frequency measurement of a channel.
+     *
+     * This selects the color filter and begins counting the
+     * falling edges of the OUT pin for one gate window of
+     * `integration_time()` microseconds. The call returns
+     * immediately; use `poll_measurement()` from the main loop
+     * to find out when the window has elapsed. Unlike `loop()`,
+     * this does not wait for `settling_time()` after switching
+     * the filter.
+     * 
+     * @param filter Color channel to be measured
+     *               (e.g. `TCS3200_COLOR_RED`).
+     * 
+     * The measurement shares its edge counter with the `loop()`
+     * scan, so it is refused while `loop()` samples, and `loop()`
+     * does not start a frame until `poll_measurement()` has
+     * reported the end of a running measurement.
+     * 
+     * @return `true` if the measurement started, `false` if no
+     *         edge counter slot was available, the OUT pin has
+     *         no interrupt or `loop()` is sampling.
+     * 
+     */
+    bool start_measurement(uint8_t filter);
+
+    /**
+     * 
+     * @brief Poll a measurement started with `start_measurement()`.
+     *
+     * Once the gate window has elapsed, the edge count is latched
+     * and the counter interrupt is released.
+     * 
+     * @return `true` if the measurement is complete (or none is
+     *         in progress), `false` if it is still counting.
+     * 
+     */
+    bool poll_measurement();
+
+    /**
+     * 
+     * @brief Get the result of the last completed measurement.
+     *
+     * The frequency is taken from the whole periods between the
+     * first and last edge counted in the gate window, so the partial
+     * period the gate opened in does not bias it. With a single edge
+     * it falls back to the edge count over the gate time.
+     * 
+     * @return Output frequency of the sensor in hertz, or 0 if
+     *         no edge was counted.
+     * 
+     */
+    uint32_t measurement_frequency();
+
+    /**
+     * 
+     * @brief Perform definition of the sensor as calibrated.
+     *
+     * This function defines the sensor as calibrated for the
+     * next reading to be more accurate. This function must be
+     * invoked after calling the functions `calibrate_light()`
+     * and `calibrate_dark()`.
+     * 
+     */
+    void calibrate();
+
+    /**
+     * 
+     * @brief Perform light calibration for white balancing.
+     *
+     * This function reads color intensity values from the sensor
+     * under a well-lit white surface and calculates the average
+     * values for each color channel. These values are used for
+     * white balancing future color readings.
+     *
+     * `calibration_samples()` readings are taken back to back and
+     * averaged after dropping the lowest and highest one. Use
+     * `start_calibration()` to calibrate without blocking.
+     * 
+     */
+    void calibrate_light();
+
+    /**
+     * 
+     * @brief Perform dark calibration for white balancing.
+     *
+     * This function reads color intensity values from the sensor under
+     * a dark surface and calculates the average values for each color
+     * channel, including clear. These values are used for white
+     * balancing future color readings.
+     *
+     * `calibration_samples()` readings are taken back to back and
+     * averaged after dropping the lowest and highest one. Use
+     * `start_calibration()` to calibrate without blocking.
+     * 
+     */
+    void calibrate_dark();
+
+    /**
+     * 
+     * @brief Set the number of readings taken per calibration.
+     * 
+     * @param samples Number of readings (1-255, default 10).
+     * 
+     */
+    void calibration_samples(uint8_t samples);
+
+    /**
+     * 
+     * @brief Get the number of readings taken per calibration.
+     * 
+     * @return Number of readings.
+     * 
+     */
+    uint8_t calibration_samples();
+
+    /**
+     * 
+     * @brief Start a light or dark calibration without blocking.
+     *
+     * The calibration is fed by the frames sampled in `loop()`,
+     * which must keep being called until `calibrating()` returns
+     * `false`.
+     * 
+     * @param target `TCS3200_CAL_LIGHT` or `TCS3200_CAL_DARK`.
+     * 
+     */
+    void start_calibration(uint8_t target);
+
+    /**
+     * 
+     * @brief Check whether a calibration is still in progress.
+     * 
+     * @return `true` if calibrating, `false` otherwise.
+     * 
+     */
+    bool calibrating();
+
+    /**
+     * 
+     * @brief Get the statistics of the last completed calibration.
+     * 
+     * @return `CalibrationStats` of the last calibration run.
+     * 
+     */
+    CalibrationStats calibration_stats();
+
+    /**
+     * 
+     * @brief Register a callback for calibration progress.
+     *
+     * The callback is executed after every calibration reading.
+     * The calibration is complete when `collected` equals `total`.
+     * 
+     * @param callback Function pointer to the callback function.
+     * 
+     */
+    void calibration_callback(void (*callback)(uint8_t target, uint8_t collected, uint8_t total));
+
+    /**
+     * 
+     * @brief Save the calibration profile to a storage.
+     *
+     * The profile holds the light and dark calibration values,
+     * the white balance, the frequency scaling and whether the
+     * sensor is calibrated. It takes `TCS3200_CALIBRATION_SIZE`
+     * bytes and is protected by a version tag and a CRC-16.
+     * 
+     * @param storage Storage to write the profile to.
+     * @param address Address of the profile in the storage.
+     * 
+     * @return `true` if the profile was written, `false` otherwise.
+     * 
+     */
+    bool save_calibration(TCS3200Storage &storage, uint16_t address = 0);
+
+    /**
+     * 
+     * @brief Load a calibration profile from a storage.
+     *
+     * The current calibration is left untouched if the stored
+     * profile is missing, corrupted or of another version.
+     * 
+     * @param storage Storage to read the profile from.
+     * @param address Address of the profile in the storage.
+     * 
+     * @return `true` if a valid profile was loaded, `false` otherwise.
+     * 
+     */
+    bool load_calibration(TCS3200Storage &storage, uint16_t address = 0);
+
+    /**
+     * 
+     * @brief Apply a gamma curve to the normalized color readings.
+     *
+     * The curve is baked into a small table of
+     * `TCS3200_CURVE_POINTS` points, which is linearly
+     * interpolated on every reading.
+     * 
+     * @param gamma Gamma exponent (e.g. `0.45` to brighten dark tones).
+     * 
+     */
+    void linearization(float gamma);
+
+    /**
+     * 
+     * @brief Apply a custom curve to the normalized color readings.
+     * 
+     * @param curve Output values for the inputs 0, 16, 32, ...,
+     *              240 and 255.
+     * 
+     */
+    void linearization(const uint8_t curve[TCS3200_CURVE_POINTS]);
+
+    /**
+     * 
+     * @brief Remove the curve applied to the normalized color readings.
+     * 
+     */
+    void clear_linearization();
+
+    /**
+     * 
+     * @brief Set the integration time for color sensing.
+     * 
+     * @param time Integration time in microseconds.
+     * 
+     */
+    void integration_time(unsigned int time);
+
+    /**
+     * 
+     * @brief Get the current integration time setting.
+     * 
+     * @return Integration time in microseconds.
+     * 
+     */
+    unsigned int integration_time();
+
+    /**
+     * 
+     * @brief Set the frequency scaling for color sensing.
+     * 
+     * @param scaling Frequency scaling value.
+     * 
+     */
+    void frequency_scaling(int scaling);
+
+    /**
+     * 
+     * @brief Get the current frequency scaling setting.
+     * 
+     * @return Frequency scaling value.
+     * 
+     */
+    int frequency_scaling();
+
+    /**
+     * 
+     * @brief Enable or disable automatic frequency scaling.
+     *
+     * While enabled, the pulse widths of normalized and frame
+     * readings are kept between `TCS3200_AUTO_RANGE_MIN_PULSE`
+     * and `TCS3200_AUTO_RANGE_MAX_PULSE` by stepping the S0/S1
+     * scaling between 2%, 20% and 100%: bright targets are
+     * scaled down before `pulseIn()` loses precision, and dark
+     * targets are scaled up so reads stay short. The edge counting
+     * gate of `loop()` and `start_measurement()` is resized after
+     * every frame to count about `TCS3200_AUTO_RANGE_EDGES` edges
+     * of the darkest channel, instead of using `integration_time()`.
+     *
+     * Readings are rescaled to the scaling the sensor was calibrated
+     * at (or last set with `frequency_scaling()` when uncalibrated)
+     * before filtering and normalization, so a scaling switch does
+     * not change the normalized values. Single-channel raw readings
+     * never switch the scaling; `RawRGBC` frames record theirs.
+     * 
+     * @param enabled Whether auto-ranging should be enabled.
+     * 
+     */
+    void auto_range(bool enabled);
+
+    /**
+     * 
+     * @brief Check whether automatic frequency scaling is enabled.
+     * 
+     * @return True if auto-ranging is enabled, false otherwise.
+     * 
+     */
+    bool auto_range();
+
+    /**
+     * 
+     * @brief Set the deadline of a single channel measurement.
+     *
+     * A `pulseIn()` measurement that sees no pulse before the
+     * deadline returns 0 and sets `TCS3200_STATUS_TIMEOUT`; its
+     * normalized reading is the darkest one. By default the
+     * deadline is `integration_time()` scaled by the inverse of the
+     * frequency scaling (2 ms at 100%, 10 ms at 20%, 100 ms at 2%
+     * with the default integration time), which bounds
+     * `read_rgb_color()` to three deadlines.
+     * 
+     * @param time Deadline in microseconds, or 0 to derive it
+     *             from the integration time and frequency scaling.
+     * 
+     */
+    void read_timeout(uint32_t time);
+
+    /**
+     * 
+     * @brief Get the deadline of a single channel measurement.
+     * 
+     * @return Deadline at the current frequency scaling in microseconds.
+     * 
+     */
+    uint32_t read_timeout();
+
+    /**
+     * 
+     * @brief Get and clear the status of the readings.
+     *
+     * The status accumulates over every reading made since the
+     * previous call, including the frames published by `loop()`,
+     * so a single check after a composite read such as
+     * `read_hsv()` covers all of its channels. Frames also record
+     * which of their channels are valid in `RawRGBC::valid`.
+     * 
+     * @return `TCS3200_STATUS_OK`, or a combination of
+     *         `TCS3200_STATUS_TIMEOUT` and `TCS3200_STATUS_SATURATED`.
+     * 
+     */
+    uint8_t status();
+
+    /**
+     * 
+     * @brief Read the RGB color values from the sensor.
+     *
+     * The readings go through `apply_white_balance()`, like every
+     * other color format.
+     * 
+     * @return `RGBColor` representing the current color readings.
+     * 
+     */
+    RGBColor read_rgb_color();
+
+    /**
+     * 
+     * @brief Read the RGB color values without white balance or
+     *        color correction.
+     *
+     * Use this to measure the reference patches passed to
+     * `fit_color_correction()`.
+     * 
+     * @return Normalized `RGBColor` readings.
+     * 
+     */
+    RGBColor read_uncorrected_rgb_color();
+
+    /**
+     * 
+     * @brief Read the RGB and clear color values in a single frame.
+     *
+     * All four channels are measured back to back in the order set
+     * by `channel_order()`. The RGB channels go through
+     * `apply_white_balance()`, while the clear channel is normalized
+     * with its own light and dark calibration only.
+     * 
+     * @return `RGBCColor` representing the current color readings.
+     * 
+     */
+    RGBCColor read_rgbc_color();
+
+    /**
+     * 
+     * @brief Read the RGB color values relative to the clear channel.
+     *
+     * Each color channel's output frequency is divided by the clear
+     * channel's, so the result depends on the color of the surface
+     * but not on its distance or the brightness of the light. When
+     * calibrated, the dark frequencies are subtracted first and the
+     * ratios are scaled so the light calibration target reads 255
+     * on every channel.
+     * 
+     * @return `RGBColor` of the luminance-normalized readings.
+     * 
+     */
+    RGBColor read_chromaticity();
+
+    /**
+     * 
+     * @brief Enable or disable infrared compensation.
+     *
+     * The colored photodiodes pass infrared as well as their own
+     * band. When enabled, `read_chromaticity()` estimates the
+     * infrared component as half the amount by which the red, green
+     * and blue frequencies exceed the clear one, and subtracts it
+     * from every channel.
+     * 
+     * @param enabled Whether infrared compensation should be enabled.
+     * 
+     */
+    void ir_compensation(bool enabled);
+
+    /**
+     * 
+     * @brief Check whether infrared compensation is enabled.
+     * 
+     * @return True if infrared compensation is enabled, false otherwise.
+     * 
+     */
+    bool ir_compensation();
+
+    /**
+     * 
+     * @brief Set the order the channels of a frame are measured in.
+     *
+     * `TCS3200_ORDER_GRAY` measures red, blue, green and clear, so
+     * every filter switch (including the one back to red for the
+     * next frame) changes a single S2/S3 pin. Pins that keep their
+     * level are never rewritten.
+     * 
+     * @param order `TCS3200_ORDER_RGBC` or `TCS3200_ORDER_GRAY`.
+     * 
+     */
+    void channel_order(uint8_t order);
+
+    /**
+     * 
+     * @brief Get the order the channels of a frame are measured in.
+     * 
+     * @return `TCS3200_ORDER_RGBC` or `TCS3200_ORDER_GRAY`.
+     * 
+     */
+    uint8_t channel_order();
+
+    /**
+     * 
+     * @brief Get the current white balance RGB values.
+     * 
+     * @return `RGBColor` representing white balance values.
+     * 
+     */
+    RGBColor white_balance();
+
+    /**
+     * 
+     * @brief Set the white balance RGB values.
+     *
+     * Each channel is scaled by its value / 255, and a value of 0
+     * leaves the channel as is. `calibrate_light()` sets every
+     * channel to 255, since the calibrated readings of the white
+     * target are already 255.
+     * 
+     * @param white_balance_rgb RGBColor representing white balance values.
+     * 
+     */
+    void white_balance(RGBColor white_balance_rgb);
+
+    /**
+     * 
+     * @brief Apply the current white balance to RGB color values.
+     *
+     * When a color correction matrix is set it is applied alone, in
+     * place of the per-channel white balance, so every reading (RGB, RGBC, HSV, CMYK, CIE 1931,
+     * CIELAB, the dominant and nearest colors, the balanced half of
+     * `ColorSample`, the bound interrupts and the rules) goes through
+     * the same single correction pass.
+     * 
+     * @param color `RGBColor` to be white balanced.
+     * 
+     * @return White balanced `RGBColor`.
+     * 
+     */
+    RGBColor apply_white_balance(RGBColor color);
+
+    /**
+     * 
+     * @brief Fit a color correction matrix from measured reference patches.
+     *
+     * Solves the least squares 3x4 affine mapping from `measured` to
+     * `reference`, so each corrected channel is a weighted sum of the
+     * measured red, green and blue plus an offset. Measure the patches
+     * with `read_uncorrected_rgb_color()`.
+     * 
+     * @param measured Normalized readings of the reference patches.
+     * @param reference Known colors of the same patches.
+     * @param count Number of patches, at least 4.
+     * 
+     * @return `true` if the matrix was fitted and enabled, `false` if
+     *         there are too few patches or they do not span the color space.
+     * 
+     */
+    bool fit_color_correction(const RGBColor *measured, const RGBColor *reference, uint8_t count);
+
+    /**
+     * 
+     * @brief Set the color correction matrix directly.
+     *
+     * Row `i` maps the measured red, green, blue and an offset onto
+     * output channel `i`. Coefficients are clamped to +/-32 and offsets
+     * to +/-512 so the fixed-point pass cannot overflow.
+     * 
+     * @param matrix 3x4 matrix of coefficients and offsets.
+     * 
+     */
+    void color_correction(const float matrix[3][4]);
+
+    /**
+     * 
+     * @brief Check whether a color correction matrix is in use.
+     * 
+     * @return `true` if the matrix replaces the white balance.
+     * 
+     */
+    bool color_correction();
+
+    /**
+     * 
+     * @brief Disable the color correction matrix and fall back to the
+     *        per-channel white balance.
+     * 
+     */
+    void clear_color_correction();
 
     /**
      * 
-     * @brief Read the intensity of the red color channel.
+     * @brief Read all color channels once into a `ColorSample`.
+     *
+     * Use this instead of calling `read_hsv()`, `read_cmyk()`,
+     * `read_cie1931()` and `get_chroma()` one after another, each
+     * of which performs its own sensor reads.
      * 
-     * @return Red color intensity (0-255).
+     * @return `ColorSample` of the current color readings.
      * 
      */
-    uint8_t read_red();
+    ColorSample read_sample();
 
     /**
      * 
-     * @brief Read the intensity of the green color channel.
+     * @brief Read the HSV color values from the sensor.
      * 
-     * @return Green color intensity (0-255).
+     * @return HSVColor representing the current color
+     *         readings in the HSV color space.
      * 
      */
-    uint8_t read_green();
+    HSVColor read_hsv();
 
     /**
      * 
-     * @brief Read the intensity of the blue color channel.
+     * @brief Read the CMYK color values from the sensor.
      * 
-     * @return Blue color intensity (0-255).
+     * @return CMYKColor representing the current white balanced
+     *         color readings in the CMYK color space.
      * 
      */
-    uint8_t read_blue();
+    CMYKColor read_cmyk();
 
     /**
      * 
-     * @brief Read the intensity of the clear (ambient) color channel.
+     * @brief Read the CIE 1931 XYZ color values from the sensor.
      * 
-     * @return Clear color intensity (0-255).
+     * @return CIE1931Color representing the current color
+     *         readings in the CIE 1931 XYZ color space.
      * 
      */
-    uint8_t read_clear();
+    CIE1931Color read_cie1931();
 
     /**
      * 
-     * @brief Perform definition of the sensor as calibrated.
+     * @brief Calculate the chroma of the current color readings.
      *
-     * This function defines the sensor as calibrated for the
-     * next reading to be more accurate. This function must be
-     * invoked after calling the functions `calibrate_light()`
-     * and `calibrate_dark()`.
+     * Chroma represents the vividness or saturation of a color.
+     * It is calculated as the Euclidean distance of the color
+     * from the white point in the CIE 1931 XYZ color space.
+     *
+     * \f{equation}{
+     * \text{Chroma} = \sqrt{(X - 0.95047)^2 + (Y - 1.0)^2 + (Z - 1.08883)^2}
+     * \f}
+     *
+     * @return Chroma value.
      * 
      */
-    void calibrate();
+    float get_chroma();
 
     /**
      * 
-     * @brief Perform light calibration for white balancing.
-     *
-     * This function reads color intensity values from the sensor
-     * under a well-lit white surface and calculates the average
-     * values for each color channel. These values are used for
-     * white balancing future color readings.
+     * @brief Get the dominant RGB color channel.
+     * 
+     * @return Dominant RGB color channel.
      * 
      */
-    void calibrate_light();
+    uint8_t get_rgb_dominant_color();
 
     /**
      * 
-     * @brief Perform dark calibration for white balancing.
-     *
-     * This function reads color intensity values from the sensor under
-     * a dark surface and calculates the average values for each color
-     * channel. These values are used for white balancing future color
-     * readings.
+     * @brief Convert RGB color values to the HSV color space.
+     * 
+     * @param color `RGBColor` to be converted.
+     * 
+     * @return `HSVColor` of the given color.
      * 
      */
-    void calibrate_dark();
+    static HSVColor rgb_to_hsv(RGBColor color);
 
     /**
      * 
-     * @brief Set the integration time for color sensing.
+     * @brief Convert RGB color values to the CMYK color space.
      * 
-     * @param time Integration time in microseconds.
+     * @param color `RGBColor` to be converted.
+     * 
+     * @return `CMYKColor` of the given color.
      * 
      */
-    void integration_time(unsigned int time);
+    static CMYKColor rgb_to_cmyk(RGBColor color);
 
     /**
      * 
-     * @brief Get the current integration time setting.
+     * @brief Convert RGB color values to the CIE 1931 XYZ color space.
      * 
-     * @return Integration time in microseconds.
+     * @param color `RGBColor` to be converted.
+     * 
+     * @return `CIE1931Color` of the given color.
      * 
      */
-    unsigned int integration_time();
+    static CIE1931Color rgb_to_cie1931(RGBColor color);
 
     /**
      * 
-     * @brief Set the frequency scaling for color sensing.
+     * @brief Calculate the chroma of CIE 1931 XYZ color values.
      * 
-     * @param scaling Frequency scaling value.
+     * @param color `CIE1931Color` of the color.
+     * 
+     * @return Chroma value.
      * 
      */
-    void frequency_scaling(int scaling);
+    static float cie1931_to_chroma(CIE1931Color color);
 
     /**
      * 
-     * @brief Get the current frequency scaling setting.
+     * @brief Convert CIE 1931 XYZ color values to CIE L*a*b*.
+     *
+     * The D65 white point is used as the reference white. The
+     * cube roots are computed with a bit-level initial guess
+     * refined by two Newton iterations, which stays within
+     * 0.001 of the exact L*, a* and b* values.
      * 
-     * @return Frequency scaling value.
+     * @param color `CIE1931Color` to be converted.
+     * 
+     * @return `CIELabColor` of the given color.
      * 
      */
-    int frequency_scaling();
+    static CIELabColor cie1931_to_cielab(CIE1931Color color);
 
     /**
      * 
-     * @brief Read the RGB color values from the sensor.
+     * @brief Read the CIE L*a*b* color values from the sensor.
      * 
-     * @return `RGBColor` representing the current color readings.
+     * @return CIELabColor representing the current color
+     *         readings in the CIE L*a*b* color space.
      * 
      */
-    RGBColor read_rgb_color();
+    CIELabColor read_cielab();
 
     /**
      * 
-     * @brief Get the current white balance RGB values.
+     * @brief Calculate the CIE 1976 color difference (Delta E*ab).
      * 
-     * @return `RGBColor` representing white balance values.
+     * @param first First `CIELabColor`.
+     * @param second Second `CIELabColor`.
+     * 
+     * @return Euclidean distance of the two colors in L*a*b*.
      * 
      */
-    RGBColor white_balance();
+    static float delta_e76(CIELabColor first, CIELabColor second);
 
     /**
      * 
-     * @brief Set the white balance RGB values.
+     * @brief Calculate the CIE 1994 color difference (Delta E*94).
+     *
+     * The graphic arts weighting factors are used. The difference
+     * is not symmetric: chroma and hue are weighted by the chroma
+     * of the reference color.
      * 
-     * @param white_balance_rgb RGBColor representing white balance values.
+     * @param reference Reference `CIELabColor`.
+     * @param sample Sample `CIELabColor` to be compared.
+     * 
+     * @return Delta E*94 of the sample from the reference.
      * 
      */
-    void white_balance(RGBColor white_balance_rgb);
+    static float delta_e94(CIELabColor reference, CIELabColor sample);
 
     /**
      * 
-     * @brief Read the HSV color values from the sensor.
+     * @brief Calculate the CIEDE2000 color difference (Delta E00).
      * 
-     * @return HSVColor representing the current color
-     *         readings in the HSV color space.
+     * @param reference Reference `CIELabColor`.
+     * @param sample Sample `CIELabColor` to be compared.
+     * 
+     * @return Delta E00 of the sample from the reference.
      * 
      */
-    HSVColor read_hsv();
+    static float delta_e2000(CIELabColor reference, CIELabColor sample);
 
     /**
      * 
-     * @brief Read the CMYK color values from the sensor.
+     * @brief Get the dominant color channel of RGB color values.
      * 
-     * @return CMYKColor representing the current color
-     *         readings in the CMYK color space.
+     * @param color `RGBColor` to be checked.
+     * 
+     * @return Dominant RGB color channel.
      * 
      */
-    CMYKColor read_cmyk();
+    static uint8_t rgb_dominant_color(RGBColor color);
 
     /**
      * 
-     * @brief Read the CIE 1931 XYZ color values from the sensor.
+     * @brief Convert RGB color values to the HSV color space
+     *        using integer arithmetic only.
+     *
+     * Compared to `rgb_to_hsv()` over all 2<sup>24</sup> RGB
+     * values, the hue differs by at most 0.002 degrees and the
+     * saturation and value by at most 2/65536.
      * 
-     * @return CIE1931Color representing the current color
-     *         readings in the CIE 1931 XYZ color space.
+     * @param color `RGBColor` to be converted.
+     * 
+     * @return `HSVColorQ16` of the given color.
      * 
      */
-    CIE1931Color read_cie1931();
+    static HSVColorQ16 rgb_to_hsv_q16(RGBColor color);
 
     /**
      * 
-     * @brief Calculate the chroma of the current color readings.
-     *
-     * Chroma represents the vividness or saturation of a color.
-     * It is calculated as the Euclidean distance of the color
-     * from the white point in the CIE 1931 XYZ color space.
-     *
-     * \f{equation}{
-     * \text{Chroma} = \sqrt{(X - 0.95047)^2 + (Y - 1.0)^2 + (Z - 1.08883)^2}
-     * \f}
+     * @brief Convert RGB color values to the CMYK color space
+     *        using integer arithmetic only.
      *
-     * @return Chroma value.
+     * Compared to `rgb_to_cmyk()`, every component differs by
+     * at most 2/65536.
+     * 
+     * @param color `RGBColor` to be converted.
+     * 
+     * @return `CMYKColorQ16` of the given color.
      * 
      */
-    float get_chroma();
+    static CMYKColorQ16 rgb_to_cmyk_q16(RGBColor color);
 
     /**
      * 
-     * @brief Get the dominant RGB color channel.
+     * @brief Convert RGB color values to the CIE 1931 XYZ color
+     *        space using integer arithmetic only.
+     *
+     * Compared to `rgb_to_cie1931()`, every component differs by
+     * at most 2/65536.
      * 
-     * @return Dominant RGB color channel.
+     * @param color `RGBColor` to be converted.
+     * 
+     * @return `CIE1931ColorQ16` of the given color.
      * 
      */
-    uint8_t get_rgb_dominant_color();
+    static CIE1931ColorQ16 rgb_to_cie1931_q16(RGBColor color);
 
     /**
      * 
@@ -449,16 +1676,228 @@ public:
      * bound interrupt is set, the callback function will be
      * executed when the RGB color intensity values go below
      * the threshold.
+     *
+     * The sensor is sampled cooperatively: every call advances
+     * the channel scheduler by at most one step (select filter,
+     * wait for `settling_time()`, count edges for
+     * `integration_time()`) and returns without waiting. As soon
+     * as a channel is measured, the filter of the next channel is
+     * selected, so it settles while the caller runs. Once
+     * the red, green, blue and clear channels have all been
+     * measured, the frame is published through `available()`
+     * and `read_frame()` and the interrupt conditions are
+     * evaluated against it. Blocking reads made in between
+     * restart the channel being measured.
+     *
+     * An OUT pin without an external interrupt cannot be
+     * edge-counted, so each channel is then measured with a
+     * blocking `pulseIn()` once it has settled.
+     *
+     * A frame takes `frame_budget()` microseconds, plus the time
+     * between `loop()` calls at two points per channel: when the
+     * output has settled, and when the gate window has elapsed.
      * 
      */
     void loop();
 
+    /**
+     * 
+     * @brief Enable or disable continuous sampling in `loop()`.
+     *
+     * Sampling runs automatically while an interrupt condition
+     * is set. Enable it to receive frames through `read_frame()`
+     * without any interrupt condition.
+     * 
+     * @param enabled `true` to keep sampling, `false` otherwise.
+     * 
+     */
+    void sampling(bool enabled);
+
+    /**
+     * 
+     * @brief Check whether continuous sampling is enabled.
+     * 
+     * @return `true` if sampling is enabled, `false` otherwise.
+     * 
+     */
+    bool sampling();
+
+    /**
+     * 
+     * @brief Set the time to wait after switching the color filter
+     *        or frequency scaling, for every frequency scaling.
+     *
+     * Blocking reads and `loop()` wait this long after a switch
+     * before measuring. Reads of the filter already selected do
+     * not wait. The partial output period that straddles the
+     * switch is discarded in any case: `pulseIn()` skips a pulse
+     * already in progress, and edge counting measures from the
+     * first edge in the gate window.
+     * 
+     * @param time Settling time in microseconds.
+     * 
+     */
+    void settling_time(unsigned int time);
+
+    /**
+     * 
+     * @brief Set the time to wait after switching the color filter
+     *        or frequency scaling, for one frequency scaling.
+     * 
+     * @param scaling Frequency scaling (e.g. `TCS3200_OFREQ_20P`).
+     * @param time Settling time in microseconds.
+     * 
+     */
+    void settling_time(uint8_t scaling, unsigned int time);
+
+    /**
+     * 
+     * @brief Get the time to wait after switching the color filter
+     *        or frequency scaling, at the current frequency scaling.
+     * 
+     * @return Settling time in microseconds.
+     * 
+     */
+    unsigned int settling_time();
+
+    /**
+     * 
+     * @brief Get the time budget of one frame scanned by `loop()`.
+     *
+     * Each of the four channels takes `settling_time()` followed by
+     * one gate window (`integration_time()`, or the auto-ranged
+     * gate). Frames therefore arrive at most every
+     * `4 * (settling_time() + integration_time())` microseconds.
+     * The time between `loop()` calls comes on top of this.
+     * 
+     * @return Frame time in microseconds at the current settings.
+     * 
+     */
+    uint32_t frame_budget();
+
+    /**
+     * 
+     * @brief Check whether `loop()` has published a new frame.
+     * 
+     * @return `true` if a frame is available since the last
+     *         call to `read_frame()`, `false` otherwise.
+     * 
+     */
+    bool available();
+
+    /**
+     * 
+     * @brief Get the most recent frame published by `loop()`.
+     * 
+     * @return `RawRGBC` of the latest completed frame.
+     * 
+     */
+    RawRGBC read_frame();
+
+    /**
+     * 
+     * @brief Stream every frame published by `loop()` into a ring buffer.
+     *
+     * Sampling runs while a ring buffer is attached.
+     * 
+     * @param buffer Ring buffer to receive the frames, or
+     *               `nullptr` to stop streaming.
+     * 
+     */
+    void attach_ring_buffer(TCS3200RingBuffer *buffer);
+
+    /**
+     * 
+     * @brief Append a filter to the channel filter pipeline.
+     *
+     * Filtered readings are used by `read_red()`, `read_green()`,
+     * `read_blue()`, every reading derived from them, and the
+     * interrupt conditions evaluated in `loop()`. Raw readings
+     * and calibration are not filtered. See `TCS3200Filters.h`.
+     *
+     * Each reading is filtered once, from a single stream: while
+     * `loop()` samples, only its frames are filtered and blocking
+     * reads return unfiltered values, so the two never mix in the
+     * filter state.
+     * 
+     * @param filter Filter to be appended. It must stay valid while
+     *               attached and can only be in one pipeline.
+     * 
+     */
+    void attach_filter(TCS3200Filter *filter);
+
+    /**
+     * 
+     * @brief Remove all filters from the channel filter pipeline.
+     * 
+     */
+    void clear_filters();
+
+    /**
+     * 
+     * @brief Evaluate a rule table on every frame published by `loop()`.
+     *
+     * The rules receive a `ColorSample` of the filtered frame.
+     * Sampling runs while a rule table is attached.
+     * 
+     * @param rules Rule table to be evaluated, or `nullptr` to
+     *              stop evaluating. See `TCS3200Rules.h`.
+     * 
+     */
+    void attach_rules(TCS3200Rules *rules);
+
+    /**
+     * 
+     * @brief Drive the sensor through another HAL.
+     *
+     * This must be called before `begin()`.
+     * 
+     * @param hal HAL the pins and clock are accessed through.
+     * 
+     */
+    void hal(TCS3200HAL *hal);
+
+    /**
+     * 
+     * @brief Get the HAL the sensor is driven through.
+     * 
+     * @return Current HAL.
+     * 
+     */
+    TCS3200HAL *hal();
+
+    /**
+     * 
+     * @brief Get a snapshot of the acquisition statistics.
+     *
+     * Statistics are only collected when the library itself is
+     * compiled with `TCS3200_ENABLE_STATS` defined to 1, e.g.
+     * through the build flags; otherwise the counters stay at 0
+     * and recording costs nothing. Defining the macro in a sketch
+     * does not change the library build. Both blocking reads and
+     * the `loop()` scheduler are counted.
+     * 
+     * @return `TCS3200Stats` collected since `begin()` or the
+     *         last `reset_stats()`.
+     * 
+     */
+    TCS3200Stats stats();
+
+    /**
+     * 
+     * @brief Clear the acquisition statistics.
+     * 
+     */
+    void reset_stats();
+
     /**
      * 
      * @brief Enable an upper bound interrupt with a given threshold.
      *
-     * When the color intensity values exceed the threshold,
-     * the registered callback function will be executed.
+     * When the white balanced color intensity values exceed the
+     * threshold, the registered callback function will be executed.
+     * See `edge_triggered_interrupts()` to execute it only
+     * once per crossing.
      *
      * @param threshold `RGBColor` threshold for the upper bound interrupt.
      * @param callback Function pointer to the callback function.
@@ -470,8 +1909,10 @@ public:
      * 
      * @brief Enable a lower bound interrupt with a given threshold.
      *
-     * When the color intensity values go below the threshold,
-     * the registered callback function will be executed.
+     * When the white balanced color intensity values go below the
+     * threshold, the registered callback function will be executed.
+     * See `edge_triggered_interrupts()` to execute it only
+     * once per crossing.
      *
      * @param threshold `RGBColor` threshold for the lower bound interrupt.
      * @param callback Function pointer to the callback function.
@@ -498,6 +1939,57 @@ public:
      */
     void clear_lower_bound_interrupt();
 
+    /**
+     * 
+     * @brief Make the bound interrupts fire once per crossing.
+     *
+     * By default the bound interrupt callbacks are executed on
+     * every frame the condition holds. When edge-triggered, a
+     * callback is executed once when its condition has held for
+     * `debounce` consecutive frames, and is re-armed after every
+     * channel has moved `hysteresis` back past its threshold for
+     * `debounce` consecutive frames.
+     * 
+     * @param enabled `true` for edge-triggered callbacks, `false`
+     *                to execute them on every frame.
+     * @param hysteresis Margin a reading must move back past the
+     *                   threshold by to re-arm the callback.
+     * @param debounce Consecutive frames needed to change state.
+     * 
+     */
+    void edge_triggered_interrupts(bool enabled, uint8_t hysteresis = 0, uint8_t debounce = 1);
+
+    /**
+     * 
+     * @brief Slow down sampling while the readings are stable.
+     *
+     * Once `stable_frames` consecutive frames differ from their
+     * predecessor by at most `delta` on every normalized channel,
+     * `loop()` waits `idle_interval` microseconds between frames
+     * instead of starting the next one immediately. No edges are
+     * counted while waiting, which frees the CPU from the counter
+     * interrupt. The first frame that changes by more than `delta`
+     * restores the full rate.
+     * 
+     * @param idle_interval Delay between frames while idle in
+     *                      microseconds, or 0 to always sample
+     *                      at the full rate.
+     * @param delta Largest change of a stable reading.
+     * @param stable_frames Stable frames needed before idling.
+     * 
+     */
+    void adaptive_sampling(uint32_t idle_interval, uint8_t delta = 2, uint8_t stable_frames = 8);
+
+    /**
+     * 
+     * @brief Check whether the adaptive sampler is idling.
+     * 
+     * @return `true` if `loop()` samples at the idle rate,
+     *         `false` otherwise.
+     * 
+     */
+    bool idle();
+
     /**
      * 
      * @brief Find the nearest color label based on the current sensor readings.
@@ -533,20 +2025,95 @@ public:
     }
 
 private:
+    friend class TCS3200Array;
+
     uint8_t _s0_pin, _s1_pin, _s2_pin, _s3_pin, _out_pin;
-    uint8_t max_r, max_g, max_b;
-    uint8_t min_r, min_g, min_b;
+    TCS3200HAL *_hal;
+    uint32_t max_r, max_g, max_b, max_c;
+    uint32_t min_r, min_g, min_b, min_c;
+    uint32_t _scale_r, _scale_g, _scale_b, _scale_c;
+    uint8_t _s2_level, _s3_level, _channel_order;
+    bool _ir_compensation;
 
     unsigned int _integration_time;
     int _frequency_scaling;
+    int _calibration_scaling;
+    bool _auto_range;
+    uint32_t _gate_time, _read_timeout;
+    uint8_t _status;
     bool is_calibrated;
 
     void (*upper_bound_interrupt_callback)();
     void (*lower_bound_interrupt_callback)();
 
     RGBColor white_balance_rgb, ub_threshold, lb_threshold;
+    int32_t _correction[3][4];
+    bool _color_correction;
+
+    bool _edge_triggered, _ub_active, _lb_active;
+    uint8_t _event_hysteresis, _event_debounce, _ub_count, _lb_count;
+
+    uint32_t _idle_interval, _frame_end;
+    uint8_t _idle_delta, _idle_frames, _stable_frames;
+    RGBColor _last_reading;
+
+    TCS3200EdgeCounter _counter;
+    bool _measuring;
+    uint32_t _measurement_start, _measurement_elapsed, _measurement_edges;
+    uint32_t _measurement_periods, _measurement_span;
+
+    bool _sampling, _frame_available;
+    uint8_t _scan_state, _scan_channel;
+    unsigned int _settling_times[4];
+    uint32_t _switch_time;
+    RawRGBC _scan_frame, _frame;
+    TCS3200RingBuffer *_ring_buffer;
+    TCS3200Filter *_filters;
+    TCS3200Rules *_rules;
+
+    bool _curve_enabled;
+    uint8_t _curve[TCS3200_CURVE_POINTS];
+
+    bool _cal_active;
+    uint8_t _cal_target, _cal_samples, _cal_collected;
+    uint32_t _cal_sum[4], _cal_min[4], _cal_max[4];
+    float _cal_mean[4], _cal_m2[4];
+    CalibrationStats _cal_stats;
+
+    void (*calibration_progress_callback)(uint8_t target, uint8_t collected, uint8_t total);
+
+    // Present in every build, so the class layout never depends on
+    // TCS3200_ENABLE_STATS
+    TCS3200Stats _stats;
+    uint64_t _stats_time[4];
+
+    void record_acquisition(uint8_t channel, uint32_t time, bool timeout);
 
     void select_filter(uint8_t filter);
+    bool settled();
+    uint32_t edge_pulse_width(uint32_t edges, uint32_t periods, uint32_t span,
+        uint32_t elapsed);
+    void begin_counting();
+    void abort_scan();
+    bool scan_step();
+    bool complete_channel(uint8_t channel, uint32_t pulse_width);
+    bool sampling_needed();
+    void publish_frame();
+    bool update_event(bool &active, uint8_t &count, bool entered, bool held);
+    uint32_t read_raw(uint8_t filter);
+    uint32_t read_scaled(uint8_t channel);
+    uint32_t rescale(uint32_t raw, uint8_t scaling);
+    uint32_t deadline(uint8_t scaling);
+    void apply_scaling(int scaling);
+    void range_frame(const RawRGBC &frame);
+    uint8_t normalize(uint8_t channel, uint32_t raw);
+    RGBCColor normalize_frame(const RawRGBC &frame);
+    uint32_t apply_filters(uint8_t channel, uint32_t raw, bool scanned);
+    void update_normalization();
+    void accumulate_calibration(RawRGBC frame);
+    void finish_calibration();
+
+    static uint16_t crc16(const uint8_t *data, uint16_t length);
 };
 
 #endif
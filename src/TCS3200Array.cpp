@@ -0,0 +1,199 @@
+/*
+ * This file is part of the TCS3200 Color Sensor Arduino library.
+ * Copyright (c) 2023 Nathanne Isip
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "TCS3200Array.h"
+
+#define TCS3200_ARRAY_SELECT    0x00
+#define TCS3200_ARRAY_SETTLE    0x01
+#define TCS3200_ARRAY_MEASURE   0x02
+
+TCS3200Array::TCS3200Array(uint8_t s0_pin, uint8_t s1_pin, uint8_t s2_pin, uint8_t s3_pin,
+    const uint8_t *out_pins, TCS3200ArraySensor *sensors, uint8_t count):
+    _control(s0_pin, s1_pin, s2_pin, s3_pin, out_pins[0]),
+    _out_pins(out_pins),
+    _sensors(sensors),
+    _count(count > TCS3200_EDGE_COUNTER_SLOTS ? TCS3200_EDGE_COUNTER_SLOTS : count),
+    _active(false),
+    _state(TCS3200_ARRAY_SELECT),
+    _channel(0),
+    _failed(0),
+    _timestamp(0) {
+    for(uint8_t i = 0; i < this->_count; i++) {
+        RawRGBC &frame = this->_sensors[i].frame;
+
+        frame.red = frame.green = frame.blue = frame.clear = 0;
+        frame.timestamp = 0;
+        frame.scaling = TCS3200_PWR_DOWN;
+        frame.valid = 0;
+    }
+}
+
+void TCS3200Array::begin() {
+    this->_control.begin();
+
+    for(uint8_t i = 1; i < this->_count; i++)
+        this->_control._hal->pin_mode(this->_out_pins[i], INPUT);
+
+    for(uint8_t i = 0; i < this->_count; i++)
+        this->_sensors[i].counter.hal(this->_control._hal);
+}
+
+void TCS3200Array::hal(TCS3200HAL *hal) {
+    this->_control.hal(hal);
+}
+
+uint8_t TCS3200Array::count() {
+    return this->_count;
+}
+
+void TCS3200Array::frequency_scaling(int scaling) {
+    this->_control.frequency_scaling(scaling);
+}
+
+int TCS3200Array::frequency_scaling() {
+    return this->_control.frequency_scaling();
+}
+
+void TCS3200Array::integration_time(unsigned int time) {
+    this->_control.integration_time(time);
+}
+
+unsigned int TCS3200Array::integration_time() {
+    return this->_control.integration_time();
+}
+
+void TCS3200Array::settling_time(unsigned int time) {
+    this->_control.settling_time(time);
+}
+
+unsigned int TCS3200Array::settling_time() {
+    return this->_control.settling_time();
+}
+
+void TCS3200Array::start_frame() {
+    for(uint8_t i = 0; i < this->_count; i++)
+        this->_sensors[i].counter.detach();
+
+    this->_channel = 0;
+    this->_failed = 0;
+    this->_state = TCS3200_ARRAY_SELECT;
+    this->_active = true;
+}
+
+bool TCS3200Array::poll_frame() {
+    if(!this->_active)
+        return true;
+
+    switch(this->_state) {
+        case TCS3200_ARRAY_SELECT:
+            this->_control.select_filter(this->_channel);
+
+            if(this->_channel == 0)
+                for(uint8_t i = 0; i < this->_count; i++) {
+                    this->_sensors[i].frame.timestamp = this->_control._hal->now();
+                    this->_sensors[i].frame.scaling = this->_control._frequency_scaling;
+                    this->_sensors[i].frame.valid = 0;
+                }
+
+            this->_state = TCS3200_ARRAY_SETTLE;
+            break;
+
+        case TCS3200_ARRAY_SETTLE:
+            if(!this->_control.settled())
+                break;
+
+            for(uint8_t i = 0; i < this->_count; i++)
+                if(!this->_sensors[i].counter.attach(this->_out_pins[i]))
+                    this->_failed |= 1 << i;
+
+            this->_timestamp = this->_control._hal->now();
+            this->_state = TCS3200_ARRAY_MEASURE;
+            break;
+
+        case TCS3200_ARRAY_MEASURE: {
+            uint32_t elapsed = this->_control._hal->now() - this->_timestamp;
+
+            // The poll at gate close timestamps the final edges
+            for(uint8_t i = 0; i < this->_count; i++)
+                this->_sensors[i].counter.poll();
+
+            if(elapsed < this->_control.integration_time())
+                break;
+
+            for(uint8_t i = 0; i < this->_count; i++) {
+                uint32_t span, periods;
+                uint32_t edges = this->_sensors[i].counter.count(&span, &periods);
+                this->_sensors[i].counter.detach();
+
+                this->store(i, this->_control.edge_pulse_width(edges, periods,
+                    span, elapsed));
+            }
+
+            if(++this->_channel > TCS3200_COLOR_CLEAR) {
+                this->_state = TCS3200_ARRAY_SELECT;
+                this->_active = false;
+                return true;
+            }
+
+            // Switch to the next channel right away to start settling
+            this->_control.select_filter(this->_channel);
+            this->_state = TCS3200_ARRAY_SETTLE;
+            break;
+        }
+    }
+
+    return false;
+}
+
+void TCS3200Array::read_frame() {
+    this->start_frame();
+    while(!this->poll_frame());
+}
+
+RawRGBC TCS3200Array::frame(uint8_t sensor) {
+    return this->_sensors[sensor < this->_count ? sensor : 0].frame;
+}
+
+uint8_t TCS3200Array::failed() {
+    return this->_failed;
+}
+
+void TCS3200Array::store(uint8_t sensor, uint32_t pulse_width) {
+    if(pulse_width > 0)
+        this->_sensors[sensor].frame.valid |= 1 << this->_channel;
+
+    switch(this->_channel) {
+        case TCS3200_COLOR_RED:
+            this->_sensors[sensor].frame.red = pulse_width;
+            break;
+        case TCS3200_COLOR_GREEN:
+            this->_sensors[sensor].frame.green = pulse_width;
+            break;
+        case TCS3200_COLOR_BLUE:
+            this->_sensors[sensor].frame.blue = pulse_width;
+            break;
+        case TCS3200_COLOR_CLEAR:
+            this->_sensors[sensor].frame.clear = pulse_width;
+            break;
+    }
+}
@@ -0,0 +1,248 @@
+/*
+ * This file is part of the TCS3200 Color Sensor Arduino library.
+ * Copyright (c) 2023 Nathanne Isip
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * 
+ * @file TCS3200Array.h
+ * @author [Nathanne Isip](https://github.com/nthnn/TCS3200)
+ * @brief Concurrent sampling of several %TCS3200 sensors sharing S0-S3.
+ *
+ * All sensors of an array share their S0, S1, S2 and S3 lines, and
+ * only their OUT pins are wired separately. The filter is selected
+ * once for the whole array and every OUT pin is edge-counted during
+ * the same gate window, so a frame of N sensors takes about as long
+ * as a frame of a single sensor.
+ *
+ * Each sensor uses one of the `TCS3200_EDGE_COUNTER_SLOTS` interrupt
+ * slots, so that limit may need to be raised for larger arrays. The
+ * per-sensor state lives in a caller-provided buffer, so the class
+ * layout does not depend on that limit.
+ *
+ * **Example usage**:
+ * @code{.cpp}
+ * const uint8_t out_pins[] = {16, 17, 18, 19};
+ * TCS3200ArraySensor states[4];
+ * TCS3200Array sensors(15, 2, 0, 4, out_pins, states, 4);
+ * 
+ * void setup() {
+ *   sensors.begin();
+ *   sensors.frequency_scaling(TCS3200_OFREQ_20P);
+ *   sensors.start_frame();
+ * }
+ * 
+ * void loop() {
+ *   if(sensors.poll_frame()) {
+ *     for(uint8_t i = 0; i < sensors.count(); i++)
+ *       Serial.println(sensors.frame(i).red);
+ *
+ *     sensors.start_frame();
+ *   }
+ * }
+ * @endcode
+ *
+ */
+#ifndef TCS3200_ARRAY_H
+#define TCS3200_ARRAY_H
+
+#include "TCS3200.h"
+
+/**
+ * 
+ * @brief Structure to hold the measurement state of a sensor in an array.
+ * 
+ */
+typedef struct _TCS3200ArraySensor {
+    TCS3200EdgeCounter counter; ///< Edge counter of the sensor's OUT pin
+    RawRGBC frame;              ///< Last measured frame of the sensor
+} TCS3200ArraySensor;
+
+/**
+ * 
+ * @class TCS3200Array
+ * @brief Group of %TCS3200 sensors measured concurrently.
+ * 
+ */
+class TCS3200Array {
+public:
+    /**
+     * 
+     * @brief Constructor for TCS3200Array class.
+     * 
+     * @param s0_pin Arduino pin connected to the shared S0 line.
+     * @param s1_pin Arduino pin connected to the shared S1 line.
+     * @param s2_pin Arduino pin connected to the shared S2 line.
+     * @param s3_pin Arduino pin connected to the shared S3 line.
+     * @param out_pins Arduino pins connected to the OUT pin of each sensor.
+     * @param sensors Buffer of `count` sensor states.
+     * @param count Number of sensors, up to `TCS3200_EDGE_COUNTER_SLOTS`.
+     * 
+     */
+    TCS3200Array(uint8_t s0_pin, uint8_t s1_pin, uint8_t s2_pin, uint8_t s3_pin,
+        const uint8_t *out_pins, TCS3200ArraySensor *sensors, uint8_t count);
+
+    /**
+     * 
+     * @brief Initialize the sensors and configure pins.
+     * 
+     */
+    void begin();
+
+    /**
+     * 
+     * @brief Drive the sensors through another HAL.
+     *
+     * This must be called before `begin()`.
+     * 
+     * @param hal HAL the pins and clock are accessed through.
+     * 
+     */
+    void hal(TCS3200HAL *hal);
+
+    /**
+     * 
+     * @brief Get the number of sensors in the array.
+     * 
+     * @return Number of sensors.
+     * 
+     */
+    uint8_t count();
+
+    /**
+     * 
+     * @brief Set the frequency scaling of all sensors.
+     * 
+     * @param scaling Frequency scaling value.
+     * 
+     */
+    void frequency_scaling(int scaling);
+
+    /**
+     * 
+     * @brief Get the frequency scaling of all sensors.
+     * 
+     * @return Frequency scaling value.
+     * 
+     */
+    int frequency_scaling();
+
+    /**
+     * 
+     * @brief Set the gate window of each channel measurement.
+     * 
+     * @param time Integration time in microseconds.
+     * 
+     */
+    void integration_time(unsigned int time);
+
+    /**
+     * 
+     * @brief Get the gate window of each channel measurement.
+     * 
+     * @return Integration time in microseconds.
+     * 
+     */
+    unsigned int integration_time();
+
+    /**
+     * 
+     * @brief Set the time to wait after switching the color filter,
+     *        for every frequency scaling.
+     * 
+     * @param time Settling time in microseconds.
+     * 
+     */
+    void settling_time(unsigned int time);
+
+    /**
+     * 
+     * @brief Get the time to wait after switching the color filter.
+     * 
+     * @return Settling time in microseconds.
+     * 
+     */
+    unsigned int settling_time();
+
+    /**
+     * 
+     * @brief Start measuring a frame of every sensor.
+     *
+     * Call `poll_frame()` repeatedly until it returns `true`.
+     * 
+     */
+    void start_frame();
+
+    /**
+     * 
+     * @brief Advance the frame measurement without blocking.
+     * 
+     * @return `true` once all channels of all sensors have been
+     *         measured, `false` while the frame is in progress.
+     * 
+     */
+    bool poll_frame();
+
+    /**
+     * 
+     * @brief Measure a frame of every sensor, blocking until done.
+     * 
+     */
+    void read_frame();
+
+    /**
+     * 
+     * @brief Get the last measured frame of a sensor.
+     * 
+     * @param sensor Index of the sensor in the array.
+     * 
+     * @return `RawRGBC` of the sensor.
+     * 
+     */
+    RawRGBC frame(uint8_t sensor);
+
+    /**
+     * 
+     * @brief Get the sensors whose OUT pin could not be counted.
+     *
+     * A sensor fails when its OUT pin has no interrupt or no
+     * `TCS3200_EDGE_COUNTER_SLOTS` slot is left for it. The channels
+     * of a failed sensor are not marked valid in its frame.
+     * 
+     * @return Bit n is set if sensor n failed during the last frame.
+     * 
+     */
+    uint8_t failed();
+
+private:
+    TCS3200 _control;
+    const uint8_t *_out_pins;
+    TCS3200ArraySensor *_sensors;
+    uint8_t _count;
+
+    bool _active;
+    uint8_t _state, _channel, _failed;
+    uint32_t _timestamp;
+
+    void store(uint8_t sensor, uint32_t pulse_width);
+};
+
+#endif
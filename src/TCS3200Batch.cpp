@@ -0,0 +1,306 @@
+/*
+ * This file is part of the TCS3200 Color Sensor Arduino library.
+ * Copyright (c) 2023 Nathanne Isip
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "TCS3200Batch.h"
+
+#if TCS3200_BATCH_SIMD && defined(__SSE2__)
+#include <emmintrin.h>
+#elif TCS3200_BATCH_SIMD && defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+#include <string.h>
+
+// Coefficients of the linear sRGB to CIE 1931 XYZ (D65) matrix, as in TCS3200::rgb_to_cie1931()
+static const float tcs3200_xyz_matrix[3][3] = {
+    {0.4124564f, 0.3575761f, 0.1804375f},
+    {0.2126729f, 0.7151522f, 0.0721750f},
+    {0.0193339f, 0.1191920f, 0.9503041f}
+};
+
+static inline size_t tcs3200_block_size(size_t remaining) {
+    return remaining < TCS3200_BATCH_BLOCK ? remaining : TCS3200_BATCH_BLOCK;
+}
+
+static inline float tcs3200_batch_cbrt(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    // Same approximation as the per-sample conversion
+    bits = bits / 3 + 709921077UL;
+
+    float root;
+    memcpy(&root, &bits, sizeof(root));
+
+    root = (2.0f * root + value / (root * root)) * (1.0f / 3.0f);
+    root = (2.0f * root + value / (root * root)) * (1.0f / 3.0f);
+
+    return root;
+}
+
+static inline float tcs3200_batch_lab_f(float t) {
+    float root = tcs3200_batch_cbrt(t);
+    float linear = 7.787037f * t + 0.137931f;
+
+    // Both sides are blended on their bit patterns, and finite floats
+    // order like their bit patterns read as signed integers; nothing
+    // here can trap, so the compiler does not turn it back into a branch
+    int32_t t_bits, root_bits, linear_bits;
+    memcpy(&t_bits, &t, sizeof(t_bits));
+    memcpy(&root_bits, &root, sizeof(root_bits));
+    memcpy(&linear_bits, &linear, sizeof(linear_bits));
+
+    int32_t mask = -(int32_t) (t_bits > 0x3c1118c2L);   // t > 0.008856f
+    int32_t bits = (root_bits & mask) | (linear_bits & ~mask);
+
+    float result;
+    memcpy(&result, &bits, sizeof(result));
+
+    return result;
+}
+
+void tcs3200_deinterleave_rgb(const RGBColor *colors, uint8_t *red, uint8_t *green, uint8_t *blue, size_t count) {
+    for(size_t i = 0; i < count; i++) {
+        red[i] = colors[i].red;
+        green[i] = colors[i].green;
+        blue[i] = colors[i].blue;
+    }
+}
+
+void convert_rgb_to_hsv(const uint8_t *TCS3200_RESTRICT red, const uint8_t *TCS3200_RESTRICT green,
+    const uint8_t *TCS3200_RESTRICT blue, float *TCS3200_RESTRICT hue,
+    float *TCS3200_RESTRICT saturation, float *TCS3200_RESTRICT value, size_t count) {
+    for(size_t i = 0; i < count; i++) {
+        int r_int = red[i], g_int = green[i], b_int = blue[i];
+
+        int max_int = r_int > g_int ? r_int : g_int;
+        max_int = max_int > b_int ? max_int : b_int;
+
+        int min_int = r_int < g_int ? r_int : g_int;
+        min_int = min_int < b_int ? min_int : b_int;
+
+        float r = r_int / 255.0f;
+        float g = g_int / 255.0f;
+        float b = b_int / 255.0f;
+
+        float max_val = max_int / 255.0f;
+        float min_val = min_int / 255.0f;
+        float delta = max_val - min_val;
+
+        // The hue sector is picked by multiplying with 0 or 1 instead of
+        // branching, and divisors get 1 added where they would be 0; the
+        // loop then has no control flow and the results stay identical
+        // to TCS3200::rgb_to_hsv()
+        int is_red = max_int == r_int;
+        int is_green = !is_red & (max_int == g_int);
+        int is_blue = !is_red & !is_green;
+
+        float numerator = is_red * (g - b) + is_green * (b - r) + is_blue * (r - g);
+        float h = (2 * is_green + 4 * is_blue + numerator / (delta + (max_int == min_int))) * 60.0f;
+
+        hue[i] = h + 360 * (is_red & (g_int < b_int));
+        saturation[i] = delta / (max_val + (max_int == 0));
+        value[i] = max_val;
+    }
+}
+
+void convert_rgb_to_hsv(const RGBColor *colors, HSVColor *hsv, size_t count) {
+    uint8_t red[TCS3200_BATCH_BLOCK], green[TCS3200_BATCH_BLOCK], blue[TCS3200_BATCH_BLOCK];
+    float hue[TCS3200_BATCH_BLOCK], saturation[TCS3200_BATCH_BLOCK], value[TCS3200_BATCH_BLOCK];
+
+    for(size_t first = 0; first < count; first += TCS3200_BATCH_BLOCK) {
+        size_t size = tcs3200_block_size(count - first);
+
+        tcs3200_deinterleave_rgb(colors + first, red, green, blue, size);
+        convert_rgb_to_hsv(red, green, blue, hue, saturation, value, size);
+
+        for(size_t i = 0; i < size; i++) {
+            hsv[first + i].hue = hue[i];
+            hsv[first + i].saturation = saturation[i];
+            hsv[first + i].value = value[i];
+        }
+    }
+}
+
+void convert_rgb_to_cie1931(const uint8_t *TCS3200_RESTRICT red, const uint8_t *TCS3200_RESTRICT green,
+    const uint8_t *TCS3200_RESTRICT blue, float *TCS3200_RESTRICT x,
+    float *TCS3200_RESTRICT y, float *TCS3200_RESTRICT z, size_t count) {
+    const float (*m)[3] = tcs3200_xyz_matrix;
+    size_t i = 0;
+
+#if TCS3200_BATCH_SIMD && defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 scale = _mm_set1_ps(255.0f);
+
+    for(; i + 4 <= count; i += 4) {
+        int32_t packed[3];
+        memcpy(&packed[0], red + i, 4);
+        memcpy(&packed[1], green + i, 4);
+        memcpy(&packed[2], blue + i, 4);
+
+        __m128 channels[3];
+        for(uint8_t c = 0; c < 3; c++) {
+            __m128i bytes = _mm_cvtsi32_si128(packed[c]);
+            __m128i words = _mm_unpacklo_epi16(_mm_unpacklo_epi8(bytes, zero), zero);
+
+            channels[c] = _mm_div_ps(_mm_cvtepi32_ps(words), scale);
+        }
+
+        float *outputs[3] = {x, y, z};
+        for(uint8_t row = 0; row < 3; row++) {
+            __m128 sum = _mm_add_ps(
+                _mm_add_ps(
+                    _mm_mul_ps(_mm_set1_ps(m[row][0]), channels[0]),
+                    _mm_mul_ps(_mm_set1_ps(m[row][1]), channels[1])),
+                _mm_mul_ps(_mm_set1_ps(m[row][2]), channels[2]));
+
+            _mm_storeu_ps(outputs[row] + i, sum);
+        }
+    }
+#elif TCS3200_BATCH_SIMD && defined(__ARM_NEON) && defined(__aarch64__)
+    const float32x4_t scale = vdupq_n_f32(255.0f);
+
+    for(; i + 8 <= count; i += 8) {
+        const uint8_t *inputs[3] = {red + i, green + i, blue + i};
+        float32x4_t low[3], high[3];
+
+        for(uint8_t c = 0; c < 3; c++) {
+            uint16x8_t words = vmovl_u8(vld1_u8(inputs[c]));
+
+            low[c] = vdivq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(words))), scale);
+            high[c] = vdivq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(words))), scale);
+        }
+
+        float *outputs[3] = {x, y, z};
+        for(uint8_t row = 0; row < 3; row++) {
+            float32x4_t c0 = vdupq_n_f32(m[row][0]);
+            float32x4_t c1 = vdupq_n_f32(m[row][1]);
+            float32x4_t c2 = vdupq_n_f32(m[row][2]);
+
+            // Separate multiplies and adds round like the scalar path
+            vst1q_f32(outputs[row] + i, vaddq_f32(
+                vaddq_f32(vmulq_f32(c0, low[0]), vmulq_f32(c1, low[1])),
+                vmulq_f32(c2, low[2])));
+            vst1q_f32(outputs[row] + i + 4, vaddq_f32(
+                vaddq_f32(vmulq_f32(c0, high[0]), vmulq_f32(c1, high[1])),
+                vmulq_f32(c2, high[2])));
+        }
+    }
+#endif
+
+    for(; i < count; i++) {
+        float r = red[i] / 255.0f;
+        float g = green[i] / 255.0f;
+        float b = blue[i] / 255.0f;
+
+        x[i] = m[0][0] * r + m[0][1] * g + m[0][2] * b;
+        y[i] = m[1][0] * r + m[1][1] * g + m[1][2] * b;
+        z[i] = m[2][0] * r + m[2][1] * g + m[2][2] * b;
+    }
+}
+
+void convert_rgb_to_cie1931(const RGBColor *colors, CIE1931Color *cie1931, size_t count) {
+    uint8_t red[TCS3200_BATCH_BLOCK], green[TCS3200_BATCH_BLOCK], blue[TCS3200_BATCH_BLOCK];
+    float x[TCS3200_BATCH_BLOCK], y[TCS3200_BATCH_BLOCK], z[TCS3200_BATCH_BLOCK];
+
+    for(size_t first = 0; first < count; first += TCS3200_BATCH_BLOCK) {
+        size_t size = tcs3200_block_size(count - first);
+
+        tcs3200_deinterleave_rgb(colors + first, red, green, blue, size);
+        convert_rgb_to_cie1931(red, green, blue, x, y, z, size);
+
+        for(size_t i = 0; i < size; i++) {
+            cie1931[first + i].x = x[i];
+            cie1931[first + i].y = y[i];
+            cie1931[first + i].z = z[i];
+        }
+    }
+}
+
+void convert_cie1931_to_cielab(const float *TCS3200_RESTRICT x, const float *TCS3200_RESTRICT y,
+    const float *TCS3200_RESTRICT z, float *TCS3200_RESTRICT l,
+    float *TCS3200_RESTRICT a, float *TCS3200_RESTRICT b, size_t count) {
+    for(size_t i = 0; i < count; i++) {
+        float fx = tcs3200_batch_lab_f(x[i] / 0.95047f);
+        float fy = tcs3200_batch_lab_f(y[i]);
+        float fz = tcs3200_batch_lab_f(z[i] / 1.08883f);
+
+        l[i] = 116.0f * fy - 16.0f;
+        a[i] = 500.0f * (fx - fy);
+        b[i] = 200.0f * (fy - fz);
+    }
+}
+
+void convert_cie1931_to_cielab(const CIE1931Color *cie1931, CIELabColor *cielab, size_t count) {
+    float x[TCS3200_BATCH_BLOCK], y[TCS3200_BATCH_BLOCK], z[TCS3200_BATCH_BLOCK];
+    float l[TCS3200_BATCH_BLOCK], a[TCS3200_BATCH_BLOCK], b[TCS3200_BATCH_BLOCK];
+
+    for(size_t first = 0; first < count; first += TCS3200_BATCH_BLOCK) {
+        size_t size = tcs3200_block_size(count - first);
+
+        for(size_t i = 0; i < size; i++) {
+            x[i] = cie1931[first + i].x;
+            y[i] = cie1931[first + i].y;
+            z[i] = cie1931[first + i].z;
+        }
+
+        convert_cie1931_to_cielab(x, y, z, l, a, b, size);
+
+        for(size_t i = 0; i < size; i++) {
+            cielab[first + i].l = l[i];
+            cielab[first + i].a = a[i];
+            cielab[first + i].b = b[i];
+        }
+    }
+}
+
+void convert_rgb_to_cielab(const uint8_t *TCS3200_RESTRICT red, const uint8_t *TCS3200_RESTRICT green,
+    const uint8_t *TCS3200_RESTRICT blue, float *TCS3200_RESTRICT l,
+    float *TCS3200_RESTRICT a, float *TCS3200_RESTRICT b, size_t count) {
+    float x[TCS3200_BATCH_BLOCK], y[TCS3200_BATCH_BLOCK], z[TCS3200_BATCH_BLOCK];
+
+    for(size_t first = 0; first < count; first += TCS3200_BATCH_BLOCK) {
+        size_t size = tcs3200_block_size(count - first);
+
+        convert_rgb_to_cie1931(red + first, green + first, blue + first, x, y, z, size);
+        convert_cie1931_to_cielab(x, y, z, l + first, a + first, b + first, size);
+    }
+}
+
+void convert_rgb_to_cielab(const RGBColor *colors, CIELabColor *cielab, size_t count) {
+    uint8_t red[TCS3200_BATCH_BLOCK], green[TCS3200_BATCH_BLOCK], blue[TCS3200_BATCH_BLOCK];
+    float l[TCS3200_BATCH_BLOCK], a[TCS3200_BATCH_BLOCK], b[TCS3200_BATCH_BLOCK];
+
+    for(size_t first = 0; first < count; first += TCS3200_BATCH_BLOCK) {
+        size_t size = tcs3200_block_size(count - first);
+
+        tcs3200_deinterleave_rgb(colors + first, red, green, blue, size);
+        convert_rgb_to_cielab(red, green, blue, l, a, b, size);
+
+        for(size_t i = 0; i < size; i++) {
+            cielab[first + i].l = l[i];
+            cielab[first + i].a = a[i];
+            cielab[first + i].b = b[i];
+        }
+    }
+}
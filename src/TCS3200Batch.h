@@ -0,0 +1,207 @@
+/*
+ * This file is part of the TCS3200 Color Sensor Arduino library.
+ * Copyright (c) 2023 Nathanne Isip
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * 
+ * @file TCS3200Batch.h
+ * @author [Nathanne Isip](https://github.com/nthnn/TCS3200)
+ * @brief Color space conversions over arrays of samples.
+ *
+ * These functions convert whole arrays of logged readings without
+ * touching the sensor, for post-processing samples in bulk. Each
+ * conversion takes either an array of color structures or separate
+ * arrays per channel (structure of arrays). The channel loops are
+ * branch-free so the compiler can vectorize them. Only the RGB to
+ * CIE 1931 conversion has SSE2 and NEON paths; the HSV and CIE
+ * L*a*b* conversions are scalar code left to the compiler's
+ * auto-vectorizer (the cube roots of L*a*b* stay scalar calls).
+ * Arrays of structures are converted in blocks of
+ * `TCS3200_BATCH_BLOCK` samples through channel arrays on the stack.
+ *
+ * The results are identical to the floating-point `TCS3200::rgb_to_hsv()`,
+ * `TCS3200::rgb_to_cie1931()` and `TCS3200::cie1931_to_cielab()`,
+ * unless the compiler fuses multiply-adds differently in the two.
+ * They are always computed in floating-point, even when
+ * `TCS3200_FIXED_POINT` is enabled. The arrays passed to one call
+ * must not overlap.
+ *
+ * **Example usage**:
+ * @code{.cpp}
+ * RGBColor log[LOG_SIZE];
+ * CIELabColor lab[LOG_SIZE];
+ * 
+ * void process() {
+ *   convert_rgb_to_cielab(log, lab, LOG_SIZE);
+ * }
+ * @endcode
+ *
+ */
+#ifndef TCS3200_BATCH_H
+#define TCS3200_BATCH_H
+
+#include "TCS3200.h"
+
+#ifndef TCS3200_BATCH_BLOCK
+#ifdef __AVR__
+#define TCS3200_BATCH_BLOCK 8   ///< Samples converted per block of the array of structures variants
+#else
+#define TCS3200_BATCH_BLOCK 64  ///< Samples converted per block of the array of structures variants
+#endif
+#endif
+
+#if defined(__GNUC__)
+#define TCS3200_RESTRICT __restrict__   ///< Marks arrays that do not overlap any other argument
+#else
+#define TCS3200_RESTRICT
+#endif
+
+#ifndef TCS3200_BATCH_SIMD
+#define TCS3200_BATCH_SIMD 1    ///< Use SSE2 or NEON intrinsics where available
+#endif
+
+/**
+ * 
+ * @brief Split an array of RGB colors into one array per channel.
+ * 
+ * @param colors Array of `count` colors.
+ * @param red Output array of `count` red values.
+ * @param green Output array of `count` green values.
+ * @param blue Output array of `count` blue values.
+ * @param count Number of colors.
+ * 
+ */
+void tcs3200_deinterleave_rgb(const RGBColor *colors, uint8_t *red, uint8_t *green, uint8_t *blue, size_t count);
+
+/**
+ * 
+ * @brief Convert an array of RGB colors to the HSV color space.
+ * 
+ * @param colors Array of `count` colors.
+ * @param hsv Output array of `count` HSV colors.
+ * @param count Number of colors.
+ * 
+ */
+void convert_rgb_to_hsv(const RGBColor *colors, HSVColor *hsv, size_t count);
+
+/**
+ * 
+ * @brief Convert RGB channel arrays to HSV channel arrays.
+ * 
+ * @param red Array of `count` red values.
+ * @param green Array of `count` green values.
+ * @param blue Array of `count` blue values.
+ * @param hue Output array of `count` hues in degrees.
+ * @param saturation Output array of `count` saturations (0-1).
+ * @param value Output array of `count` values (0-1).
+ * @param count Number of colors.
+ * 
+ */
+void convert_rgb_to_hsv(const uint8_t *TCS3200_RESTRICT red, const uint8_t *TCS3200_RESTRICT green,
+    const uint8_t *TCS3200_RESTRICT blue, float *TCS3200_RESTRICT hue,
+    float *TCS3200_RESTRICT saturation, float *TCS3200_RESTRICT value, size_t count);
+
+/**
+ * 
+ * @brief Convert an array of RGB colors to the CIE 1931 XYZ color space.
+ * 
+ * @param colors Array of `count` colors.
+ * @param cie1931 Output array of `count` CIE 1931 colors.
+ * @param count Number of colors.
+ * 
+ */
+void convert_rgb_to_cie1931(const RGBColor *colors, CIE1931Color *cie1931, size_t count);
+
+/**
+ * 
+ * @brief Convert RGB channel arrays to CIE 1931 XYZ channel arrays.
+ * 
+ * @param red Array of `count` red values.
+ * @param green Array of `count` green values.
+ * @param blue Array of `count` blue values.
+ * @param x Output array of `count` X values.
+ * @param y Output array of `count` Y values.
+ * @param z Output array of `count` Z values.
+ * @param count Number of colors.
+ * 
+ */
+void convert_rgb_to_cie1931(const uint8_t *TCS3200_RESTRICT red, const uint8_t *TCS3200_RESTRICT green,
+    const uint8_t *TCS3200_RESTRICT blue, float *TCS3200_RESTRICT x,
+    float *TCS3200_RESTRICT y, float *TCS3200_RESTRICT z, size_t count);
+
+/**
+ * 
+ * @brief Convert an array of CIE 1931 XYZ colors to the CIE L*a*b* color space.
+ * 
+ * @param cie1931 Array of `count` CIE 1931 colors.
+ * @param cielab Output array of `count` CIE L*a*b* colors.
+ * @param count Number of colors.
+ * 
+ */
+void convert_cie1931_to_cielab(const CIE1931Color *cie1931, CIELabColor *cielab, size_t count);
+
+/**
+ * 
+ * @brief Convert CIE 1931 XYZ channel arrays to CIE L*a*b* channel arrays.
+ * 
+ * @param x Array of `count` X values.
+ * @param y Array of `count` Y values.
+ * @param z Array of `count` Z values.
+ * @param l Output array of `count` L* values.
+ * @param a Output array of `count` a* values.
+ * @param b Output array of `count` b* values.
+ * @param count Number of colors.
+ * 
+ */
+void convert_cie1931_to_cielab(const float *TCS3200_RESTRICT x, const float *TCS3200_RESTRICT y,
+    const float *TCS3200_RESTRICT z, float *TCS3200_RESTRICT l,
+    float *TCS3200_RESTRICT a, float *TCS3200_RESTRICT b, size_t count);
+
+/**
+ * 
+ * @brief Convert an array of RGB colors to the CIE L*a*b* color space.
+ * 
+ * @param colors Array of `count` colors.
+ * @param cielab Output array of `count` CIE L*a*b* colors.
+ * @param count Number of colors.
+ * 
+ */
+void convert_rgb_to_cielab(const RGBColor *colors, CIELabColor *cielab, size_t count);
+
+/**
+ * 
+ * @brief Convert RGB channel arrays to CIE L*a*b* channel arrays.
+ * 
+ * @param red Array of `count` red values.
+ * @param green Array of `count` green values.
+ * @param blue Array of `count` blue values.
+ * @param l Output array of `count` L* values.
+ * @param a Output array of `count` a* values.
+ * @param b Output array of `count` b* values.
+ * @param count Number of colors.
+ * 
+ */
+void convert_rgb_to_cielab(const uint8_t *TCS3200_RESTRICT red, const uint8_t *TCS3200_RESTRICT green,
+    const uint8_t *TCS3200_RESTRICT blue, float *TCS3200_RESTRICT l,
+    float *TCS3200_RESTRICT a, float *TCS3200_RESTRICT b, size_t count);
+
+#endif
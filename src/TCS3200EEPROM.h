@@ -0,0 +1,88 @@
+/*
+ * This file is part of the TCS3200 Color Sensor Arduino library.
+ * Copyright (c) 2023 Nathanne Isip
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * 
+ * @file TCS3200EEPROM.h
+ * @author [Nathanne Isip](https://github.com/nthnn/TCS3200)
+ * @brief EEPROM storage backend for %TCS3200 calibration profiles.
+ *
+ * On ESP32 and ESP8266 boards, `EEPROM.begin()` must be called with
+ * a large enough size before saving or loading a profile.
+ *
+ * **Example usage**:
+ * @code{.cpp}
+ * TCS3200EEPROMStorage storage;
+ * 
+ * if(!tcs3200.load_calibration(storage)) {
+ *   tcs3200.calibrate_light();
+ *   tcs3200.calibrate_dark();
+ *   tcs3200.calibrate();
+ *   tcs3200.save_calibration(storage);
+ * }
+ * @endcode
+ *
+ */
+#ifndef TCS3200_EEPROM_H
+#define TCS3200_EEPROM_H
+
+#include <EEPROM.h>
+#include "TCS3200.h"
+
+/**
+ * 
+ * @class TCS3200EEPROMStorage
+ * @brief Calibration profile storage backed by the Arduino EEPROM library.
+ * 
+ */
+class TCS3200EEPROMStorage : public TCS3200Storage {
+public:
+    bool read(uint16_t address, uint8_t *data, uint16_t length) {
+        if((uint32_t) address + length > EEPROM.length())
+            return false;
+
+        for(uint16_t i = 0; i < length; i++)
+            data[i] = EEPROM.read(address + i);
+
+        return true;
+    }
+
+    bool write(uint16_t address, const uint8_t *data, uint16_t length) {
+        if((uint32_t) address + length > EEPROM.length())
+            return false;
+
+#if defined(ESP32) || defined(ESP8266)
+        for(uint16_t i = 0; i < length; i++)
+            EEPROM.write(address + i, data[i]);
+
+        return EEPROM.commit();
+#else
+        for(uint16_t i = 0; i < length; i++)
+            EEPROM.update(address + i, data[i]);
+
+        return true;
+#endif
+    }
+};
+
+#endif
@@ -0,0 +1,165 @@
+/*
+ * This file is part of the TCS3200 Color Sensor Arduino library.
+ * Copyright (c) 2023 Nathanne Isip
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * 
+ * @file TCS3200Fast.h
+ * @author [Nathanne Isip](https://github.com/nthnn/TCS3200)
+ * @brief Sensor with compile-time pins and direct port writes.
+ *
+ * `TCS3200T` takes its pins as template parameters. On the ATmega328P
+ * and ATmega168 boards (Uno, Nano, Pro Mini) the port registers and
+ * bit masks of the S2 and S3 filter select pins are template
+ * constants from the standard pin mapping, so writing one of them
+ * compiles to a single `sbi` or `cbi` instruction instead of a
+ * `digitalWrite()` call, and invalid pins are rejected when
+ * compiling. When S2 and S3 share a port, switching filters updates
+ * both pins with a single store. Other boards write the pins through
+ * the Arduino core.
+ *
+ * `TCS3200T` is a `TCS3200`, so it is a drop-in replacement with the
+ * same API. Features a sketch never calls are already left out of
+ * the firmware by the linker, for either class.
+ *
+ * **Example usage**:
+ * @code{.cpp}
+ * TCS3200T<4, 5, 6, 7, 8> tcs3200;
+ * 
+ * void setup() {
+ *   tcs3200.begin();
+ *   tcs3200.frequency_scaling(TCS3200_OFREQ_20P);
+ * }
+ * @endcode
+ *
+ */
+#ifndef TCS3200_FAST_H
+#define TCS3200_FAST_H
+
+#include "TCS3200.h"
+
+#if defined(__AVR_ATmega328P__) || defined(__AVR_ATmega328__) || \
+    defined(__AVR_ATmega168__) || defined(__AVR_ATmega168P__)
+#define TCS3200_STATIC_PORTS 1  ///< Pin registers are known at compile time
+
+// Data space addresses of PORTD (pins 0-7), PORTB (8-13) and PORTC (14-19)
+constexpr uint16_t tcs3200_port_address(uint8_t pin) {
+    return pin < 8 ? 0x2b : (pin < 14 ? 0x25 : 0x28);
+}
+
+constexpr uint8_t tcs3200_port_mask(uint8_t pin) {
+    return 1 << (pin < 8 ? pin : (pin < 14 ? pin - 8 : pin - 14));
+}
+#else
+#define TCS3200_STATIC_PORTS 0  ///< Pin registers are known at compile time
+#endif
+
+/**
+ * 
+ * @class TCS3200T
+ * @brief %TCS3200 with its pins fixed at compile time.
+ *
+ * The sensor is its own HAL for the S2 and S3 pins: writes to them
+ * go straight to their port registers, every other pin and the clock
+ * go through the Arduino core. The S2 and S3 pins must not be used
+ * for PWM.
+ * 
+ * @tparam S0 S0 pin number.
+ * @tparam S1 S1 pin number.
+ * @tparam S2 S2 pin number.
+ * @tparam S3 S3 pin number.
+ * @tparam OUT OUT pin number.
+ * 
+ */
+template<uint8_t S0, uint8_t S1, uint8_t S2, uint8_t S3, uint8_t OUT>
+class TCS3200T : public TCS3200, private TCS3200ArduinoHAL {
+    static_assert(S0 != S1 && S0 != S2 && S0 != S3 && S0 != OUT &&
+        S1 != S2 && S1 != S3 && S1 != OUT &&
+        S2 != S3 && S2 != OUT && S3 != OUT,
+        "TCS3200T pins must be distinct");
+
+#if TCS3200_STATIC_PORTS
+    static_assert(S0 < 20 && S1 < 20 && S2 < 20 && S3 < 20 && OUT < 20,
+        "TCS3200T pins must be digital pins 0-19");
+#endif
+
+public:
+    /**
+     * 
+     * @brief Constructor for TCS3200T class.
+     *
+     * `hal()` still replaces the direct writes with another HAL, e.g.
+     * a simulated sensor.
+     * 
+     */
+    TCS3200T():
+        TCS3200(S0, S1, S2, S3, OUT) {
+#if TCS3200_STATIC_PORTS
+        this->hal(static_cast<TCS3200HAL *>(this));
+#endif
+    }
+
+#if TCS3200_STATIC_PORTS
+private:
+    template<uint8_t PIN>
+    static volatile uint8_t &port() {
+        return *(volatile uint8_t *) (uintptr_t) tcs3200_port_address(PIN);
+    }
+
+    template<uint8_t PIN>
+    static void write(uint8_t value) {
+        if(value == LOW)
+            TCS3200T::port<PIN>() &= ~tcs3200_port_mask(PIN);
+        else TCS3200T::port<PIN>() |= tcs3200_port_mask(PIN);
+    }
+
+    void digital_write(uint8_t pin, uint8_t value) {
+        if(pin == S2)
+            TCS3200T::write<S2>(value);
+        else if(pin == S3)
+            TCS3200T::write<S3>(value);
+        else TCS3200ArduinoHAL::digital_write(pin, value);
+    }
+
+    void digital_write_pair(uint8_t first_pin, uint8_t first_value,
+        uint8_t second_pin, uint8_t second_value) {
+        if(tcs3200_port_address(S2) == tcs3200_port_address(S3) &&
+            first_pin == S2 && second_pin == S3) {
+            const uint8_t mask = tcs3200_port_mask(S2) | tcs3200_port_mask(S3);
+            uint8_t set = (first_value != LOW ? tcs3200_port_mask(S2) : 0) |
+                (second_value != LOW ? tcs3200_port_mask(S3) : 0);
+            uint8_t sreg = SREG;
+            cli();
+
+            // Both pins share the port, so they switch in the same store
+            TCS3200T::port<S2>() = (TCS3200T::port<S2>() & ~mask) | set;
+
+            SREG = sreg;
+            return;
+        }
+
+        TCS3200HAL::digital_write_pair(first_pin, first_value, second_pin, second_value);
+    }
+#endif
+};
+
+#endif
@@ -0,0 +1,101 @@
+/*
+ * This file is part of the TCS3200 Color Sensor Arduino library.
+ * Copyright (c) 2023 Nathanne Isip
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * 
+ * @file TCS3200File.h
+ * @author [Nathanne Isip](https://github.com/nthnn/TCS3200)
+ * @brief File storage backend for %TCS3200 calibration profiles.
+ *
+ * Stores calibration profiles in a file through the C standard I/O
+ * functions, for Linux hosts and for boards whose core maps them to
+ * a file system, such as ESP32 with SPIFFS or LittleFS mounted.
+ * The file is created on the first write.
+ *
+ * **Example usage**:
+ * @code{.cpp}
+ * TCS3200FileStorage storage("/spiffs/tcs3200.cal");
+ * 
+ * if(!tcs3200.load_calibration(storage)) {
+ *   tcs3200.calibrate_light();
+ *   tcs3200.calibrate_dark();
+ *   tcs3200.calibrate();
+ *   tcs3200.save_calibration(storage);
+ * }
+ * @endcode
+ *
+ */
+#ifndef TCS3200_FILE_H
+#define TCS3200_FILE_H
+
+#include <stdio.h>
+#include "TCS3200.h"
+
+/**
+ * 
+ * @class TCS3200FileStorage
+ * @brief Calibration profile storage backed by a file.
+ * 
+ */
+class TCS3200FileStorage : public TCS3200Storage {
+public:
+    /**
+     * 
+     * @brief Constructor for TCS3200FileStorage class.
+     * 
+     * @param path Path of the file, which must outlive the storage.
+     * 
+     */
+    TCS3200FileStorage(const char *path):
+        _path(path) { }
+
+    bool read(uint16_t address, uint8_t *data, uint16_t length) {
+        FILE *file = fopen(this->_path, "rb");
+        if(file == nullptr)
+            return false;
+
+        bool done = fseek(file, address, SEEK_SET) == 0 &&
+            fread(data, 1, length, file) == length;
+
+        fclose(file);
+        return done;
+    }
+
+    bool write(uint16_t address, const uint8_t *data, uint16_t length) {
+        FILE *file = fopen(this->_path, "r+b");
+        if(file == nullptr)
+            file = fopen(this->_path, "w+b");
+        if(file == nullptr)
+            return false;
+
+        bool done = fseek(file, address, SEEK_SET) == 0 &&
+            fwrite(data, 1, length, file) == length;
+
+        return fclose(file) == 0 && done;
+    }
+
+private:
+    const char *_path;
+};
+
+#endif
@@ -0,0 +1,299 @@
+/*
+ * This file is part of the TCS3200 Color Sensor Arduino library.
+ * Copyright (c) 2023 Nathanne Isip
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * 
+ * @file TCS3200Filters.h
+ * @author [Nathanne Isip](https://github.com/nthnn/TCS3200)
+ * @brief Streaming filters for smoothing %TCS3200 channel readings.
+ *
+ * Filters keep a separate state for each of the four color channels
+ * and run on the raw pulse widths before they are normalized. They
+ * can be chained with `TCS3200::attach_filter()`, in which case the
+ * output of each filter is fed to the next one. None of the filters
+ * allocate memory; window sizes are template parameters.
+ *
+ * **Example usage**:
+ * @code{.cpp}
+ * TCS3200MedianFilter<5> spikes;
+ * TCS3200EMAFilter smoothing(64);
+ * 
+ * void setup() {
+ *   tcs3200.begin();
+ *   tcs3200.attach_filter(&spikes);
+ *   tcs3200.attach_filter(&smoothing);
+ * }
+ * @endcode
+ *
+ */
+#ifndef TCS3200_FILTERS_H
+#define TCS3200_FILTERS_H
+
+#include "TCS3200.h"
+
+/**
+ * 
+ * @class TCS3200Filter
+ * @brief Base class of the streaming channel filters.
+ * 
+ */
+class TCS3200Filter {
+public:
+    TCS3200Filter(): next(nullptr) { }
+
+    /**
+     * 
+     * @brief Feed a reading to the filter.
+     * 
+     * @param channel Color channel of the reading (e.g. `TCS3200_COLOR_RED`).
+     * @param value Raw pulse width in microseconds.
+     * 
+     * @return Filtered pulse width in microseconds.
+     * 
+     */
+    virtual uint32_t update(uint8_t channel, uint32_t value) = 0;
+
+    /**
+     * 
+     * @brief Forget all previous readings.
+     * 
+     */
+    virtual void reset() = 0;
+
+    TCS3200Filter *next;    ///< Next filter of the pipeline
+};
+
+/**
+ * 
+ * @class TCS3200MovingAverage
+ * @brief Mean of the last `window` readings, updated in constant time.
+ * 
+ * @tparam window Number of readings to be averaged.
+ * 
+ */
+template <uint8_t window>
+class TCS3200MovingAverage : public TCS3200Filter {
+public:
+    TCS3200MovingAverage() {
+        this->reset();
+    }
+
+    uint32_t update(uint8_t channel, uint32_t value) {
+        uint8_t &count = this->_count[channel & 0x03];
+        uint32_t *values = this->_values[channel & 0x03];
+        uint32_t &sum = this->_sum[channel & 0x03];
+        uint8_t &index = this->_index[channel & 0x03];
+
+        if(count < window)
+            count++;
+        else sum -= values[index];
+
+        values[index] = value;
+        sum += value;
+
+        if(++index == window)
+            index = 0;
+
+        return sum / count;
+    }
+
+    void reset() {
+        for(uint8_t i = 0; i < 4; i++)
+            this->_count[i] = this->_index[i] = this->_sum[i] = 0;
+    }
+
+private:
+    uint32_t _values[4][window];
+    uint32_t _sum[4];
+    uint8_t _count[4], _index[4];
+};
+
+/**
+ * 
+ * @class TCS3200MedianFilter
+ * @brief Median of the last `window` readings.
+ *
+ * The window is kept sorted, so an update costs at most `window`
+ * comparisons. Small odd windows (3-9) work best for rejecting
+ * single-sample spikes.
+ * 
+ * @tparam window Number of readings the median is taken from.
+ * 
+ */
+template <uint8_t window>
+class TCS3200MedianFilter : public TCS3200Filter {
+public:
+    TCS3200MedianFilter() {
+        this->reset();
+    }
+
+    uint32_t update(uint8_t channel, uint32_t value) {
+        uint8_t &count = this->_count[channel & 0x03];
+        uint8_t &index = this->_index[channel & 0x03];
+        uint32_t *history = this->_history[channel & 0x03];
+        uint32_t *sorted = this->_sorted[channel & 0x03];
+
+        uint8_t position = count;
+        if(count < window)
+            count++;
+        else {
+            // Remove the oldest reading from the sorted window
+            position = 0;
+            while(sorted[position] != history[index])
+                position++;
+
+            for(; position + 1 < window; position++)
+                sorted[position] = sorted[position + 1];
+        }
+
+        history[index] = value;
+        if(++index == window)
+            index = 0;
+
+        while(position > 0 && sorted[position - 1] > value) {
+            sorted[position] = sorted[position - 1];
+            position--;
+        }
+        sorted[position] = value;
+
+        return sorted[count / 2];
+    }
+
+    void reset() {
+        for(uint8_t i = 0; i < 4; i++)
+            this->_count[i] = this->_index[i] = 0;
+    }
+
+private:
+    uint32_t _history[4][window], _sorted[4][window];
+    uint8_t _count[4], _index[4];
+};
+
+/**
+ * 
+ * @class TCS3200EMAFilter
+ * @brief Exponential moving average in Q24.8 fixed-point.
+ * 
+ */
+class TCS3200EMAFilter : public TCS3200Filter {
+public:
+    /**
+     * 
+     * @brief Constructor for TCS3200EMAFilter class.
+     * 
+     * @param alpha Weight of each new reading, in 1/256 steps (1-255).
+     *              Lower values smooth more.
+     * 
+     */
+    TCS3200EMAFilter(uint8_t alpha):
+        _alpha(alpha > 0 ? alpha : 1) {
+        this->reset();
+    }
+
+    uint32_t update(uint8_t channel, uint32_t value) {
+        int32_t &state = this->_state[channel & 0x03];
+        int32_t target = (int32_t) min(value, (uint32_t) 0x7fffff) << 8;
+
+        if(state < 0)
+            state = target;
+        else {
+            // The step is split at the binary point so both products
+            // fit 32 bits, avoiding a 64-bit multiply on 8-bit MCUs.
+            // Rounding the fraction keeps every alpha moving until the
+            // output settles on the target exactly.
+            int32_t delta = target - state;
+            state += (delta >> 8) * this->_alpha + (((delta & 0xff) * this->_alpha + 127) >> 8);
+        }
+
+        return (state + 128) >> 8;
+    }
+
+    void reset() {
+        for(uint8_t i = 0; i < 4; i++)
+            this->_state[i] = -1;
+    }
+
+private:
+    uint8_t _alpha;
+    int32_t _state[4];
+};
+
+/**
+ * 
+ * @class TCS3200KalmanFilter
+ * @brief One-dimensional Kalman filter assuming a constant reading.
+ * 
+ */
+class TCS3200KalmanFilter : public TCS3200Filter {
+public:
+    /**
+     * 
+     * @brief Constructor for TCS3200KalmanFilter class.
+     * 
+     * Negative noise values are treated as zero, and a zero
+     * measurement noise is raised to a tiny one, so with no process
+     * noise either the filter averages all readings instead of
+     * dividing by zero.
+     * 
+     * @param process_noise Expected variance of the true reading
+     *                      between two updates.
+     * @param measurement_noise Expected variance of the readings
+     *                          (e.g. from `calibration_stats()`).
+     * 
+     */
+    TCS3200KalmanFilter(float process_noise, float measurement_noise):
+        _process_noise(process_noise > 0.0f ? process_noise : 0.0f),
+        _measurement_noise(measurement_noise > 1e-6f ? measurement_noise : 1e-6f) {
+        this->reset();
+    }
+
+    uint32_t update(uint8_t channel, uint32_t value) {
+        float &estimate = this->_estimate[channel & 0x03];
+        float &error = this->_error[channel & 0x03];
+
+        if(error < 0.0f) {
+            estimate = value;
+            error = this->_measurement_noise;
+        }
+        else {
+            error += this->_process_noise;
+
+            float gain = error / (error + this->_measurement_noise);
+            estimate += gain * (value - estimate);
+            error *= 1.0f - gain;
+        }
+
+        return (uint32_t) (estimate + 0.5f);
+    }
+
+    void reset() {
+        for(uint8_t i = 0; i < 4; i++)
+            this->_error[i] = -1.0f;
+    }
+
+private:
+    float _process_noise, _measurement_noise;
+    float _estimate[4], _error[4];
+};
+
+#endif
@@ -0,0 +1,149 @@
+/*
+ * This file is part of the TCS3200 Color Sensor Arduino library.
+ * Copyright (c) 2023 Nathanne Isip
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "TCS3200Palette.h"
+
+TCS3200Palette::TCS3200Palette(TCS3200PaletteNode *nodes, uint16_t size, uint8_t metric):
+    _nodes(nodes),
+    _size(size),
+    _metric(metric) { }
+
+void TCS3200Palette::to_point(RGBColor color, int16_t *point) {
+    if(this->_metric == TCS3200_METRIC_LAB) {
+        CIELabColor lab = TCS3200::cie1931_to_cielab(TCS3200::rgb_to_cie1931(color));
+
+        point[0] = (int16_t) (lab.l * 64.0f);
+        point[1] = (int16_t) (lab.a * 64.0f);
+        point[2] = (int16_t) (lab.b * 64.0f);
+    }
+    else {
+        point[0] = color.red;
+        point[1] = color.green;
+        point[2] = color.blue;
+    }
+}
+
+void TCS3200Palette::build(const RGBColor *colors) {
+    for(uint16_t i = 0; i < this->_size; i++) {
+        this->to_point(colors[i], this->_nodes[i].point);
+        this->_nodes[i].index = i;
+    }
+
+    this->build(0, this->_size, 0);
+}
+
+void TCS3200Palette::build(uint16_t first, uint16_t last, uint8_t axis) {
+    if(last - first < 2)
+        return;
+
+    // Quickselect the median on the axis into the middle of the range
+    uint16_t middle = first + (last - first) / 2;
+    uint16_t low = first, high = last - 1;
+
+    while(low < high) {
+        int16_t pivot = this->_nodes[middle].point[axis];
+        uint16_t i = low, j = high;
+
+        while(i <= j) {
+            while(this->_nodes[i].point[axis] < pivot)
+                i++;
+            while(this->_nodes[j].point[axis] > pivot)
+                j--;
+
+            if(i <= j) {
+                TCS3200PaletteNode node = this->_nodes[i];
+                this->_nodes[i] = this->_nodes[j];
+                this->_nodes[j] = node;
+
+                i++;
+                if(j-- == 0)
+                    break;
+            }
+        }
+
+        if(middle <= j)
+            high = j;
+        else if(middle >= i)
+            low = i;
+        else break;
+    }
+
+    uint8_t next_axis = axis == 2 ? 0 : axis + 1;
+    this->build(first, middle, next_axis);
+    this->build(middle + 1, last, next_axis);
+}
+
+void TCS3200Palette::search(uint16_t first, uint16_t last, uint8_t axis, const int16_t *query,
+    uint32_t *best, uint32_t *second, uint16_t *best_index) {
+    if(first >= last)
+        return;
+
+    uint16_t middle = first + (last - first) / 2;
+    const TCS3200PaletteNode *node = &this->_nodes[middle];
+
+    uint32_t distance = 0;
+    for(uint8_t i = 0; i < 3; i++) {
+        int32_t delta = (int32_t) query[i] - node->point[i];
+        distance += delta * delta;
+    }
+
+    if(distance < *best) {
+        *second = *best;
+        *best = distance;
+        *best_index = node->index;
+    }
+    else if(distance < *second)
+        *second = distance;
+
+    int32_t split = (int32_t) query[axis] - node->point[axis];
+    uint8_t next_axis = axis == 2 ? 0 : axis + 1;
+
+    if(split < 0) {
+        this->search(first, middle, next_axis, query, best, second, best_index);
+        if((uint32_t) (split * split) < *second)
+            this->search(middle + 1, last, next_axis, query, best, second, best_index);
+    }
+    else {
+        this->search(middle + 1, last, next_axis, query, best, second, best_index);
+        if((uint32_t) (split * split) < *second)
+            this->search(first, middle, next_axis, query, best, second, best_index);
+    }
+}
+
+PaletteMatch TCS3200Palette::classify(RGBColor color) {
+    int16_t query[3];
+    this->to_point(color, query);
+
+    uint32_t best = 0xffffffff, second = 0xffffffff;
+    PaletteMatch match;
+    match.index = 0;
+
+    this->search(0, this->_size, 0, query, &best, &second, &match.index);
+
+    float scale = this->_metric == TCS3200_METRIC_LAB ? 1.0f / 64.0f : 1.0f;
+    match.distance = sqrt((float) best) * scale;
+    match.confidence = second == 0xffffffff || second == 0 ? 1.0f :
+        1.0f - sqrt((float) best / second);
+
+    return match;
+}
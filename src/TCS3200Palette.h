@@ -0,0 +1,159 @@
+/*
+ * This file is part of the TCS3200 Color Sensor Arduino library.
+ * Copyright (c) 2023 Nathanne Isip
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * 
+ * @file TCS3200Palette.h
+ * @author [Nathanne Isip](https://github.com/nthnn/TCS3200)
+ * @brief Indexed nearest color classification for large palettes.
+ *
+ * `TCS3200Palette` arranges the colors of a palette in an implicit
+ * k-d tree, so finding the nearest color of an already acquired
+ * reading takes roughly logarithmic time instead of scanning every
+ * palette entry like `TCS3200::nearest_color()` does.
+ *
+ * **Example usage**:
+ * @code{.cpp}
+ * RGBColor inks[INK_COUNT] = { ... };
+ * TCS3200PaletteNode nodes[INK_COUNT];
+ * TCS3200Palette palette(nodes, INK_COUNT, TCS3200_METRIC_LAB);
+ * 
+ * void setup() {
+ *   palette.build(inks);
+ * }
+ * 
+ * void loop() {
+ *   PaletteMatch match = palette.classify(tcs3200.read_rgb_color());
+ *   Serial.println("Ink #" + String(match.index) +
+ *     ", Delta E: " + String(match.distance));
+ * }
+ * @endcode
+ *
+ */
+#ifndef TCS3200_PALETTE_H
+#define TCS3200_PALETTE_H
+
+#include "TCS3200.h"
+
+#define TCS3200_METRIC_RGB  0x00  ///< Euclidean distance in RGB
+#define TCS3200_METRIC_LAB  0x01  ///< CIE 1976 Delta E (Euclidean distance in L*a*b*)
+
+/**
+ * 
+ * @brief Structure to represent a node of a palette index.
+ *
+ * Coordinates are RGB values for `TCS3200_METRIC_RGB`, and L*a*b*
+ * values multiplied by 64 for `TCS3200_METRIC_LAB`.
+ * 
+ */
+typedef struct _TCS3200PaletteNode {
+    int16_t point[3];   ///< Coordinates of the color in the metric space
+    uint16_t index;     ///< Index of the color in the palette
+} TCS3200PaletteNode;
+
+/**
+ * 
+ * @brief Structure to represent the result of a palette lookup.
+ * 
+ */
+typedef struct _PaletteMatch {
+    uint16_t index;     ///< Index of the nearest color in the palette
+    float distance;     ///< Distance to the nearest color
+    float confidence;   ///< Margin over the second nearest color (0-1)
+} PaletteMatch;
+
+/**
+ * 
+ * @class TCS3200Palette
+ * @brief Nearest color index over a fixed palette.
+ * 
+ */
+class TCS3200Palette {
+public:
+    /**
+     * 
+     * @brief Constructor for TCS3200Palette class.
+     * 
+     * @param nodes Buffer of `size` nodes to hold the index.
+     * @param size Number of colors in the palette.
+     * @param metric `TCS3200_METRIC_RGB` or `TCS3200_METRIC_LAB`.
+     * 
+     */
+    TCS3200Palette(TCS3200PaletteNode *nodes, uint16_t size, uint8_t metric = TCS3200_METRIC_RGB);
+
+    /**
+     * 
+     * @brief Build the index from the palette colors.
+     *
+     * This must be called once before `classify()`, and again
+     * whenever the palette colors change.
+     * 
+     * @param colors Array of `size` palette colors.
+     * 
+     */
+    void build(const RGBColor *colors);
+
+    /**
+     * 
+     * @brief Find the palette color nearest to a color.
+     *
+     * The confidence is 0 when the color is equally far from the
+     * two nearest palette colors, and 1 when it matches a palette
+     * color exactly.
+     * 
+     * @param color `RGBColor` to be classified.
+     * 
+     * @return `PaletteMatch` of the nearest palette color.
+     * 
+     */
+    PaletteMatch classify(RGBColor color);
+
+    /**
+     * 
+     * @brief Find the label of the palette color nearest to a color.
+     * 
+     * @tparam T Type of the color label (e.g., String, char[]).
+     * 
+     * @param color_labels Array of labels in palette order.
+     * @param color `RGBColor` to be classified.
+     * 
+     * @return Label of the nearest palette color.
+     * 
+     */
+    template <typename T>
+    T nearest(T *color_labels, RGBColor color) {
+        return color_labels[this->classify(color).index];
+    }
+
+private:
+    TCS3200PaletteNode *_nodes;
+    uint16_t _size;
+    uint8_t _metric;
+
+    void to_point(RGBColor color, int16_t *point);
+    void build(uint16_t first, uint16_t last, uint8_t axis);
+    void search(uint16_t first, uint16_t last, uint8_t axis, const int16_t *query,
+        uint32_t *best, uint32_t *second, uint16_t *best_index);
+};
+
+#endif
@@ -0,0 +1,132 @@
+/*
+ * This file is part of the TCS3200 Color Sensor Arduino library.
+ * Copyright (c) 2023 Nathanne Isip
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "TCS3200RingBuffer.h"
+
+// Single-core AVR only needs the compiler not to reorder accesses
+#ifdef __AVR__
+#define TCS3200_MEMORY_BARRIER() __asm__ __volatile__("" ::: "memory")
+#define TCS3200_ACQUIRE_FENCE() __asm__ __volatile__("" ::: "memory")
+#define TCS3200_RELEASE_FENCE() __asm__ __volatile__("" ::: "memory")
+#else
+#define TCS3200_MEMORY_BARRIER() __sync_synchronize()
+#define TCS3200_ACQUIRE_FENCE() __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#define TCS3200_RELEASE_FENCE() __atomic_thread_fence(__ATOMIC_RELEASE)
+#endif
+
+static uint16_t tcs3200_round_capacity(uint16_t capacity) {
+    // Clear the lowest set bit until only the highest one is left
+    while(capacity & (capacity - 1))
+        capacity &= capacity - 1;
+
+    return capacity;
+}
+
+TCS3200RingBuffer::TCS3200RingBuffer(RawRGBC *storage, uint16_t capacity):
+    _storage(storage),
+    _capacity(tcs3200_round_capacity(capacity)),
+    _head(0) { }
+
+uint32_t TCS3200RingBuffer::head() {
+    uint32_t first, second;
+
+    // Re-read until stable, since 32-bit loads are not atomic on 8-bit cores
+    do {
+        first = this->_head;
+        second = this->_head;
+    } while(first != second);
+
+    return first;
+}
+
+void TCS3200RingBuffer::push(const RawRGBC &frame) {
+    if(this->_capacity == 0)
+        return;
+
+    uint32_t head = this->_head;
+
+    this->_storage[head & (this->_capacity - 1)] = frame;
+    TCS3200_RELEASE_FENCE();
+    this->_head = head + 1;
+
+    // The next push must not overwrite a slot before this head is seen
+    TCS3200_MEMORY_BARRIER();
+}
+
+uint32_t TCS3200RingBuffer::pushed() {
+    return this->head();
+}
+
+uint16_t TCS3200RingBuffer::capacity() {
+    return this->_capacity;
+}
+
+void TCS3200RingBuffer::attach(TCS3200RingCursor &cursor) {
+    cursor.position = this->head();
+    cursor.overruns = 0;
+}
+
+void TCS3200RingBuffer::catch_up(TCS3200RingCursor &cursor, uint32_t head) {
+    uint32_t behind = head - cursor.position;
+
+    if(behind >= this->_capacity) {
+        cursor.overruns += behind - (this->_capacity - 1);
+        cursor.position = head - (this->_capacity - 1);
+    }
+}
+
+uint16_t TCS3200RingBuffer::available(TCS3200RingCursor &cursor) {
+    uint32_t head = this->head();
+    this->catch_up(cursor, head);
+
+    return head - cursor.position;
+}
+
+bool TCS3200RingBuffer::read(TCS3200RingCursor &cursor, RawRGBC *frame) {
+    return this->read(cursor, frame, 1) == 1;
+}
+
+uint16_t TCS3200RingBuffer::read(TCS3200RingCursor &cursor, RawRGBC *frames, uint16_t count) {
+    uint16_t total = 0;
+
+    while(total < count) {
+        uint32_t head = this->head();
+        TCS3200_ACQUIRE_FENCE();
+        this->catch_up(cursor, head);
+
+        if(cursor.position == head)
+            break;
+
+        frames[total] = this->_storage[cursor.position & (this->_capacity - 1)];
+        TCS3200_MEMORY_BARRIER();
+
+        // Discard the copy if the producer started overwriting its slot
+        if(this->head() - cursor.position >= this->_capacity)
+            continue;
+
+        cursor.position++;
+        total++;
+    }
+
+    return total;
+}
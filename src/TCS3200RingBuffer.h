@@ -0,0 +1,183 @@
+/*
+ * This file is part of the TCS3200 Color Sensor Arduino library.
+ * Copyright (c) 2023 Nathanne Isip
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * 
+ * @file TCS3200RingBuffer.h
+ * @author [Nathanne Isip](https://github.com/nthnn/TCS3200)
+ * @brief Lock-free single-producer, multi-consumer buffer of frames.
+ *
+ * A `TCS3200RingBuffer` keeps the most recent timestamped frames of a
+ * sensor so that several consumers (e.g. a telemetry task and a
+ * control task) can read them at their own pace without triggering
+ * new sensor reads. Each consumer owns a `TCS3200RingCursor`; the
+ * producer never waits for consumers, and a consumer that falls more
+ * than a buffer behind skips the lost frames and counts them as
+ * overruns.
+ *
+ * **Example usage**:
+ * @code{.cpp}
+ * RawRGBC storage[16];
+ * TCS3200RingBuffer frames(storage, 16);
+ * TCS3200RingCursor telemetry;
+ * 
+ * void setup() {
+ *   tcs3200.begin();
+ *   tcs3200.attach_ring_buffer(&frames);
+ *   frames.attach(telemetry);
+ * }
+ * 
+ * void loop() {
+ *   tcs3200.loop();
+ * 
+ *   RawRGBC frame;
+ *   while(frames.read(telemetry, &frame))
+ *     Serial.println(frame.red);
+ * }
+ * @endcode
+ *
+ */
+#ifndef TCS3200_RING_BUFFER_H
+#define TCS3200_RING_BUFFER_H
+
+#include "TCS3200.h"
+
+/**
+ * 
+ * @brief Structure to represent the read position of a consumer.
+ * 
+ */
+typedef struct _TCS3200RingCursor {
+    uint32_t position;  ///< Sequence number of the next frame to be read
+    uint32_t overruns;  ///< Number of frames lost by falling behind
+} TCS3200RingCursor;
+
+/**
+ * 
+ * @class TCS3200RingBuffer
+ * @brief Lock-free ring buffer of `RawRGBC` frames.
+ *
+ * `push()` may only be called from a single producer, which may be
+ * an interrupt service routine. Any number of consumers may read
+ * concurrently, since reading does not modify the buffer. At most
+ * `capacity - 1` unread frames are guaranteed to be kept.
+ * 
+ */
+class TCS3200RingBuffer {
+public:
+    /**
+     * 
+     * @brief Constructor for TCS3200RingBuffer class.
+     * 
+     * @param storage Array of `capacity` frames to hold the buffer.
+     * @param capacity Number of frames in `storage`. Capacities that
+     *                 are not a power of two are rounded down to one,
+     *                 leaving the remaining frames unused.
+     * 
+     */
+    TCS3200RingBuffer(RawRGBC *storage, uint16_t capacity);
+
+    /**
+     * 
+     * @brief Append a frame, overwriting the oldest one when full.
+     * 
+     * @param frame Frame to be appended.
+     * 
+     */
+    void push(const RawRGBC &frame);
+
+    /**
+     * 
+     * @brief Get the total number of frames pushed so far.
+     * 
+     * @return Sequence number of the next frame to be pushed.
+     * 
+     */
+    uint32_t pushed();
+
+    /**
+     * 
+     * @brief Get the number of frames the buffer holds.
+     * 
+     * @return Capacity after rounding down to a power of two.
+     * 
+     */
+    uint16_t capacity();
+
+    /**
+     * 
+     * @brief Position a consumer cursor at the newest frame.
+     *
+     * Only frames pushed after this call will be read.
+     * 
+     * @param cursor Cursor of the consumer.
+     * 
+     */
+    void attach(TCS3200RingCursor &cursor);
+
+    /**
+     * 
+     * @brief Get the number of frames a consumer has not read yet.
+     * 
+     * @param cursor Cursor of the consumer.
+     * 
+     * @return Number of unread frames still in the buffer.
+     * 
+     */
+    uint16_t available(TCS3200RingCursor &cursor);
+
+    /**
+     * 
+     * @brief Read the next frame of a consumer.
+     * 
+     * @param cursor Cursor of the consumer.
+     * @param frame Receives the frame.
+     * 
+     * @return `true` if a frame was read, `false` if none is available.
+     * 
+     */
+    bool read(TCS3200RingCursor &cursor, RawRGBC *frame);
+
+    /**
+     * 
+     * @brief Read up to `count` frames of a consumer at once.
+     * 
+     * @param cursor Cursor of the consumer.
+     * @param frames Array receiving the frames, oldest first.
+     * @param count Maximum number of frames to read.
+     * 
+     * @return Number of frames read.
+     * 
+     */
+    uint16_t read(TCS3200RingCursor &cursor, RawRGBC *frames, uint16_t count);
+
+private:
+    RawRGBC *_storage;
+    uint16_t _capacity;
+    volatile uint32_t _head;
+
+    uint32_t head();
+    void catch_up(TCS3200RingCursor &cursor, uint32_t head);
+};
+
+#endif
@@ -0,0 +1,148 @@
+/*
+ * This file is part of the TCS3200 Color Sensor Arduino library.
+ * Copyright (c) 2023 Nathanne Isip
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "TCS3200Rules.h"
+#include "TCS3200Palette.h"
+
+TCS3200Rules::TCS3200Rules(TCS3200Rule *rules, uint8_t capacity):
+    _rules(rules),
+    _capacity(capacity),
+    _count(0) { }
+
+TCS3200Rule *TCS3200Rules::add(uint8_t type, TCS3200RuleCallback callback, void *context) {
+    if(this->_count >= this->_capacity)
+        return nullptr;
+
+    TCS3200Rule *rule = &this->_rules[this->_count++];
+    rule->type = type;
+    rule->matching = false;
+    rule->callback = callback;
+    rule->context = context;
+
+    return rule;
+}
+
+int16_t TCS3200Rules::add_rgb_box(RGBColor low, RGBColor high, TCS3200RuleCallback callback, void *context) {
+    TCS3200Rule *rule = this->add(TCS3200_RULE_RGB_BOX, callback, context);
+    if(rule == nullptr)
+        return -1;
+
+    rule->low = low;
+    rule->high = high;
+
+    return this->_count - 1;
+}
+
+int16_t TCS3200Rules::add_hue_range(float from, float to, TCS3200RuleCallback callback, void *context) {
+    TCS3200Rule *rule = this->add(TCS3200_RULE_HUE_RANGE, callback, context);
+    if(rule == nullptr)
+        return -1;
+
+    rule->from = from;
+    rule->to = to;
+
+    return this->_count - 1;
+}
+
+int16_t TCS3200Rules::add_delta_e(CIELabColor reference, float limit, TCS3200RuleCallback callback, void *context) {
+    TCS3200Rule *rule = this->add(TCS3200_RULE_DELTA_E, callback, context);
+    if(rule == nullptr)
+        return -1;
+
+    rule->reference = reference;
+    rule->to = limit;
+
+    return this->_count - 1;
+}
+
+int16_t TCS3200Rules::add_palette(TCS3200Palette *palette, TCS3200RuleCallback callback, void *context) {
+    TCS3200Rule *rule = this->add(TCS3200_RULE_PALETTE, callback, context);
+    if(rule == nullptr)
+        return -1;
+
+    rule->palette = palette;
+    rule->label = 0xffff;
+
+    return this->_count - 1;
+}
+
+void TCS3200Rules::clear() {
+    this->_count = 0;
+}
+
+uint8_t TCS3200Rules::count() {
+    return this->_count;
+}
+
+bool TCS3200Rules::matching(uint8_t rule) {
+    return rule < this->_count && this->_rules[rule].matching;
+}
+
+void TCS3200Rules::evaluate(ColorSample &sample) {
+    for(uint8_t i = 0; i < this->_count; i++) {
+        TCS3200Rule *rule = &this->_rules[i];
+        bool matching = false;
+
+        switch(rule->type) {
+            case TCS3200_RULE_RGB_BOX: {
+                RGBColor color = sample.balanced();
+
+                matching = color.red >= rule->low.red && color.red <= rule->high.red &&
+                    color.green >= rule->low.green && color.green <= rule->high.green &&
+                    color.blue >= rule->low.blue && color.blue <= rule->high.blue;
+                break;
+            }
+
+            case TCS3200_RULE_HUE_RANGE: {
+                float hue = sample.hsv().hue;
+
+                matching = rule->from <= rule->to ?
+                    hue >= rule->from && hue <= rule->to :
+                    hue >= rule->from || hue <= rule->to;
+                break;
+            }
+
+            case TCS3200_RULE_DELTA_E:
+                matching = TCS3200::delta_e76(rule->reference, sample.cielab()) <= rule->to;
+                break;
+
+            case TCS3200_RULE_PALETTE: {
+                uint16_t label = rule->palette->classify(sample.balanced()).index;
+
+                // A palette rule always matches, and a new label starts a new match
+                if(label != rule->label) {
+                    rule->label = label;
+                    rule->matching = false;
+                }
+
+                matching = true;
+                break;
+            }
+        }
+
+        if(matching && !rule->matching && rule->callback != nullptr)
+            rule->callback(sample, rule->context);
+
+        rule->matching = matching;
+    }
+}
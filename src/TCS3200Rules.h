@@ -0,0 +1,226 @@
+/*
+ * This file is part of the TCS3200 Color Sensor Arduino library.
+ * Copyright (c) 2023 Nathanne Isip
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * 
+ * @file TCS3200Rules.h
+ * @author [Nathanne Isip](https://github.com/nthnn/TCS3200)
+ * @brief Table of color trigger rules evaluated on a single sample.
+ *
+ * `TCS3200Rules` holds any number of trigger rules (RGB boxes, hue
+ * ranges, color differences to a reference and palette label
+ * changes) in a caller-provided table. All rules are evaluated in
+ * one pass over a `ColorSample`, so the sensor is read only once no
+ * matter how many rules there are. A rule's callback is executed
+ * when the rule starts to match, and receives the sample along with
+ * the context pointer given when the rule was added.
+ *
+ * **Example usage**:
+ * @code{.cpp}
+ * TCS3200Rule table[4];
+ * TCS3200Rules rules(table, 4);
+ * 
+ * void on_red(ColorSample &sample, void *context) {
+ *   Serial.println("Red part on " + String((const char*) context));
+ * }
+ * 
+ * void setup() {
+ *   tcs3200.begin();
+ *   rules.add_hue_range(340, 20, on_red, (void*) "belt 1");
+ *   tcs3200.attach_rules(&rules);
+ * }
+ * 
+ * void loop() {
+ *   tcs3200.loop();
+ * }
+ * @endcode
+ *
+ */
+#ifndef TCS3200_RULES_H
+#define TCS3200_RULES_H
+
+#include "TCS3200.h"
+
+class TCS3200Palette;
+
+#define TCS3200_RULE_RGB_BOX    0x00  ///< Every RGB channel within a range
+#define TCS3200_RULE_HUE_RANGE  0x01  ///< Hue within a range of degrees
+#define TCS3200_RULE_DELTA_E    0x02  ///< CIE 1976 Delta E to a reference below a limit
+#define TCS3200_RULE_PALETTE    0x03  ///< Nearest palette color changed
+
+/**
+ * 
+ * @brief Callback of a trigger rule.
+ * 
+ * @param sample Sample that triggered the rule.
+ * @param context Context pointer given when the rule was added.
+ * 
+ */
+typedef void (*TCS3200RuleCallback)(ColorSample &sample, void *context);
+
+/**
+ * 
+ * @brief Structure to represent an entry of a rule table.
+ *
+ * Entries are filled in by the `TCS3200Rules::add_*()` functions.
+ * 
+ */
+typedef struct _TCS3200Rule {
+    uint8_t type;                   ///< One of the `TCS3200_RULE_*` types
+    RGBColor low, high;             ///< Bounds of an RGB box rule
+    float from, to;                 ///< Hue range in degrees, or Delta E limit (`to`)
+    CIELabColor reference;          ///< Reference color of a Delta E rule
+    TCS3200Palette *palette;        ///< Palette of a palette rule
+    uint16_t label;                 ///< Last nearest palette color of a palette rule
+    bool matching;                  ///< Whether the rule matched the last sample
+    TCS3200RuleCallback callback;   ///< Function executed when the rule triggers
+    void *context;                  ///< Pointer passed to the callback
+} TCS3200Rule;
+
+/**
+ * 
+ * @class TCS3200Rules
+ * @brief Table of trigger rules evaluated on a single sample.
+ * 
+ */
+class TCS3200Rules {
+public:
+    /**
+     * 
+     * @brief Constructor for TCS3200Rules class.
+     * 
+     * @param rules Buffer of `capacity` rule entries.
+     * @param capacity Largest number of rules in the table.
+     * 
+     */
+    TCS3200Rules(TCS3200Rule *rules, uint8_t capacity);
+
+    /**
+     * 
+     * @brief Add a rule matching white balanced colors inside an RGB box.
+     * 
+     * @param low Lowest value of each channel (inclusive).
+     * @param high Highest value of each channel (inclusive).
+     * @param callback Function executed when the rule triggers.
+     * @param context Pointer passed to the callback.
+     * 
+     * @return Index of the rule, or -1 if the table is full.
+     * 
+     */
+    int16_t add_rgb_box(RGBColor low, RGBColor high, TCS3200RuleCallback callback, void *context = nullptr);
+
+    /**
+     * 
+     * @brief Add a rule matching white balanced hues in a range.
+     *
+     * The range wraps around 360 degrees when `from` is greater
+     * than `to`, so 340 to 20 matches reds.
+     * 
+     * @param from First hue of the range in degrees (inclusive).
+     * @param to Last hue of the range in degrees (inclusive).
+     * @param callback Function executed when the rule triggers.
+     * @param context Pointer passed to the callback.
+     * 
+     * @return Index of the rule, or -1 if the table is full.
+     * 
+     */
+    int16_t add_hue_range(float from, float to, TCS3200RuleCallback callback, void *context = nullptr);
+
+    /**
+     * 
+     * @brief Add a rule matching colors close to a reference color.
+     * 
+     * @param reference Reference color as read by the sensor.
+     * @param limit Largest CIE 1976 Delta E of a matching color.
+     * @param callback Function executed when the rule triggers.
+     * @param context Pointer passed to the callback.
+     * 
+     * @return Index of the rule, or -1 if the table is full.
+     * 
+     */
+    int16_t add_delta_e(CIELabColor reference, float limit, TCS3200RuleCallback callback, void *context = nullptr);
+
+    /**
+     * 
+     * @brief Add a rule triggering when the nearest palette color
+     *        of the white balanced sample changes.
+     * 
+     * @param palette Built palette to classify the samples with.
+     * @param callback Function executed when the rule triggers.
+     * @param context Pointer passed to the callback.
+     * 
+     * @return Index of the rule, or -1 if the table is full.
+     * 
+     */
+    int16_t add_palette(TCS3200Palette *palette, TCS3200RuleCallback callback, void *context = nullptr);
+
+    /**
+     * 
+     * @brief Remove every rule from the table.
+     * 
+     */
+    void clear();
+
+    /**
+     * 
+     * @brief Get the number of rules in the table.
+     * 
+     * @return Number of rules.
+     * 
+     */
+    uint8_t count();
+
+    /**
+     * 
+     * @brief Check whether a rule matched the last evaluated sample.
+     * 
+     * @param rule Index of the rule.
+     * 
+     * @return `true` if the rule matched, `false` otherwise.
+     * 
+     */
+    bool matching(uint8_t rule);
+
+    /**
+     * 
+     * @brief Evaluate every rule against a sample.
+     *
+     * The callbacks of the rules that did not match the previous
+     * sample but match this one are executed, in table order. A
+     * palette rule triggers whenever the nearest palette color
+     * differs from the previous sample's. Every rule kind matches
+     * against the white balanced readings of the sample.
+     * 
+     * @param sample Sample to evaluate the rules against.
+     * 
+     */
+    void evaluate(ColorSample &sample);
+
+private:
+    TCS3200Rule *_rules;
+    uint8_t _capacity, _count;
+
+    TCS3200Rule *add(uint8_t type, TCS3200RuleCallback callback, void *context);
+};
+
+#endif
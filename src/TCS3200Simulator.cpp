@@ -0,0 +1,229 @@
+/*
+ * This file is part of the TCS3200 Color Sensor Arduino library.
+ * Copyright (c) 2023 Nathanne Isip
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "TCS3200Simulator.h"
+
+#define TCS3200_SIM_NEVER 0xffffffffffffffffULL
+
+TCS3200SimulatedHAL::TCS3200SimulatedHAL(uint8_t s0_pin, uint8_t s1_pin, uint8_t s2_pin, uint8_t s3_pin, uint8_t out_pin):
+    _noise(0),
+    _outputs(1),
+    _random(0x2545f491),
+    _tick(1),
+    _time(0) {
+    this->_pins[0] = s0_pin;
+    this->_pins[1] = s1_pin;
+    this->_pins[2] = s2_pin;
+    this->_pins[3] = s3_pin;
+    this->_out_pins[0] = out_pin;
+
+    for(uint8_t i = 0; i < 4; i++)
+        this->_levels[i] = LOW;
+
+    for(uint8_t i = 0; i < TCS3200_SIM_OUTPUTS; i++) {
+        this->_next_edges[i] = TCS3200_SIM_NEVER;
+        this->_isrs[i] = nullptr;
+
+        for(uint8_t j = 0; j < 4; j++)
+            this->_spectra[i][j] = 0;
+    }
+}
+
+bool TCS3200SimulatedHAL::add_output(uint8_t out_pin) {
+    if(this->_outputs >= TCS3200_SIM_OUTPUTS || this->output(out_pin) >= 0)
+        return false;
+
+    this->_out_pins[this->_outputs++] = out_pin;
+    return true;
+}
+
+void TCS3200SimulatedHAL::spectrum(uint32_t red, uint32_t green, uint32_t blue, uint32_t clear) {
+    this->spectrum(this->_out_pins[0], red, green, blue, clear);
+}
+
+void TCS3200SimulatedHAL::spectrum(uint8_t out_pin, uint32_t red, uint32_t green, uint32_t blue, uint32_t clear) {
+    int8_t output = this->output(out_pin);
+    if(output < 0)
+        return;
+
+    this->_spectra[output][TCS3200_COLOR_RED] = red;
+    this->_spectra[output][TCS3200_COLOR_GREEN] = green;
+    this->_spectra[output][TCS3200_COLOR_BLUE] = blue;
+    this->_spectra[output][TCS3200_COLOR_CLEAR] = clear;
+
+    this->restart(output);
+}
+
+void TCS3200SimulatedHAL::noise(uint8_t percent) {
+    this->_noise = percent;
+}
+
+void TCS3200SimulatedHAL::seed(uint32_t seed) {
+    this->_random = seed != 0 ? seed : 1;
+}
+
+void TCS3200SimulatedHAL::tick(uint32_t time) {
+    this->_tick = time;
+}
+
+uint32_t TCS3200SimulatedHAL::next_random() {
+    // xorshift32
+    this->_random ^= this->_random << 13;
+    this->_random ^= this->_random >> 17;
+    this->_random ^= this->_random << 5;
+
+    return this->_random;
+}
+
+int8_t TCS3200SimulatedHAL::output(uint8_t pin) {
+    for(uint8_t i = 0; i < this->_outputs; i++)
+        if(this->_out_pins[i] == pin)
+            return i;
+
+    return -1;
+}
+
+uint32_t TCS3200SimulatedHAL::period(uint8_t output) {
+    static const uint8_t percent[4] = {0, 2, 20, 100};
+
+    // S2/S3: LL red, LH blue, HL clear, HH green
+    static const uint8_t channels[4] = {
+        TCS3200_COLOR_RED, TCS3200_COLOR_BLUE,
+        TCS3200_COLOR_CLEAR, TCS3200_COLOR_GREEN
+    };
+
+    uint8_t scaling = percent[this->_levels[0] << 1 | this->_levels[1]];
+    uint32_t frequency = this->_spectra[output][channels[this->_levels[2] << 1 | this->_levels[3]]];
+
+    if(scaling == 0 || frequency == 0)
+        return 0;
+
+    // Period in nanoseconds
+    uint64_t period = 100000000000ULL / ((uint64_t) frequency * scaling);
+    if(this->_noise > 0) {
+        // Sum of four uniform variables approximates a normal distribution
+        int32_t deviation = 0;
+        for(uint8_t i = 0; i < 4; i++)
+            deviation += (int32_t) (this->next_random() & 0xffff) - 0x8000;
+
+        period += (int64_t) period * this->_noise * deviation / (100LL * 0x20000);
+    }
+
+    return period > 0xffffffffULL ? 0xffffffffUL : (uint32_t) period;
+}
+
+void TCS3200SimulatedHAL::restart(uint8_t output) {
+    uint32_t period = this->period(output);
+    this->_next_edges[output] = period > 0 ? this->_time + period : TCS3200_SIM_NEVER;
+}
+
+void TCS3200SimulatedHAL::advance_to(uint64_t time) {
+    for(;;) {
+        // Fire the edges of all outputs in time order
+        uint8_t next = 0;
+        for(uint8_t i = 1; i < this->_outputs; i++)
+            if(this->_next_edges[i] < this->_next_edges[next])
+                next = i;
+
+        if(this->_next_edges[next] > time)
+            break;
+
+        this->_time = this->_next_edges[next];
+
+        if(this->_isrs[next] != nullptr)
+            this->_isrs[next]();
+
+        this->restart(next);
+    }
+
+    this->_time = time;
+}
+
+void TCS3200SimulatedHAL::advance(uint32_t time) {
+    this->advance_to(this->_time + (uint64_t) time * 1000);
+}
+
+void TCS3200SimulatedHAL::pin_mode(uint8_t pin, uint8_t mode) {
+    (void) pin;
+    (void) mode;
+}
+
+void TCS3200SimulatedHAL::digital_write(uint8_t pin, uint8_t value) {
+    for(uint8_t i = 0; i < 4; i++)
+        if(this->_pins[i] == pin)
+            this->_levels[i] = value != LOW;
+
+    // The outputs restart at the new frequency
+    for(uint8_t i = 0; i < this->_outputs; i++)
+        this->restart(i);
+}
+
+uint32_t TCS3200SimulatedHAL::pulse_in(uint8_t pin, uint8_t state, uint32_t timeout) {
+    uint64_t deadline = this->_time + (uint64_t) timeout * 1000;
+    int8_t output = this->output(pin);
+
+    if(output < 0 || this->_next_edges[output] > deadline) {
+        this->advance_to(deadline);
+        return 0;
+    }
+
+    this->advance_to(this->_next_edges[output]);
+
+    // A LOW pulse starts at a falling edge, a HIGH one half a period later
+    uint64_t start = this->_time;
+    uint32_t width = (this->_next_edges[output] - start) / 2;
+    if(state == HIGH) {
+        start += width;
+        width = this->_next_edges[output] - start;
+    }
+
+    if(start + width > deadline) {
+        this->advance_to(deadline);
+        return 0;
+    }
+
+    this->advance_to(start + width);
+    return (width + 500) / 1000;
+}
+
+uint32_t TCS3200SimulatedHAL::now() {
+    this->advance_to(this->_time + (uint64_t) this->_tick * 1000);
+
+    return (uint32_t) (this->_time / 1000);
+}
+
+bool TCS3200SimulatedHAL::attach_edge(uint8_t pin, void (*isr)()) {
+    int8_t output = this->output(pin);
+    if(output < 0)
+        return false;
+
+    this->_isrs[output] = isr;
+    return true;
+}
+
+void TCS3200SimulatedHAL::detach_edge(uint8_t pin) {
+    int8_t output = this->output(pin);
+
+    if(output >= 0)
+        this->_isrs[output] = nullptr;
+}
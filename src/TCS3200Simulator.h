@@ -0,0 +1,185 @@
+/*
+ * This file is part of the TCS3200 Color Sensor Arduino library.
+ * Copyright (c) 2023 Nathanne Isip
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * 
+ * @file TCS3200Simulator.h
+ * @author [Nathanne Isip](https://github.com/nthnn/TCS3200)
+ * @brief Simulated %TCS3200 sensor for testing without hardware.
+ *
+ * `TCS3200SimulatedHAL` synthesizes the OUT pin waveform of a
+ * %TCS3200 from the S0-S3 pins the library drives, a configurable
+ * spectrum (the output frequency of each photodiode type at 100%
+ * scaling) and a noise model. Time is virtual: it only advances
+ * through `advance()`, while pulses are measured, and by a fixed
+ * tick on every clock reading, so runs are fully reproducible.
+ *
+ * More sensors sharing the S0-S3 pins, like those of a
+ * `TCS3200Array`, are simulated by adding their OUT pins with
+ * `add_output()`. Every OUT pin has its own spectrum, waveform
+ * and edge interrupt.
+ *
+ * **Example usage**:
+ * @code{.cpp}
+ * TCS3200SimulatedHAL simulator(4, 5, 6, 7, 8);
+ * TCS3200 tcs3200(4, 5, 6, 7, 8);
+ * 
+ * void setup() {
+ *   simulator.spectrum(12000, 4000, 3000, 20000);
+ *   simulator.noise(2);
+ * 
+ *   tcs3200.hal(&simulator);
+ *   tcs3200.begin();
+ *   tcs3200.frequency_scaling(TCS3200_OFREQ_20P);
+ * }
+ * @endcode
+ *
+ */
+#ifndef TCS3200_SIMULATOR_H
+#define TCS3200_SIMULATOR_H
+
+#include "TCS3200.h"
+
+#define TCS3200_SIM_OUTPUTS 8 ///< Number of OUT pins a simulator can drive
+
+/**
+ * 
+ * @class TCS3200SimulatedHAL
+ * @brief HAL driving a simulated sensor in virtual time.
+ * 
+ */
+class TCS3200SimulatedHAL : public TCS3200HAL {
+public:
+    /**
+     * 
+     * @brief Constructor for TCS3200SimulatedHAL class.
+     * 
+     * @param s0_pin S0 pin of the simulated sensor.
+     * @param s1_pin S1 pin of the simulated sensor.
+     * @param s2_pin S2 pin of the simulated sensor.
+     * @param s3_pin S3 pin of the simulated sensor.
+     * @param out_pin OUT pin of the simulated sensor.
+     * 
+     */
+    TCS3200SimulatedHAL(uint8_t s0_pin, uint8_t s1_pin, uint8_t s2_pin, uint8_t s3_pin, uint8_t out_pin);
+
+    /**
+     * 
+     * @brief Simulate another sensor sharing the S0-S3 pins.
+     *
+     * The sensor stays dark until its spectrum is set.
+     * 
+     * @param out_pin OUT pin of the added sensor.
+     * 
+     * @return `true` if the sensor was added, `false` if the pin is
+     *         already simulated or `TCS3200_SIM_OUTPUTS` are in use.
+     * 
+     */
+    bool add_output(uint8_t out_pin);
+
+    /**
+     * 
+     * @brief Set the light seen by the simulated sensor.
+     * 
+     * @param red Output frequency of the red photodiodes at 100% scaling in Hz.
+     * @param green Output frequency of the green photodiodes at 100% scaling in Hz.
+     * @param blue Output frequency of the blue photodiodes at 100% scaling in Hz.
+     * @param clear Output frequency of the clear photodiodes at 100% scaling in Hz.
+     * 
+     */
+    void spectrum(uint32_t red, uint32_t green, uint32_t blue, uint32_t clear);
+
+    /**
+     * 
+     * @brief Set the light seen by one of the simulated sensors.
+     * 
+     * @param out_pin OUT pin of the sensor.
+     * @param red Output frequency of the red photodiodes at 100% scaling in Hz.
+     * @param green Output frequency of the green photodiodes at 100% scaling in Hz.
+     * @param blue Output frequency of the blue photodiodes at 100% scaling in Hz.
+     * @param clear Output frequency of the clear photodiodes at 100% scaling in Hz.
+     * 
+     */
+    void spectrum(uint8_t out_pin, uint32_t red, uint32_t green, uint32_t blue, uint32_t clear);
+
+    /**
+     * 
+     * @brief Set the jitter of the output periods.
+     *
+     * Every period deviates from the nominal one by a random,
+     * roughly normally distributed amount.
+     * 
+     * @param percent Largest deviation in percent of the period.
+     * 
+     */
+    void noise(uint8_t percent);
+
+    /**
+     * 
+     * @brief Restart the noise sequence.
+     * 
+     * @param seed Nonzero seed of the noise generator.
+     * 
+     */
+    void seed(uint32_t seed);
+
+    /**
+     * 
+     * @brief Set how much time passes on every clock reading.
+     * 
+     * @param time Time added by each `now()` call in microseconds.
+     * 
+     */
+    void tick(uint32_t time);
+
+    /**
+     * 
+     * @brief Let virtual time pass, firing the attached edge interrupts.
+     * 
+     * @param time Time to pass in microseconds.
+     * 
+     */
+    void advance(uint32_t time);
+
+    void pin_mode(uint8_t pin, uint8_t mode);
+    void digital_write(uint8_t pin, uint8_t value);
+    uint32_t pulse_in(uint8_t pin, uint8_t state, uint32_t timeout);
+    uint32_t now();
+    bool attach_edge(uint8_t pin, void (*isr)());
+    void detach_edge(uint8_t pin);
+
+private:
+    uint8_t _pins[4], _levels[4], _noise, _outputs;
+    uint8_t _out_pins[TCS3200_SIM_OUTPUTS];
+    uint32_t _spectra[TCS3200_SIM_OUTPUTS][4], _random, _tick;
+    uint64_t _time, _next_edges[TCS3200_SIM_OUTPUTS];
+    void (*_isrs[TCS3200_SIM_OUTPUTS])();
+
+    int8_t output(uint8_t pin);
+    uint32_t period(uint8_t output);
+    uint32_t next_random();
+    void restart(uint8_t output);
+    void advance_to(uint64_t time);
+};
+
+#endif